@@ -0,0 +1,573 @@
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __linux__
+#    include <poll.h>
+#endif
+
+#include "doctest.h"
+#include "perfkit/configs.h"
+#include "perfkit/detail/config_dispatch.hpp"
+#include "perfkit/detail/config_index.hpp"
+#include "perfkit/detail/config_journal.hpp"
+#include "perfkit/detail/config_patch.hpp"
+#include "perfkit/detail/config_snapshot.hpp"
+#include "perfkit/detail/config_subscription.hpp"
+#include "perfkit/detail/config_tracker.hpp"
+
+using namespace std::literals;
+using nlohmann::json;
+
+static bool patch_sequence(std::vector<int>* target, json const& ops)
+{
+    std::vector<perfkit::_configs::patch_op> parsed;
+    return perfkit::_configs::parse_patch(ops, &parsed)
+        && perfkit::_configs::apply_patch(parsed, target);
+}
+
+TEST_SUITE("configs.patch")
+{
+    TEST_CASE("sequence ops")
+    {
+        std::vector<int> seq{0, 1, 2, 3};
+        json js = seq;
+
+        auto ops = R"([
+            {"op": "replace", "path": "/0", "value": 10},
+            {"op": "add", "path": "/-", "value": 4},
+            {"op": "remove", "path": "/1"},
+            {"op": "replace_range", "path": "/1", "value": [20, 30]},
+            {"op": "remove_range", "path": "/2", "count": 2}
+        ])"_json;
+
+        REQUIRE(patch_sequence(&seq, ops));
+        REQUIRE(perfkit::_configs::apply_patch(&js, ops));
+
+        CHECK(seq == std::vector<int>{10, 20});
+        CHECK(js == json(seq));
+    }
+
+    TEST_CASE("out of range indices are rejected without modification")
+    {
+        auto const origin = std::vector<int>{0, 1, 2, 3};
+
+        for (auto ops : {
+                     R"([{"op": "replace", "path": "/4", "value": 1}])"_json,
+                     R"([{"op": "add", "path": "/5", "value": 1}])"_json,
+                     R"([{"op": "remove", "path": "/4"}])"_json,
+                     R"([{"op": "replace_range", "path": "/3", "value": [1, 2]}])"_json,
+                     R"([{"op": "remove_range", "path": "/3", "count": 2}])"_json,
+
+                     // sum of index and count wraps around size_t
+                     R"([{"op": "remove_range", "path": "/18446744073709551615", "count": 1}])"_json,
+                     R"([{"op": "remove_range", "path": "/1", "count": 18446744073709551615}])"_json,
+                     R"([{"op": "replace_range", "path": "/18446744073709551615", "value": [1]}])"_json,
+                     R"([{"op": "replace_range", "path": "/18446744073709551614", "value": [1, 2]}])"_json,
+             })
+        {
+            CAPTURE(ops.dump());
+
+            auto seq = origin;
+            CHECK_FALSE(patch_sequence(&seq, ops));
+            CHECK(seq == origin);
+
+            json js = origin;
+            CHECK_FALSE(perfkit::_configs::apply_patch(&js, ops));
+        }
+    }
+}
+
+TEST_SUITE("configs.typed")
+{
+    TEST_CASE("integral range checks")
+    {
+        auto rg  = perfkit::config_registry::create("automation-typed-range");
+        auto i8  = perfkit::configure(*rg, "i8", int8_t(1)).confirm();
+        auto u64 = perfkit::configure(*rg, "u64", uint64_t(1)).confirm();
+        auto f   = perfkit::configure(*rg, "f", 1.f).confirm();
+        rg->update();
+
+        auto queue = [&](auto& conf, perfkit::detail::config_base::typed_value v) {
+            rg->bk_queue_update_typed(conf.base().full_key(), std::move(v));
+            rg->update();
+            return conf.value();
+        };
+
+        CHECK(queue(i8, int64_t(-128)) == -128);
+        CHECK(queue(i8, int64_t(128)) == -128);
+        CHECK(queue(i8, 127.9) == 127);
+        CHECK(queue(i8, 300.) == 127);
+        CHECK(queue(i8, std::nan("")) == 127);
+        CHECK(queue(i8, uint64_t(127)) == 127);
+        CHECK(queue(i8, uint64_t(128)) == 127);
+
+        CHECK(queue(u64, int64_t(-1)) == 1);
+        CHECK(queue(u64, -1.) == 1);
+        CHECK(queue(u64, 1.8446744073709552e19) == 1);  // 2^64
+        CHECK(queue(u64, uint64_t(~uint64_t{})) == ~uint64_t{});
+
+        CHECK(queue(f, int64_t(3)) == 3.f);
+        CHECK(queue(f, uint64_t(4)) == 4.f);
+    }
+
+    TEST_CASE("unsigned values above int64 range")
+    {
+        auto rg  = perfkit::config_registry::create("automation-typed-unsigned");
+        auto u64 = perfkit::configure(*rg, "u64", uint64_t(0)).confirm();
+        auto sz  = perfkit::configure(*rg, "sz", size_t(0)).confirm();
+        rg->update();
+
+        uint64_t const boundary = uint64_t(std::numeric_limits<int64_t>::max());
+
+        for (auto value : {boundary, boundary + 1, ~uint64_t{}})
+        {
+            u64.async_modify(value);
+            sz.async_modify(size_t(value));
+            rg->update();
+
+            CHECK(u64.value() == value);
+            CHECK(sz.value() == size_t(value));
+            CHECK(u64.base().serialize() == json(value));
+        }
+    }
+}
+
+TEST_SUITE("configs.tracker")
+{
+    TEST_CASE("applied values are recognized after round trip through config type")
+    {
+        auto rg      = perfkit::config_registry::create("automation-tracker");
+        auto f       = perfkit::configure(*rg, "f", 1.f).confirm();
+        auto clamped = perfkit::configure(*rg, "clamped", 0.).min(0.).max(1.).confirm();
+        rg->update();
+
+        auto tr_f       = perfkit::_configs::apply_tracker::attach(rg->bk_find(f.base().full_key()));
+        auto tr_clamped = perfkit::_configs::apply_tracker::attach(rg->bk_find(clamped.base().full_key()));
+        rg->update();
+
+        // 0.1 is not representable in float, thus serialized back as 0.100000001...
+        for (double value : {0.1, 0.3, 1. / 3.})
+        {
+            tr_f->expect(value);
+            f.base().request_modify(value);
+        }
+
+        tr_clamped->expect(5.);
+        clamped.base().request_modify(5.);
+        rg->update();
+
+        CHECK(tr_f->num_applied() == 1);
+        CHECK_FALSE(tr_f->modified());
+        CHECK(tr_clamped->num_applied() == 1);
+        CHECK_FALSE(tr_clamped->modified());
+
+        // modification by others
+        f.async_modify(0.7f);
+        rg->update();
+        CHECK(tr_f->modified());
+
+        tr_f->detach(), tr_clamped->detach();
+    }
+}
+
+TEST_SUITE("configs.journal")
+{
+    using perfkit::configs::journal;
+
+    static auto journal_path(char const* name)
+    {
+        auto path = (std::filesystem::temp_directory_path() / name).string();
+        std::filesystem::remove(path);
+        return path;
+    }
+
+    TEST_CASE("records are written in order of application")
+    {
+        auto rg  = perfkit::config_registry::create("automation-journal-order");
+        auto arr = perfkit::configure(*rg, "arr", std::vector<int>{}).confirm();
+        auto num = perfkit::configure(*rg, "num", 0).confirm();
+        rg->update();
+
+        auto path = journal_path("perfkit-automation-journal-order.log");
+        auto jr   = journal::open(path);
+        REQUIRE(jr);
+
+        arr.async_modify({1}), rg->update();
+        arr.base().request_patch(R"([{"op": "add", "path": "/-", "value": 2}])"_json), rg->update();
+        num.async_modify(5), rg->update();
+        jr->flush();
+
+        std::vector<journal::record> records;
+        REQUIRE(journal::read(path, [&](journal::record& rec) { records.push_back(rec); }));
+
+        REQUIRE(records.size() == 4);
+        CHECK(records[0].kind == journal::record::snapshot);
+        CHECK(records[1].kind == journal::record::value);
+        CHECK(records[1].data == json::array({1}));
+        CHECK(records[2].kind == journal::record::patch);
+        CHECK(records[3].kind == journal::record::value);
+        CHECK(records[3].key == num.base().display_key());
+        CHECK(records[3].data == json(5));
+
+        jr.reset();
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("replay reproduces values patched by concurrent updates")
+    {
+        auto rg  = perfkit::config_registry::create("automation-journal-replay");
+        auto arr = perfkit::configure(*rg, "arr", std::vector<int>{}).confirm();
+        rg->update();
+
+        auto path = journal_path("perfkit-automation-journal-replay.log");
+        auto jr   = journal::open(path, {std::chrono::milliseconds{1}, 1 << 16});
+        REQUIRE(jr);
+
+        // value records must be kept, even if a patch based on them is applied by another
+        //  thread before they're queued.
+        std::atomic_bool stop{false};
+        std::thread updater{[&] { while (not stop) { rg->update(); } }};
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            arr.async_modify({i});
+            arr.base().request_patch(R"([{"op": "add", "path": "/-", "value": -1}])"_json);
+            rg->update();
+        }
+
+        stop = true, updater.join();
+        rg->update();
+        jr->flush();
+
+        auto applied = arr.value();
+        jr.reset();
+
+        arr.async_modify({}), rg->update();
+        REQUIRE(journal::replay(path));
+        rg->update();
+
+        CHECK(arr.value() == applied);
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("replay fails for time before snapshot")
+    {
+        auto path = journal_path("perfkit-automation-journal-snapshot.log");
+        auto jr   = journal::open(path);
+        REQUIRE(jr);
+
+        CHECK_FALSE(journal::replay(path, journal::clock::time_point{}));
+        CHECK(journal::replay(path, journal::clock::now()));
+
+        jr.reset();
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_SUITE("configs.snapshot")
+{
+    using perfkit::configs::group;
+
+    TEST_CASE("snapshot covers configs registered after it was built")
+    {
+        auto rg = perfkit::config_registry::create("automation-snapshot-late");
+        auto a  = perfkit::configure(*rg, "a", 1).confirm();
+
+        auto early = rg->snapshot();
+        auto grp   = group::create(a);
+        auto b     = perfkit::configure(*rg, "b", std::string{"late"}).confirm();
+        CHECK_THROWS_AS(early->get(b), std::out_of_range);
+
+        // no change is applied by the first update.
+        rg->update();
+
+        auto snap = rg->snapshot();
+        CHECK(snap->epoch() > early->epoch());
+        CHECK(snap->get(a) == 1);
+        CHECK(snap->get(b) == "late");
+        CHECK(grp->snapshot()->get(b) == "late");
+    }
+
+    TEST_CASE("groups are republished only by their members")
+    {
+        auto rg = perfkit::config_registry::create("automation-snapshot-group");
+        auto a  = perfkit::configure(*rg, "a", 1).confirm();
+        auto b  = perfkit::configure(*rg, "b", 2.).confirm();
+        rg->update();
+
+        auto grp   = group::create(a);
+        auto epoch = grp->snapshot()->epoch();
+
+        b.async_modify(3.), rg->update();
+        CHECK(grp->snapshot()->epoch() == epoch);
+        CHECK(rg->snapshot()->get(b) == 3.);
+
+        a.async_modify(4), rg->update();
+        CHECK(grp->snapshot()->epoch() > epoch);
+        CHECK(grp->snapshot()->get(a) == 4);
+    }
+
+    TEST_CASE("configs of other registries are rejected")
+    {
+        auto rg    = perfkit::config_registry::create("automation-snapshot-mine");
+        auto other = perfkit::config_registry::create("automation-snapshot-other");
+        auto a     = perfkit::configure(*rg, "a", 1).confirm();
+        auto x     = perfkit::configure(*other, "x", 1).confirm();
+        rg->update(), other->update();
+
+        CHECK_THROWS_AS(rg->snapshot()->get(x), std::invalid_argument);
+        CHECK_THROWS_AS(group::create(a, x), std::invalid_argument);
+    }
+}
+
+TEST_SUITE("configs.batch")
+{
+    TEST_CASE("batch completes without registries which never apply it")
+    {
+        auto rg = perfkit::config_registry::create("automation-batch");
+        auto a  = perfkit::configure(*rg, "a", 1).confirm();
+        rg->update();
+
+        uint64_t fence = 0;
+        perfkit::configs::wait_any_change(0ms, &fence);
+
+        {
+            auto gone = perfkit::config_registry::create("automation-batch-gone");
+            auto g    = perfkit::configure(*gone, "g", 1).confirm();
+            gone->update();
+            perfkit::configs::wait_any_change(0ms, &fence);
+
+            perfkit::configs::batch changes;
+            changes.stage(&a.base(), 2), changes.stage(&g.base(), 2);
+            changes.commit();
+
+            rg->update();
+            CHECK(a.value() == 2);
+            CHECK_FALSE(perfkit::configs::wait_any_change(0ms, &fence));
+        }
+
+        // released by destroyed registry.
+        CHECK(perfkit::configs::wait_any_change(0ms, &fence));
+
+        auto fresh = perfkit::config_registry::create("automation-batch-fresh");
+        auto f     = perfkit::configure(*fresh, "f", 1).confirm();
+
+        perfkit::configs::batch changes;
+        changes.stage(&a.base(), 3), changes.stage(&f.base(), 3);
+        changes.commit();
+
+        rg->update();
+        CHECK(perfkit::configs::wait_any_change(0ms, &fence));
+
+        fresh->update();
+        CHECK(f.value() == 3);
+    }
+}
+
+TEST_SUITE("configs.dispatch")
+{
+    static int twice(int v) { return v * 2; }
+    static int square(int v) { return v * v; }
+
+    TEST_CASE("call without variants throws")
+    {
+        auto rg  = perfkit::config_registry::create("automation-dispatch");
+        auto sel = perfkit::configure(*rg, "kernel", std::string{"square"}).confirm();
+        rg->update();
+
+        perfkit::dispatch<int(int)> fn{sel};
+        CHECK(fn.get() == nullptr);
+        CHECK(fn.active_name().empty());
+        CHECK_THROWS_AS(fn(3), std::bad_function_call);
+
+        fn.add(std::string{"twice"}, &twice);
+        CHECK(fn(3) == 6);
+
+        fn.add(std::string{"square"}, &square);
+        CHECK(fn(3) == 9);
+        CHECK(fn.active_name() == "square");
+    }
+}
+
+TEST_SUITE("configs.subscription")
+{
+    TEST_CASE("close wakes up blocked waiters")
+    {
+        auto sub = perfkit::configs::subscription::create();
+
+        std::atomic_bool woken = false;
+        std::thread waiter{[&] { woken = not sub->wait(); }};
+
+#if __linux__
+        std::thread poller{[&] {
+            pollfd pfd{sub->native_handle(), POLLIN, 0};
+            CHECK(poll(&pfd, 1, 10000) == 1);
+        }};
+#endif
+
+        std::this_thread::sleep_for(10ms);
+        sub->close();
+
+        waiter.join();
+        CHECK(woken);
+        CHECK_FALSE(sub->wait_for(0ms));
+
+#if __linux__
+        poller.join();
+
+        // remains readable after consume.
+        std::vector<perfkit::config_shared_ptr> changes;
+        sub->consume(&changes);
+
+        pollfd pfd{sub->native_handle(), POLLIN, 0};
+        CHECK(poll(&pfd, 1, 0) == 1);
+#endif
+    }
+}
+
+TEST_SUITE("configs.watcher")
+{
+    TEST_CASE("registry recreated at same address is watched again")
+    {
+        perfkit::configs::watcher watcher;
+
+        // destroyed registry's address is mostly reused by the next one.
+        for (int i = 0; i < 4; ++i)
+        {
+            auto rg = perfkit::config_registry::create("automation-watcher");
+            auto a  = perfkit::configure(*rg, "a", 1).confirm();
+            rg->update();
+
+            watcher.watch(a);
+            CHECK_FALSE(watcher.check_dirty(a));
+
+            a.async_modify(i + 2), rg->update();
+            CHECK(watcher.check_dirty(a));
+        }
+    }
+}
+
+TEST_SUITE("configs.index")
+{
+    using perfkit::_configs::perfect_hash_index;
+
+    TEST_CASE("perfect hash index lookup")
+    {
+        // buckets hold 4 keys on average, which must be displaced into distinct slots.
+        std::vector<std::string> keys;
+        for (int i = 0; i < 2000; ++i) { keys.push_back("category|key-" + std::to_string(i)); }
+
+        std::vector<std::pair<std::string_view, int>> entries;
+        for (int i = 0; i < int(keys.size()); ++i) { entries.emplace_back(keys[i], i); }
+
+        perfect_hash_index<int> index;
+        REQUIRE(index.build(entries));
+        CHECK(index.size() == keys.size());
+
+        for (int i = 0; i < int(keys.size()); ++i)
+        {
+            auto found = index.find(keys[i]);
+            REQUIRE(found);
+            CHECK(*found == i);
+        }
+
+        // misses are mapped into occupied slots, thus rejected by key comparison.
+        for (int i = 0; i < 2000; ++i)
+            CHECK(index.find("category|key-" + std::to_string(i + 2000)) == nullptr);
+
+        CHECK(index.find("") == nullptr);
+        CHECK(index.find("category|key-1 ") == nullptr);
+        CHECK(index.find("category|key-") == nullptr);
+    }
+
+    TEST_CASE("perfect hash index edge cases")
+    {
+        perfect_hash_index<int> index;
+
+        CHECK(index.build({}));
+        CHECK(index.empty());
+        CHECK(index.find("any") == nullptr);
+
+        CHECK(index.build({{"a", 1}}));
+        CHECK(*index.find("a") == 1);
+        CHECK(index.find("b") == nullptr);
+
+        // duplicated keys can't be indexed, which leaves index empty.
+        CHECK_FALSE(index.build({{"a", 1}, {"b", 2}, {"a", 3}}));
+        CHECK(index.empty());
+        CHECK(index.find("a") == nullptr);
+    }
+}
+
+TEST_SUITE("configs.keys")
+{
+    // display key and flag name were parsed by these regexes before.
+    static std::string regex_display_key(std::string const& full_key)
+    {
+        static std::regex rg_trim_whitespace{R"((?:^|\|?)\s*(\S?[^|]*\S)\s*(?:\||$))"};
+        static std::regex rg_remove_order_marker{R"(\+[^|]+\|)"};
+
+        std::string out;
+        for (std::sregex_iterator end{}, it{full_key.begin(), full_key.end(), rg_trim_whitespace}; it != end; ++it)
+            out.append(it->str(1)), out.append("|");
+
+        out.empty() || (out.pop_back(), 0);
+        out.resize(std::regex_replace(out.begin(), out.begin(), out.end(), rg_remove_order_marker, "") - out.begin());
+        return out;
+    }
+
+    // original pattern had invalid range [\w-\.], which libstdc++ rejects.
+    static bool regex_flag_name(std::string const& name)
+    {
+        static std::regex match{R"(((?!no-)[^N-][\w.\-]*)|N[\w.\-]+)"};
+        return std::regex_match(name, match);
+    }
+
+    TEST_CASE("display key matches regex")
+    {
+        for (std::string key : {"a", "a|b", " a | b ", "\ta b |\tc d\t", "+1|a|+2|b", "+12|+34|x",
+                                "x|y|+z|w", "+|a", "a|+x", "ab|+|c", "a|b|+", "+",
+                                "cat|+0|k!@#", "k$%^&*()|v w"})
+        {
+            CAPTURE(key);
+            CHECK(perfkit::detail::_make_display_key(key) == regex_display_key(key));
+        }
+    }
+
+    TEST_CASE("empty segments are dropped from display key")
+    {
+        // regex left empty segments behind, which produced keys like 'a||b'.
+        std::pair<char const*, char const*> cases[] = {
+                {"|a|b", "a|b"},
+                {"a|b|", "a|b"},
+                {"a||b", "a|b"},
+                {"a|||b", "a|b"},
+                {"||a", "a"},
+                {"a| |b", "a|b"},
+                {" | a", "a"},
+                {"+1||a", "a"},
+        };
+
+        for (auto [key, expected] : cases)
+        {
+            CAPTURE(key);
+            CHECK(perfkit::detail::_make_display_key(key) == expected);
+        }
+    }
+
+    TEST_CASE("flag name matches regex")
+    {
+        for (std::string name : {"", "a", "n", "N", "Na", "Nb!", "-a", "no-a", "no", "noa", "1", "_x",
+                                 "!a", "a!", "a b", "a|b", "a.b-c_d", "x--y"})
+        {
+            CAPTURE(name);
+            CHECK(perfkit::detail::_is_valid_flag_name(name) == regex_flag_name(name));
+        }
+    }
+}
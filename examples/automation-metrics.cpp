@@ -0,0 +1,76 @@
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+#include "perfkit/detail/queue_probe.hpp"
+#include "perfkit/detail/tracer.hpp"
+
+using namespace std::literals;
+
+TEST_SUITE("metrics.queue_probe")
+{
+    // keeps background publisher from draining probes between explicit publishes below.
+    static bool const _hold_publisher = (perfkit::metrics::publish_interval(24h), true);
+
+    static double published(perfkit::tracer const& trc, std::vector<std::string_view> hierarchy)
+    {
+        auto node = trc.find(hierarchy);
+        REQUIRE(node);
+        REQUIRE(node->as_number());
+        return *node->as_number();
+    }
+
+    TEST_CASE("depth follows enqueue, dequeue and discard")
+    {
+        perfkit::queue_probe probe{"depth", "automation"};
+
+        auto a = probe.on_enqueue();
+        probe.on_enqueue();
+        probe.on_enqueue();
+        CHECK(probe.depth() == 3);
+
+        probe.on_complete(probe.on_dequeue(a));
+        probe.on_discard();
+        CHECK(probe.depth() == 1);
+
+        int called = 0;
+        auto task  = probe.wrap([&] { ++called; });
+        CHECK(probe.depth() == 2);
+
+        task();
+        CHECK(called == 1);
+        CHECK(probe.depth() == 1);
+    }
+
+    TEST_CASE("published statistics cover only latest window")
+    {
+        perfkit::queue_probe probe{"window", "automation"};
+        auto trc = perfkit::tracer::create(0, "automation-queue-probe");
+
+        auto publish = [&] {
+            auto root = trc->fork("root");
+            auto node = root.branch("probe");
+            probe.publish(node);
+        };
+
+        std::vector<perfkit::queue_probe::stamp_type> stamps;
+        for (int i = 0; i < 4; ++i) { stamps.push_back(probe.on_enqueue()); }
+        for (auto stamp : stamps) { probe.on_complete(probe.on_dequeue(stamp)); }
+        probe.on_enqueue();
+
+        publish();
+        CHECK(published(*trc, {"root", "probe", "completed"}) == 4);
+        CHECK(published(*trc, {"root", "probe", "depth"}) == 1);
+        CHECK(published(*trc, {"root", "probe", "depth_max"}) >= 3);
+        CHECK(published(*trc, {"root", "probe", "wait", "max"}) >= 0);
+        CHECK(published(*trc, {"root", "probe", "exec", "max"}) >= 0);
+
+        // completion count accumulates, while depth samples are drained.
+        probe.on_complete(probe.on_dequeue(probe.on_enqueue()));
+
+        publish();
+        CHECK(published(*trc, {"root", "probe", "completed"}) == 5);
+        CHECK(published(*trc, {"root", "probe", "depth_max"}) <= 1);
+        CHECK(published(*trc, {"root", "probe", "throughput"}) > 0);
+    }
+}
@@ -0,0 +1,92 @@
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+#include "perfkit/detail/commands.hpp"
+
+using namespace std::literals;
+using perfkit::commands::stroffset;
+
+// former regex based implementation, which tokenizer must behave identical with.
+static void tokenize_by_regex(
+        std::string* io, std::vector<std::string_view>& tokens, std::vector<stroffset>* token_indexes)
+{
+    static const std::regex rg_argv_token{R"RG((?:"((?:\\.|[^"\\])*)"|((?:[^\s\\]|\\.)+)))RG"};
+    static const std::regex rg_escape{R"(\\([ \\"']))"};
+
+    auto const src = *io;
+    io->clear(), io->reserve(src.size());
+
+    std::cregex_iterator iter{src.data(), src.data() + src.size(), rg_argv_token};
+    for (; iter != std::cregex_iterator{}; ++iter)
+    {
+        auto& match = *iter;
+        size_t n    = match[1].matched ? 1 : 2;
+
+        size_t position = match.position(n), length = match.length(n);
+        token_indexes->push_back({position, length, n == 1});
+
+        std::string str = src.substr(position, length);
+        auto end        = std::regex_replace(str.begin(), str.begin(), str.end(), rg_escape, "$1");
+        str.resize(end - str.begin());
+
+        tokens.emplace_back(io->c_str() + io->size(), str.size());
+        io->append(str);
+    }
+}
+
+TEST_SUITE("Command Tokenizer")
+{
+    TEST_CASE("Quotes and Escapes")
+    {
+        std::string str = R"(set "a b" c\ d "e\"f" \\g "unterminated)";
+        std::vector<std::string_view> tokens;
+        std::vector<stroffset> offsets;
+
+        perfkit::commands::tokenize_by_argv_rule(&str, tokens, &offsets);
+
+        REQUIRE(tokens.size() == 6);
+        CHECK(tokens[0] == "set"sv);
+        CHECK(tokens[1] == "a b"sv);
+        CHECK(tokens[2] == "c d"sv);
+        CHECK(tokens[3] == "e\"f"sv);
+        CHECK(tokens[4] == "\\g"sv);
+        CHECK(tokens[5] == "\"unterminated"sv);
+
+        CHECK(offsets[1].position == 5);
+        CHECK(offsets[1].should_wrap);
+        CHECK(not offsets[2].should_wrap);
+    }
+
+    TEST_CASE("Differential Fuzzing")
+    {
+        static constexpr char alphabet[] = {' ', ' ', '\t', '\n', '\r', '"', '"', '\\', '\\', '\'', 'a', 'b', '\0'};
+
+        std::mt19937 rand{42};
+        for (int round = 0; round < 20000; ++round)
+        {
+            std::string src;
+            for (auto len = rand() % 24; len > 0; --len) { src += alphabet[rand() % sizeof alphabet]; }
+
+            std::string expected_buf = src, actual_buf = src;
+            std::vector<std::string_view> expected, actual;
+            std::vector<stroffset> expected_ofst, actual_ofst;
+
+            tokenize_by_regex(&expected_buf, expected, &expected_ofst);
+            perfkit::commands::tokenize_by_argv_rule(&actual_buf, actual, &actual_ofst);
+
+            INFO("source: " << src);
+            REQUIRE(actual == expected);
+            REQUIRE(actual_ofst.size() == expected_ofst.size());
+
+            for (size_t i = 0; i < actual_ofst.size(); ++i)
+            {
+                REQUIRE(actual_ofst[i].position == expected_ofst[i].position);
+                REQUIRE(actual_ofst[i].length == expected_ofst[i].length);
+                REQUIRE(actual_ofst[i].should_wrap == expected_ofst[i].should_wrap);
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+// Measures latency of command autocompletion over a large command tree, comparing paged
+// suggestion against retrieving every candidate at once.
+//
+//   bench-command-suggest [num_keys=50000] [num_iterations=1000]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "perfkit/detail/commands.hpp"
+
+template <typename Fn_>
+static double us_per_call(size_t num_iterations, Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_iterations; ++i) { fn(); }
+
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / num_iterations;
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_keys       = argc > 1 ? strtoul(argv[1], nullptr, 10) : 50'000;
+    size_t num_iterations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1'000;
+
+    perfkit::commands::registry rg;
+    auto node = rg.root()->add_subcommand("config")->add_subcommand("set")->add_subcommand("registry");
+
+    for (size_t i = 0; i < num_keys; ++i)
+        node->add_subcommand("group" + std::to_string(i % 100) + ".key" + std::to_string(i));
+
+    std::vector<std::string> candidates;
+    std::string common;
+
+    auto run = [&](char const* title, std::string const& line, bool paged) {
+        perfkit::commands::suggest_page page{0, 20};
+        auto elapsed = us_per_call(num_iterations, [&] {
+            candidates.clear();
+            common = rg.suggest(line, &candidates, paged ? &page : nullptr);
+        });
+
+        printf("  %-36s %10.2f us (%zu candidates)\n", title, elapsed, candidates.size());
+    };
+
+    printf("%zu keys, %zu iterations\n", num_keys, num_iterations);
+    run("narrow prefix, page of 20", "config set registry group4", true);
+    run("narrow prefix, all", "config set registry group4", false);
+    run("empty prefix, page of 20", "config set registry ", true);
+    run("empty prefix, all", "config set registry ", false);
+    run("unique match", "conf s reg group42.key4200", false);
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Measures throughput of command line tokenization, comparing regex based tokenizer, which
+// was used formerly, against tokenize_by_argv_rule().
+//
+//   bench-command-tokenize [num_iterations=100000]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "perfkit/detail/commands.hpp"
+
+static void tokenize_by_regex(std::string* io, std::vector<std::string_view>& tokens)
+{
+    static const std::regex rg_argv_token{R"RG((?:"((?:\\.|[^"\\])*)"|((?:[^\s\\]|\\.)+)))RG"};
+    static const std::regex rg_escape{R"(\\([ \\"']))"};
+
+    auto const src = *io;
+    io->clear(), io->reserve(src.size());
+
+    std::cregex_iterator iter{src.data(), src.data() + src.size(), rg_argv_token};
+    for (; iter != std::cregex_iterator{}; ++iter)
+    {
+        auto& match = *iter;
+        size_t n    = match[1].matched ? 1 : 2;
+
+        std::string str = src.substr(match.position(n), match.length(n));
+        auto end        = std::regex_replace(str.begin(), str.begin(), str.end(), rg_escape, "$1");
+        str.resize(end - str.begin());
+
+        tokens.emplace_back(io->c_str() + io->size(), str.size());
+        io->append(str);
+    }
+}
+
+template <typename Fn_>
+static double elapsed_ms(Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100'000;
+
+    std::string const lines[] = {
+            R"(config set my-service "network|retry policy|max attempts" 5)",
+            R"(control start my-service batch\ size main-tracer "frame|process" 40us pid)",
+            R"(config get my-service "logging|pattern" "[%H:%M:%S.%e] \"%v\"")",
+    };
+
+    size_t num_bytes = 0;
+    for (auto& line : lines) { num_bytes += line.size(); }
+
+    std::string buf;
+    std::vector<std::string_view> tokens;
+
+    auto run = [&](auto&& tokenize) {
+        return elapsed_ms([&] {
+            for (size_t i = 0; i < num_iterations; ++i)
+            {
+                for (auto& line : lines)
+                {
+                    buf = line, tokens.clear();
+                    tokenize(&buf, tokens);
+                }
+            }
+        });
+    };
+
+    auto regex   = run([](auto io, auto& tokens) { tokenize_by_regex(io, tokens); });
+    auto scanner = run([](auto io, auto& tokens) { perfkit::commands::tokenize_by_argv_rule(io, tokens); });
+
+    auto total_mb = double(num_bytes) * num_iterations / (1 << 20);
+    printf("%zu lines, %.1f MB\n", num_iterations * std::size(lines), total_mb);
+    printf("  regex     : %8.1f ms (%7.1f MB/s)\n", regex, total_mb / regex * 1e3);
+    printf("  tokenizer : %8.1f ms (%7.1f MB/s)\n", scanner, total_mb / scanner * 1e3);
+}
@@ -0,0 +1,82 @@
+// Measures throughput of cross-thread config reads, while another thread keeps
+// publishing updates through registry update().
+//
+//   bench-config-contention [num_readers=32] [duration_ms=2000]
+//
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "perfkit/configs.h"
+
+using namespace std::literals;
+
+PERFKIT_CATEGORY(bench)
+{
+    PERFKIT_CONFIGURE(scalar, 1.0).confirm();
+    PERFKIT_CONFIGURE(text, "a string longer than small buffer optimization threshold").confirm();
+}
+
+template <typename Fn_>
+double measure(size_t num_readers, std::chrono::milliseconds duration, Fn_&& read)
+{
+    std::atomic_bool stop  = false;
+    std::atomic_size_t sum = 0;
+
+    std::thread writer{[&] {
+        for (int64_t i = 0; not stop; ++i)
+        {
+            bench::scalar.async_modify(i * 0.5);
+            bench::text.async_modify(std::to_string(i) + " a string longer than small buffer");
+            bench::update();
+            std::this_thread::sleep_for(100us);
+        }
+    }};
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < num_readers; ++i)
+    {
+        readers.emplace_back([&] {
+            size_t count = 0;
+            while (not stop) { read(), ++count; }
+            sum += count;
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop = true;
+
+    writer.join();
+    for (auto& th : readers) { th.join(); }
+
+    return sum / std::chrono::duration<double>(duration).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_readers = argc > 1 ? strtoul(argv[1], nullptr, 10) : 32;
+    auto duration      = std::chrono::milliseconds{argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000};
+
+    bench::update();
+
+    volatile double sink_d;
+    volatile size_t sink_s;
+
+    auto locked_scalar = [&] { sink_d = (bench::registry()._access_lock(), bench::scalar.ref()); };
+    auto locked_text   = [&] { sink_s = (bench::registry()._access_lock(), std::string{bench::text.ref()}).size(); };
+    auto cell_scalar   = [&] { sink_d = bench::scalar.value(); };
+    auto cell_text     = [&] { sink_s = bench::text.value().size(); };
+    auto snapshot_text = [&] { sink_s = bench::text.snapshot()->size(); };
+
+    printf("%zu readers, %lld ms each\n", num_readers, (long long)duration.count());
+    printf("%-24s %14.0f reads/s\n", "scalar, registry lock", measure(num_readers, duration, locked_scalar));
+    printf("%-24s %14.0f reads/s\n", "scalar, seqlock", measure(num_readers, duration, cell_scalar));
+    printf("%-24s %14.0f reads/s\n", "string, registry lock", measure(num_readers, duration, locked_text));
+    printf("%-24s %14.0f reads/s\n", "string, rcu copy", measure(num_readers, duration, cell_text));
+    printf("%-24s %14.0f reads/s\n", "string, rcu snapshot", measure(num_readers, duration, snapshot_text));
+
+    return 0;
+}
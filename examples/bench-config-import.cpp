@@ -0,0 +1,91 @@
+// Measures time to import large configuration profiles, comparing per-key queueing
+// against batched import_from().
+//
+//   bench-config-import [num_registries=10]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "perfkit/configs.h"
+
+using namespace std::literals;
+
+struct profile
+{
+    std::vector<std::shared_ptr<perfkit::config_registry>> registries;
+    std::vector<std::unique_ptr<perfkit::config<int64_t>>> configs;
+    perfkit::json data;
+};
+
+static auto make_profile(size_t num_keys, size_t num_registries)
+{
+    static size_t generation = 0;
+    ++generation;
+
+    auto p = std::make_unique<profile>();
+    for (size_t i = 0; i < num_registries; ++i)
+    {
+        auto name = "bench-import-" + std::to_string(generation) + "-" + std::to_string(i);
+        p->registries.push_back(perfkit::config_registry::create(name));
+    }
+
+    for (size_t i = 0; i < num_keys; ++i)
+    {
+        auto& rg  = *p->registries[i % num_registries];
+        auto key  = "group " + std::to_string(i % 97) + "|key " + std::to_string(i);
+        auto conf = new perfkit::config<int64_t>(perfkit::configure(rg, std::string{key}, int64_t(0)).confirm());
+
+        p->configs.emplace_back(conf);
+        p->data[rg.name()][conf->base().display_key()] = int64_t(i);
+    }
+
+    for (auto& rg : p->registries) { rg->update(); }
+    return p;
+}
+
+template <typename Fn_>
+static double elapsed_ms(Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_registries = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10;
+
+    for (size_t num_keys : {10'000, 100'000})
+    {
+        auto p = make_profile(num_keys, num_registries);
+
+        auto per_key = elapsed_ms([&] {
+            for (auto& rg : p->registries)
+            {
+                for (auto& [disp_key, value] : p->data[rg->name()].items())
+                {
+                    rg->bk_queue_update_value(rg->bk_find_key(disp_key), value);
+                }
+            }
+        });
+
+        auto apply_per_key = elapsed_ms([&] {
+            for (auto& rg : p->registries) { rg->update(); }
+        });
+
+        auto batched = elapsed_ms([&] { perfkit::configs::import_from(p->data); });
+
+        auto apply_batched = elapsed_ms([&] {
+            for (auto& rg : p->registries) { rg->update(); }
+        });
+
+        printf("%zu keys, %zu registries\n", num_keys, num_registries);
+        printf("  %-20s queue %10.2f ms, update %10.2f ms\n", "per-key", per_key, apply_per_key);
+        printf("  %-20s queue %10.2f ms, update %10.2f ms\n", "batch (import_from)", batched, apply_batched);
+    }
+
+    return 0;
+}
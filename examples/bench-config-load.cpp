@@ -0,0 +1,69 @@
+// Measures time to load large configuration files, comparing json DOM parsing followed by
+// import_from() against streaming import_file(), for each supported file format.
+//
+//   bench-config-load [num_keys=500000]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "perfkit/configs.h"
+
+using namespace std::literals;
+
+template <typename Fn_>
+static double elapsed_ms(Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_keys       = argc > 1 ? strtoul(argv[1], nullptr, 10) : 500'000;
+    size_t num_registries = 10;
+
+    std::vector<std::shared_ptr<perfkit::config_registry>> registries;
+    std::vector<std::unique_ptr<perfkit::config<int64_t>>> configs;
+
+    for (size_t i = 0; i < num_registries; ++i)
+        registries.push_back(perfkit::config_registry::create("bench-load-" + std::to_string(i)));
+
+    for (size_t i = 0; i < num_keys; ++i)
+    {
+        auto& rg = *registries[i % num_registries];
+        auto key = "group " + std::to_string(i % 97) + "|key " + std::to_string(i);
+        configs.emplace_back(new perfkit::config<int64_t>(perfkit::configure(rg, std::move(key), int64_t(i)).confirm()));
+    }
+
+    for (auto& rg : registries) { rg->update(); }
+
+    auto apply = [&] { for (auto& rg : registries) { rg->update(); } };
+
+    printf("%zu keys, %zu registries\n", num_keys, num_registries);
+    for (auto path : {"bench-config-load.json", "bench-config-load.msgpack", "bench-config-load.cbor"})
+    {
+        perfkit::configs::export_to(path);
+
+        std::ifstream fs{path, std::ios::binary};
+        std::string content{std::istreambuf_iterator<char>{fs}, {}};
+
+        auto streamed = elapsed_ms([&] { perfkit::configs::import_file(path), apply(); });
+
+        if (path == "bench-config-load.json"s)
+        {
+            auto dom = elapsed_ms([&] { perfkit::configs::import_from(perfkit::json::parse(content)), apply(); });
+            printf("  %-28s %10.2f ms\n", "json (parse + import_from)", dom);
+        }
+
+        printf("  %-28s %10.2f ms (%.1f MB)\n", path, streamed, content.size() / 1e6);
+        std::remove(path);
+    }
+
+    return 0;
+}
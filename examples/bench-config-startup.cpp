@@ -0,0 +1,101 @@
+// Measures startup cost of registering large number of configs: key parsing, attribute
+// storage and flag binding, then the first update() of every registry.
+//
+//   bench-config-startup [num_registries=10]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "perfkit/configs.h"
+
+using namespace std::literals;
+
+struct profile
+{
+    std::vector<std::shared_ptr<perfkit::config_registry>> registries;
+    std::vector<std::unique_ptr<perfkit::config<int64_t>>> configs;
+};
+
+template <typename Fn_>
+static double elapsed_ms(Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static double resident_mb()
+{
+#ifdef __linux__
+    if (auto fp = fopen("/proc/self/statm", "r"))
+    {
+        unsigned long total = 0, resident = 0;
+        auto n = fscanf(fp, "%lu %lu", &total, &resident);
+        fclose(fp);
+
+        if (n == 2) { return resident * 4096. / (1 << 20); }
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_registries = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10;
+    size_t generation     = 0;
+
+    for (size_t num_keys : {10'000, 100'000})
+    {
+        auto p      = std::make_unique<profile>();
+        auto prefix = "bench-startup-" + std::to_string(++generation);
+        auto rss    = resident_mb();
+
+        auto t_register = elapsed_ms([&] {
+            for (size_t i = 0; i < num_registries; ++i)
+            {
+                p->registries.push_back(perfkit::config_registry::create(prefix + "-" + std::to_string(i)));
+            }
+
+            p->configs.reserve(num_keys);
+            for (size_t i = 0; i < num_keys; ++i)
+            {
+                auto& rg    = *p->registries[i % num_registries];
+                auto key    = "+0 group " + std::to_string(i % 97) + " | sub " + std::to_string(i % 13) + "|  key " + std::to_string(i);
+                auto config = perfkit::configure(rg, std::move(key), int64_t(0))
+                                      .description("startup benchmark entity")
+                                      .min(-1)
+                                      .max(1 << 20);
+
+                // expose every 100th entity as command line flag
+                if (i % 100 == 0)
+                    config.flags(prefix + ".flag-" + std::to_string(i));
+
+                p->configs.emplace_back(new perfkit::config<int64_t>(config.confirm()));
+            }
+        });
+
+        auto t_update = elapsed_ms([&] {
+            for (auto& rg : p->registries) { rg->update(); }
+        });
+
+        auto rss_registered = resident_mb();
+
+        // json attributes are built on demand, e.g. when exported to remote clients.
+        auto t_attribute = elapsed_ms([&] {
+            for (auto& conf : p->configs) { conf->base().attribute(); }
+        });
+
+        printf("%zu keys, %zu registries\n", num_keys, num_registries);
+        printf("  %-24s %10.2f ms\n", "register", t_register);
+        printf("  %-24s %10.2f ms\n", "first update", t_update);
+        printf("  %-24s %10.2f MB\n", "resident delta", rss_registered - rss);
+        printf("  %-24s %10.2f ms\n", "build json attributes", t_attribute);
+        printf("  %-24s %10.2f MB\n", "resident delta w/ json", resident_mb() - rss);
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Measures cost of configs::watcher dirty checks, against the former implementation which
+// looked up per-config fence in a hash map under spinlock.
+//
+//   bench-config-watcher [num_configs=1000] [num_rounds=20000]
+//
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "perfkit/configs.h"
+
+// former watcher, kept here only as a baseline.
+class map_watcher
+{
+   public:
+    bool check_dirty(perfkit::detail::config_base const& conf)
+    {
+        std::lock_guard _{_lock};
+        auto* fence = &_table[&conf];
+        if (*fence != conf.num_modified())
+            return *fence = conf.num_modified(), true;
+        else
+            return false;
+    }
+
+   private:
+    std::unordered_map<perfkit::detail::config_base const*, uint64_t> _table;
+    perfkit::spinlock _lock;
+};
+
+template <typename Fn_>
+static double ns_per_check(size_t num_checks, Fn_&& fn)
+{
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / num_checks;
+}
+
+int main(int argc, char** argv)
+{
+    size_t num_configs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+    size_t num_rounds  = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20000;
+
+    auto rg = perfkit::config_registry::create("bench-watcher");
+    std::vector<std::unique_ptr<perfkit::config<int64_t>>> configs;
+
+    for (size_t i = 0; i < num_configs; ++i)
+        configs.emplace_back(new perfkit::config<int64_t>(perfkit::configure(*rg, "key " + std::to_string(i), int64_t(i)).confirm()));
+
+    rg->update();
+
+    perfkit::configs::watcher watcher;
+    map_watcher baseline;
+
+    size_t num_dirty = 0;
+    auto run         = [&](auto&& check) {
+        for (size_t round = 0; round < num_rounds; ++round)
+        {
+            // modifies 1% of configs every 10 rounds
+            if (round % 10 == 0)
+            {
+                for (size_t i = round % 100; i < num_configs; i += 100)
+                    configs[i]->async_modify(int64_t(round));
+
+                rg->update();
+            }
+
+            for (auto& conf : configs) { num_dirty += check(*conf); }
+        }
+    };
+
+    auto num_checks = num_configs * num_rounds;
+    auto bitmap     = ns_per_check(num_checks, [&] { run([&](auto& c) { return watcher.check_dirty(c); }); });
+    auto hashmap    = ns_per_check(num_checks, [&] { run([&](auto& c) { return baseline.check_dirty(c.base()); }); });
+
+    printf("%zu configs, %zu rounds\n", num_configs, num_rounds);
+    printf("  %-28s %8.2f ns/check\n", "watcher (dirty bitmap)", bitmap);
+    printf("  %-28s %8.2f ns/check\n", "hash map + spinlock", hashmap);
+    printf("  (%zu dirty checks)\n", num_dirty);
+
+    return 0;
+}
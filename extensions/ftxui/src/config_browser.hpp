@@ -340,7 +340,7 @@ class config_node_builder
         Component inner;
         auto proto     = _content->serialize();
         auto ptr       = std::make_shared<_json_editor_builder>();
-        ptr->on_change = [cfg, ptr] { cfg->request_modify(ptr->rootobj); };
+        ptr->on_change = [cfg, ptr] { cfg->request_modify(ptr->rootobj, perfkit::configs::change_source::terminal); };
         ptr->cfg       = cfg;
         ptr->rootobj   = proto;
 
@@ -111,6 +111,26 @@ struct config_entity
             config_entity, class_key, content);
 };
 
+struct config_entity_patch
+{
+    constexpr static char ROUTE[] = "update:config_entity_patch";
+
+    struct entity_scheme
+    {
+        uint64_t config_key;
+        nlohmann::json patch;
+
+        CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(
+                entity_scheme, config_key, patch);
+    };
+
+    std::string class_key;
+    std::forward_list<entity_scheme> content;
+
+    CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(
+            config_entity_patch, class_key, content);
+};
+
 struct suggest_command
 {
     constexpr static char ROUTE[] = "rpc:suggest_command";
@@ -170,6 +190,52 @@ struct traces
             traces, class_name, root);
 };
 
+struct tracer_group_list
+{
+    constexpr static char ROUTE[] = "update:tracer_group_list";
+
+    std::forward_list<std::string> content;
+
+    CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(
+            tracer_group_list, content);
+};
+
+/**
+ * Aggregated traces of a tracer group, which is sent whenever the group is fetched.
+ * Nodes are flat, and linked to their parents by hash. Statistics of duration nodes are in
+ * microseconds, as values of TRACE_VALUE_DURATION_USEC traces are.
+ */
+struct tracer_group_traces
+{
+    constexpr static char ROUTE[] = "update:tracer_group_traces";
+
+    struct node_scheme
+    {
+        std::string key;
+        uint64_t hash;
+        uint64_t parent_hash;
+        int32_t depth;
+        int value_type;
+        int64_t num_instances;
+        double sum;
+        double min;
+        double max;
+        double mean;
+        std::string argmax_instance;
+        std::string sample;
+
+        CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(
+                node_scheme, key, hash, parent_hash, depth, value_type, num_instances,
+                sum, min, max, mean, argmax_instance, sample);
+    };
+
+    std::string group_name;
+    std::list<node_scheme> nodes;
+
+    CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(
+            tracer_group_traces, group_name, nodes);
+};
+
 }  // namespace perfkit::terminal::net::outgoing
 
 namespace perfkit::terminal::net::incoming {
@@ -223,6 +289,14 @@ struct signal_fetch_traces
     CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(signal_fetch_traces, targets);
 };
 
+struct signal_fetch_tracer_groups
+{
+    constexpr static char ROUTE[] = "cmd:signal_fetch_tracer_groups";
+    std::list<std::string> targets;
+
+    CPPHEADERS_DEFINE_NLOHMANN_JSON_ARCHIVER(signal_fetch_tracer_groups, targets);
+};
+
 struct control_trace
 {
     constexpr static char ROUTE[] = "cmd:control_trace";
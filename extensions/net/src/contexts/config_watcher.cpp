@@ -35,6 +35,16 @@ void config_watcher::update()
         {
             CPPH_DEBUG("{} registries disposed from last update", watches->end() - it_erase);
             watches->erase(it_erase, watches->end());
+
+            // discard entities of disposed registries
+            std::lock_guard lc{_mtx_entities};
+            auto* ents        = &_cache.entities;
+            auto it_ent_erase = perfkit::remove_if(*ents, [&](auto&& e) {
+                if (not e.config.expired()) { return false; }
+                return _cache.published.erase(e.key), true;
+            });
+
+            ents->erase(it_ent_erase, ents->end());
         }
 
         sort(regs, [](auto&& a, auto&& b) { return a.owner_before(b); });
@@ -62,57 +72,72 @@ void config_watcher::update()
         CPPH_TRACE("{} config registries are newly published.", diffs.size());
     }
 
-    // check for indivisual config's updates
-    if (_has_update)
+    // check for indivisual config's updates. subscription delivers changed ones only.
+    if (_has_update && _subscription)
     {
         _has_update = false;
 
         std::lock_guard lc{_mtx_entities};
-        auto& ents = _cache.entities;
+        auto* changed = &_cache.changed;
+        changed->clear();
+        _subscription->consume(changed);
 
         std::map<std::string_view, outgoing::config_entity> updates;
+        std::map<std::string_view, outgoing::config_entity_patch> patches;
 
-        for (auto it = ents.begin(); it != ents.end();)
+        for (auto& config : *changed)
         {
-            if (auto config = it->config.lock(); not config)
-            {  // config is expired.
-                *it = ents.back();
-                ents.pop_back();
-            }
-            else
+            auto it_sent = _cache.published.find(config.get());
+            if (it_sent == _cache.published.end())
+                continue;  // will be published with its registry.
+
+            auto class_name = config->owner()->name();
+            auto config_key = config_key_t::create(&*config).value;
+
+            // send only modified portion of container values, if client is up to date.
+            nlohmann::json ops;
+            if (config->_bk_patches_since(it_sent->second, &ops, &it_sent->second))
             {
-                if (it->update_fence != config->num_modified())
-                {
-                    auto [it_msg, is_new] = updates.try_emplace(it->class_name);
-                    auto* dst             = &it_msg->second;
+                if (ops.empty()) { continue; }
 
-                    if (is_new)
-                    {
-                        dst->class_key = it->class_name;
-                    }
+                auto [it_msg, is_new] = patches.try_emplace(class_name);
+                is_new && (it_msg->second.class_key = class_name, 0);
 
-                    auto* elem       = &dst->content.emplace_front();
-                    elem->value      = config->serialize();
-                    elem->config_key = it->id.value;
+                auto* elem       = &it_msg->second.content.emplace_front();
+                elem->patch      = std::move(ops);
+                elem->config_key = config_key;
+                continue;
+            }
 
-                    it->update_fence = config->num_modified();
-                }
+            auto [it_msg, is_new] = updates.try_emplace(class_name);
+            auto* dst             = &it_msg->second;
 
-                ++it;
+            if (is_new)
+            {
+                dst->class_key = class_name;
             }
+
+            auto* elem       = &dst->content.emplace_front();
+            elem->value      = _serialize(config.get(), &it_sent->second);
+            elem->config_key = config_key;
         }
 
         for (auto& [_, message] : updates)
         {
             io->send(message);
         }
+
+        for (auto& [_, message] : patches)
+        {
+            io->send(message);
+        }
     }
 }
 
 void config_watcher::_watchdog_once()
 {
-    auto has_update = perfkit::configs::wait_any_change(500ms, &_fence_value);
-    has_update && (_has_update.store(true), notify_change(), 0);
+    // blocks until any change is queued. returns immediately once closed by stop().
+    _subscription->wait() && (_has_update.store(true), notify_change(), 0);
 }
 
 void config_watcher::_publish_registry(perfkit::config_registry* rg)
@@ -132,7 +157,7 @@ void config_watcher::_publish_registry(perfkit::config_registry* rg)
         entity->class_name   = rg->name();
         entity->id           = config_key_t::create(&*config);
         entity->config       = config;
-        entity->update_fence = config->num_modified();
+        entity->key          = config.get();
 
         auto hierarchy = config->tokenized_display_key();
         auto* level    = &message.root;
@@ -154,7 +179,7 @@ void config_watcher::_publish_registry(perfkit::config_registry* rg)
 
         auto* dst       = &level->entities.emplace_back();
         dst->name       = config->tokenized_display_key().back();
-        dst->value      = config->serialize();
+        dst->value      = _serialize(config.get(), &_cache.published[config.get()]);
         dst->metadata   = config->attribute();
         dst->config_key = entity->id.value;
     }
@@ -164,18 +189,34 @@ void config_watcher::_publish_registry(perfkit::config_registry* rg)
     // puts(nlohmann::json{message}.dump(2).c_str());
 }
 
+nlohmann::json config_watcher::_serialize(perfkit::detail::config_base* config, size_t* fence)
+{
+    // value and its fence must be retrieved atomically, to apply further patches correctly.
+    nlohmann::json value;
+    config->serialize([&](nlohmann::json const& js) {
+        value  = js;
+        *fence = config->num_modified();
+    });
+
+    return value;
+}
+
 void config_watcher::stop()
 {
+    _subscription && (_subscription->close(), 0);
     _worker.shutdown();
+    _subscription.reset();
     _cache = {};
 }
 
 void config_watcher::start()
 {
+    _subscription = configs::subscription::create();
+    _subscription->watch_prefix("");
+
     // launch watchdog thread
     _worker.repeat(CPPH_BIND(_watchdog_once));
     _tmr_config_registry.invalidate();
-    _has_update = true;
 }
 
 void config_watcher::update_entity(
@@ -191,6 +232,6 @@ void config_watcher::update_entity(
     if (auto config = it->config.lock())
     {
         CPPH_TRACE("updating config entity {}:{}", it->class_name, config->display_key());
-        config->request_modify(std::move(value));
+        config->request_modify(std::move(value), perfkit::configs::change_source::net);
     }
 }
@@ -3,11 +3,13 @@
 //
 
 #pragma once
+#include <unordered_map>
 
 #include "if_watcher.hpp"
 #include "perfkit/common/hasher.hxx"
 #include "perfkit/common/thread/worker.hxx"
 #include "perfkit/common/timer.hxx"
+#include "perfkit/detail/config_subscription.hpp"
 #include "perfkit/detail/configs.hpp"
 #include "perfkit/extension/net-internals/messages.hpp"
 
@@ -28,11 +30,12 @@ class config_watcher : public if_watcher
    private:
     void _watchdog_once();
     void _publish_registry(config_registry* rg);
+    static nlohmann::json _serialize(perfkit::detail::config_base* config, size_t* fence);
 
    private:
     thread::worker _worker;
+    configs::subscription_ptr _subscription;
     std::atomic_bool _has_update = false;
-    uint64_t _fence_value        = 0;
     poll_timer _min_interval{50ms};
     poll_timer _tmr_config_registry{3s};
     spinlock _mtx_entities;
@@ -42,13 +45,15 @@ class config_watcher : public if_watcher
         config_key_t id;
         std::string_view class_name;
         std::weak_ptr<perfkit::detail::config_base> config;
-        uint64_t update_fence = 0;
+        perfkit::detail::config_base const* key = nullptr;  // for published set cleanup
     };
 
     struct _cache_type
     {
         std::vector<std::weak_ptr<perfkit::config_registry>> regs;
         std::vector<_entity_context> entities;
+        std::unordered_map<perfkit::detail::config_base const*, size_t> published;  // -> sent fence
+        std::vector<config_shared_ptr> changed;
     } _cache;
 };
 
@@ -4,6 +4,8 @@
 
 #include "trace_watcher.hpp"
 
+#include <algorithm>
+
 #include <spdlog/spdlog.h>
 
 #include "../utils.hpp"
@@ -25,6 +27,7 @@ void perfkit::terminal::net::context::trace_watcher::stop()
 {
     if_watcher::stop();
     _watching.clear();
+    _watching_groups.clear();
 
     if (_event_lifespan)
         while (not _event_lifespan.unique())
@@ -89,7 +92,137 @@ void perfkit::terminal::net::context::trace_watcher::update()
 
             io->send(list);
         }
+
+        _enumerate_groups();
+    }
+}
+
+void perfkit::terminal::net::context::trace_watcher::_enumerate_groups()
+{
+    auto all     = perfkit::tracer_group::all();
+    bool any_new = false;
+
+    for (auto& group : all)
+    {
+        auto is_same = [&](auto& watched) {
+            return not watched.owner_before(group) && not group.owner_before(watched);
+        };
+
+        if (std::any_of(_watching_groups.begin(), _watching_groups.end(), is_same))
+            continue;
+
+        group->on_fetch +=
+                [this,
+                 life   = std::weak_ptr{_event_lifespan},
+                 wgroup = std::weak_ptr{group}]  //
+                (tracer_group::snapshot const& snapshot) {
+                    if (auto _ = life.lock())
+                    {
+                        _dispatch_group_snapshot(wgroup, snapshot);
+                        return true;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                };
+
+        any_new = true;
+    }
+
+    // list is published again when any group is added or expired.
+    if (not any_new && all.size() == _watching_groups.size())
+        return;
+
+    CPPH_DEBUG("tracer group list changed. publishing {} group names ...", all.size());
+    _watching_groups.assign(all.begin(), all.end());
+
+    {
+        auto table = _group_table.lock();
+        table->clear();
+
+        for (auto& group : all)
+            table->emplace(group->name(), group);
     }
+
+    outgoing::tracer_group_list list;
+    perfkit::transform(
+            all, std::front_inserter(list.content),
+            [](decltype(all[0])& s) {
+                return s->name();
+            });
+
+    io->send(list);
+}
+
+void perfkit::terminal::net::context::trace_watcher::_dispatch_group_snapshot(
+        std::weak_ptr<perfkit::tracer_group> wgroup,
+        perfkit::tracer_group::snapshot const& snapshot)
+{
+    auto group = wgroup.lock();
+    if (not group)
+        return;
+
+    using value_type = perfkit::tracer_group::value_type;
+
+    // message is built on group's thread, as snapshot is valid only during this call.
+    auto msg        = std::make_shared<outgoing::tracer_group_traces>();
+    msg->group_name = group->name();
+
+    for (auto& node : snapshot)
+    {
+        auto& dst           = msg->nodes.emplace_back();
+        dst.key             = node.key;
+        dst.hash            = node.hash;
+        dst.parent_hash     = node.parent_hash;
+        dst.depth           = int32_t(node.depth);
+        dst.num_instances   = int64_t(node.num_instances);
+        dst.argmax_instance = node.argmax_instance;
+        dst.sample          = node.sample;
+
+        double scale = 1.;
+        switch (node.type)
+        {
+            case value_type::none:
+                dst.value_type = outgoing::TRACE_VALUE_NULLPTR;
+                break;
+
+            case value_type::duration:
+                dst.value_type = outgoing::TRACE_VALUE_DURATION_USEC;
+                scale          = 1e6;  // seconds to microseconds
+                break;
+
+            case value_type::integer:
+                dst.value_type = outgoing::TRACE_VALUE_INTEGER;
+                break;
+
+            case value_type::floating_point:
+                dst.value_type = outgoing::TRACE_VALUE_FLOATING_POINT;
+                break;
+
+            case value_type::boolean:
+                dst.value_type = outgoing::TRACE_VALUE_BOOLEAN;
+                break;
+
+            case value_type::string:
+                dst.value_type = outgoing::TRACE_VALUE_STRING;
+                break;
+        }
+
+        dst.sum  = node.sum * scale;
+        dst.min  = node.min * scale;
+        dst.max  = node.max * scale;
+        dst.mean = node.mean * scale;
+    }
+
+    io->dispatch(
+            [this,
+             msg  = std::move(msg),
+             life = std::weak_ptr{_event_lifespan}]  //
+            {
+                if (auto _ = life.lock())
+                    io->send(*msg);
+            });
 }
 
 void perfkit::terminal::net::context::trace_watcher::_dispatch_fetched_trace(
@@ -248,6 +381,22 @@ void perfkit::terminal::net::context::trace_watcher::signal(std::string_view cla
     tracer->request_fetch_data();
 }
 
+void perfkit::terminal::net::context::trace_watcher::signal_group(std::string_view group_name)
+{
+    auto lock = _group_table.lock();
+
+    auto it = lock->find(group_name);
+    if (it == lock->end())
+        return;
+
+    auto group = it->second.lock();
+    if (not group)
+        return;
+
+    CPPH_TRACE("trace signal to group {}", group_name);
+    group->request_fetch_data();
+}
+
 void perfkit::terminal::net::context::trace_watcher::tweak(
         uint64_t key, const bool* subscr, const bool* fold)
 {
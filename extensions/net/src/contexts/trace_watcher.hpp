@@ -22,12 +22,16 @@ class trace_watcher : public if_watcher
 
    public:
     void signal(std::string_view);
+    void signal_group(std::string_view);
     void tweak(uint64_t key, bool const* subscr, bool const* fold);
 
    private:
     void _dispatch_fetched_trace(std::weak_ptr<perfkit::tracer> tracer, tracer::fetched_traces const&);
     void _dispatcher_fn(const std::shared_ptr<perfkit::tracer>& tracer, tracer::fetched_traces& traces);
 
+    void _enumerate_groups();
+    void _dispatch_group_snapshot(std::weak_ptr<tracer_group> group, tracer_group::snapshot const&);
+
    private:
     struct _trace_node
     {
@@ -40,6 +44,9 @@ class trace_watcher : public if_watcher
     std::vector<std::weak_ptr<tracer>> _watching;
     locked<std::map<std::string, std::weak_ptr<tracer>, std::less<>>> _signal_table;
 
+    std::vector<std::weak_ptr<tracer_group>> _watching_groups;
+    locked<std::map<std::string, std::weak_ptr<tracer_group>, std::less<>>> _group_table;
+
     pool<perfkit::tracer::fetched_traces> _pool_traces;
 
     std::unordered_map<trace_key_t, _trace_node> _nodes;
@@ -47,6 +47,7 @@ perfkit::terminal::net::terminal::terminal(
     _io.on_recv<incoming::suggest_command>(CPPH_BIND(_on_suggest_request));
     _io.on_recv<incoming::control_trace>(CPPH_BIND(_on_trace_tweak));
     _io.on_recv<incoming::signal_fetch_traces>(CPPH_BIND(_on_trace_signal));
+    _io.on_recv<incoming::signal_fetch_tracer_groups>(CPPH_BIND(_on_group_signal));
 
     // launch asynchronous IO thread.
     _io.launch();
@@ -188,6 +189,15 @@ void perfkit::terminal::net::terminal::_on_trace_signal(
     }
 }
 
+void perfkit::terminal::net::terminal::_on_group_signal(
+        perfkit::terminal::net::incoming::signal_fetch_tracer_groups&& s)
+{
+    for (auto& sig : s.targets)
+    {
+        _context.traces.signal_group(sig);
+    }
+}
+
 void perfkit::terminal::net::terminal::_on_trace_tweak(incoming::control_trace&& s)
 {
     _context.traces.tweak(
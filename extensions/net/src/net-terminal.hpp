@@ -72,6 +72,7 @@ class terminal : public if_terminal
     void _on_suggest_request(incoming::suggest_command&& s);
     void _on_any_connection(int n_conn);
     void _on_trace_signal(incoming::signal_fetch_traces&& s);
+    void _on_group_signal(incoming::signal_fetch_tracer_groups&& s);
     void _on_trace_tweak(incoming::control_trace&& s);
     void _on_no_connection();
 
@@ -1,5 +1,11 @@
 #pragma once
 #include "perfkit/common/template_utils.hxx"
+#include "perfkit/detail/config_dispatch.hpp"
+#include "perfkit/detail/config_file_watcher.hpp"
+#include "perfkit/detail/config_journal.hpp"
+#include "perfkit/detail/config_shm.hpp"
+#include "perfkit/detail/config_snapshot.hpp"
+#include "perfkit/detail/config_subscription.hpp"
 #include "perfkit/detail/configs.hpp"
 #include "perfkit/fwd.hpp"
 
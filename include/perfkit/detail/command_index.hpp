@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace perfkit::commands {
+/**
+ * Compressed radix trie of command tokens, which answers prefix queries of autocomplete
+ * without scanning every candidate.
+ *
+ * Each node carries number of keys in its subtree, thus counting keys of a prefix costs
+ * only descent to it, and a page of keys can be collected by skipping whole subtrees which
+ * precede the requested offset. Keys are enumerated in lexicographic order.
+ *
+ * Position of the latest query is cached, thus a query whose prefix extends the previous
+ * one, i.e. user typing more characters of a token, continues descent from there. Cache is
+ * invalidated by any modification. Not thread-safe.
+ */
+class radix_index
+{
+   public:
+    radix_index();
+    ~radix_index() noexcept;
+
+    radix_index(radix_index&&) noexcept;
+    radix_index& operator=(radix_index&&) noexcept;
+
+   public:
+    /** @return false if already exists. */
+    bool insert(std::string_view key);
+
+    /** @return false if not found. */
+    bool erase(std::string_view key);
+
+    void clear() noexcept;
+
+    bool contains(std::string_view key) const;
+    size_t size() const noexcept;
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Number of keys which start with prefix. */
+    size_t count(std::string_view prefix) const;
+
+    /**
+     * Appends keys which start with prefix, skipping first `offset` of them.
+     * @return number of appended keys.
+     */
+    size_t collect(std::string_view prefix, size_t offset, size_t limit,
+                   std::vector<std::string>* out) const;
+
+    /**
+     * Longest string which every key starting with prefix starts with.
+     * @return false if no key starts with prefix.
+     */
+    bool common_prefix(std::string_view prefix, std::string* out) const;
+
+    /**
+     * @return true if exactly one key starts with prefix, which is written to out.
+     */
+    bool find_unique(std::string_view prefix, std::string* out) const;
+
+   private:
+    struct _node;
+
+    // node whose subtree consists of keys starting with prefix, and remaining characters of
+    // its label which follow the prefix.
+    struct _locus
+    {
+        _node const* node = nullptr;
+        std::string_view tail;
+    };
+
+    _locus _locate(std::string_view prefix) const;
+
+   private:
+    std::unique_ptr<_node> _root;
+
+    // descent cache of the latest query.
+    mutable std::string _cached_prefix;
+    mutable _locus _cached;
+    mutable bool _cache_valid = false;
+};
+}  // namespace perfkit::commands
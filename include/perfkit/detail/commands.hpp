@@ -2,6 +2,7 @@
 // Created by Seungwoo on 2021-08-27.
 //
 #pragma once
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -9,6 +10,7 @@
 #include <set>
 
 #include "perfkit/common/array_view.hxx"
+#include "perfkit/detail/command_index.hpp"
 
 namespace perfkit::commands {
 class registry;
@@ -33,6 +35,10 @@ struct command_name_invalid_exception : std::exception
 /**
  * Tokenize given string with os argc-argv rule.
  *
+ * Tokens are separated by whitespaces, and a token wrapped with double quotes may contain
+ * them. Backslash escapes following character, where escaped space, backslash and quotes
+ * are unescaped. Tokens are written back to given string, which tokens refer to.
+ *
  * @param src
  * @param tokens
  */
@@ -55,6 +61,19 @@ using invoke_void_fn = std::function<void(args_view full_tokens)>;
 using string_set              = std::set<std::string, std::less<>>;
 using autocomplete_suggest_fn = std::function<void(args_view hint, string_set& candidates)>;
 
+/**
+ * Range of suggestions to retrieve. A command tree may carry tens of thousands of
+ * candidates, e.g. every config key, which must not be copied out on every keystroke.
+ */
+struct suggest_page
+{
+    size_t offset = 0;
+    size_t limit  = ~size_t{};
+
+    // [out] number of every matching candidate, regardless of the range.
+    size_t total = 0;
+};
+
 class registry
 {
    public:
@@ -182,6 +201,15 @@ class registry
          */
         void reset_suggest_handler(autocomplete_suggest_fn fn);
 
+        /**
+         * Reset suggest fn, whose candidates depend only on preceding tokens, thus never on
+         * the token being completed, which is excluded from hint.
+         *
+         * Candidates are indexed and cached per hint for a short period, thus typing a token
+         * only narrows down the index, instead of invoking fn on every keystroke.
+         */
+        void reset_suggest_index(autocomplete_suggest_fn fn);
+
         /**
          * Set operation hook which is invoked before every suggest/invoke
          */
@@ -201,7 +229,8 @@ class registry
                 std::vector<std::string>& out_candidates,
                 bool space_after_last_token,
                 int* target_token_index    = nullptr,
-                bool* out_has_unique_match = nullptr);
+                bool* out_has_unique_match = nullptr,
+                suggest_page* page         = nullptr);
 
         /**
          * Invoke command with given arguments.
@@ -222,12 +251,17 @@ class registry
         node const* _find_subcommand(std::string_view cmd_or_alias) const;
         node* _find_subcommand(std::string_view cmd_or_alias);
 
+        radix_index const* _indexed_suggests(args_view hint);
+
        private:
         friend class registry;
 
         std::map<std::string const, node, std::less<>> _subcommands;
         std::map<std::string const, std::string const, std::less<>> _aliases;
 
+        // names of subcommands and aliases, for prefix queries.
+        radix_index _index;
+
         node* _parent;
         std::recursive_mutex* _subcmd_lock;
 
@@ -235,6 +269,16 @@ class registry
         autocomplete_suggest_fn _suggest;
         std::function<void(node*, args_view)> _hook_pre_op;
         bool _constant_name = {};
+
+        struct _suggest_cache
+        {
+            autocomplete_suggest_fn fn;
+            std::vector<std::string> hint;
+            radix_index index;
+            std::chrono::steady_clock::time_point expiry;
+        };
+
+        std::unique_ptr<_suggest_cache> _suggest_indexed;
     };
 
    public:
@@ -250,7 +294,8 @@ class registry
     intptr_t add_invoke_hook(hook_fn hook);
     bool remove_invoke_hook(intptr_t);
 
-    std::string suggest(std::string line, std::vector<std::string>* candidates);
+    std::string suggest(std::string line, std::vector<std::string>* candidates,
+                        suggest_page* page = nullptr);
 
    public:
     node* _get_root() { return _root.get(); }
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#if _MSC_VER
+#    include <intrin.h>
+#endif
+
+namespace perfkit::detail {
+class config_base;
+}
+
+namespace perfkit::_configs {
+inline int _count_trailing_zeros(uint64_t bits) noexcept
+{
+#if _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return int(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+/**
+ * Dirty flags of configs watched by a watcher, within single registry.
+ *
+ * Watched configs are assigned dense slots in order of registration, and registry update()
+ * sets bit of slot for each applied config, which is found by config's dense index without
+ * any hashing. Checking a config tests and clears single bit, and collecting every changed
+ * config iterates only nonzero words.
+ *
+ * Slots are assigned by single writer, i.e. under watcher's lock, while bits are set and
+ * cleared concurrently. Capacity is fixed to number of configs of registry at creation.
+ */
+class dirty_block
+{
+   public:
+    static constexpr uint32_t npos = ~uint32_t{};
+
+   public:
+    explicit dirty_block(size_t capacity)
+            : _capacity(capacity),
+              _slot_of(new std::atomic_uint32_t[capacity]),
+              _bound(new detail::config_base*[capacity]),
+              _words(new std::atomic_uint64_t[(capacity + 63) / 64])
+    {
+        for (size_t i = 0; i < capacity; ++i) { _slot_of[i].store(npos, std::memory_order_relaxed); }
+        for (size_t i = 0; i < (capacity + 63) / 64; ++i) { _words[i].store(0, std::memory_order_relaxed); }
+    }
+
+   public:
+    bool covers(uint32_t dense_index) const noexcept { return dense_index < _capacity; }
+
+    uint32_t slot_of(uint32_t dense_index) const noexcept
+    {
+        return _slot_of[dense_index].load(std::memory_order_acquire);
+    }
+
+    /** Assigns next slot to config. Must not be called concurrently. */
+    uint32_t assign(detail::config_base* conf, uint32_t dense_index, bool dirty) noexcept
+    {
+        auto slot    = _num_slots.load(std::memory_order_relaxed);
+        _bound[slot] = conf;
+
+        dirty && (_words[slot / 64].fetch_or(uint64_t{1} << slot % 64), 0);
+        _slot_of[dense_index].store(slot, std::memory_order_release);
+        _num_slots.store(slot + 1, std::memory_order_release);
+        return slot;
+    }
+
+    /** Called by registry update() for each applied config. */
+    void mark(uint32_t dense_index) noexcept
+    {
+        if (not covers(dense_index)) { return; }
+
+        auto slot = slot_of(dense_index);
+        if (slot == npos) { return; }
+
+        _words[slot / 64].fetch_or(uint64_t{1} << slot % 64, std::memory_order_release);
+    }
+
+    /** Tests and clears dirty bit of slot. */
+    bool consume(uint32_t slot) noexcept
+    {
+        auto& word = _words[slot / 64];
+        auto bit   = uint64_t{1} << slot % 64;
+
+        // plain load first, thus checking clean config never writes shared cache line.
+        if ((word.load(std::memory_order_relaxed) & bit) == 0) { return false; }
+        return word.fetch_and(~bit, std::memory_order_acq_rel) & bit;
+    }
+
+    /** Invokes fn with every dirty config, then clears them. */
+    template <typename Fn_>
+    size_t consume_all(Fn_&& fn)
+    {
+        size_t count   = 0;
+        auto num_words = (_num_slots.load(std::memory_order_acquire) + 63) / 64;
+
+        for (size_t i = 0; i < num_words; ++i)
+        {
+            if (_words[i].load(std::memory_order_relaxed) == 0) { continue; }
+
+            for (auto bits = _words[i].exchange(0, std::memory_order_acq_rel); bits; bits &= bits - 1)
+                fn(_bound[i * 64 + _count_trailing_zeros(bits)]), ++count;
+        }
+
+        return count;
+    }
+
+   private:
+    size_t const _capacity;
+    std::unique_ptr<std::atomic_uint32_t[]> _slot_of;  // dense index of config -> slot
+    std::unique_ptr<detail::config_base*[]> _bound;     // slot -> config
+    std::unique_ptr<std::atomic_uint64_t[]> _words;
+    std::atomic_uint32_t _num_slots{0};
+};
+}  // namespace perfkit::_configs
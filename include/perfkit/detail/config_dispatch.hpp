@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit {
+template <typename Fn_>
+class dispatch;
+
+/**
+ * Table of implementation variants, selected by a config which is usually declared with
+ * one_of(). Variants are registered under allowed values of the config, and the resolved
+ * function pointer is swapped when registry update() applies new value. Thus each call costs
+ * single atomic load and indirect call, instead of checking config value on every call.
+ *
+ * If selected value has no variant, the first added variant is used.
+ *
+ * @code
+ *   dispatch<float(float const*, size_t)> sum{cfg_kernel, {{"scalar", &sum_scalar},
+ *                                                          {"avx2", &sum_avx2}}};
+ *
+ *   auto timer = trc.timer(sum.active_name());  // compare variants in tracer
+ *   auto value = sum(data, size);
+ * @endcode
+ */
+template <typename Ret_, typename... Args_>
+class dispatch<Ret_(Args_...)>
+{
+   public:
+    using function_type = Ret_ (*)(Args_...);
+
+   public:
+    template <typename Key_>
+    explicit dispatch(config<Key_> const& selector)
+            : _owner(selector.base().owner()),
+              _state(std::make_shared<_table>())
+    {
+        auto& base = selector.base();
+
+        _state->key_name = [](void const* value) { return _name_of(*(Key_ const*)value); };
+
+        if (auto& attr = base.attribute(); attr.contains("one_of"))
+            for (auto& allowed : attr["one_of"]) { _state->allowed.push_back(_name_of(allowed)); }
+
+        base._bk_add_observer(
+                [wstate = std::weak_ptr{_state}](void const* value) {
+                    auto state = wstate.lock();
+                    return state && (state->select(state->key_name(value)), true);
+                });
+    }
+
+    template <typename Key_>
+    dispatch(config<Key_> const& selector,
+             std::initializer_list<std::pair<Key_, function_type>> variants)
+            : dispatch(selector)
+    {
+        for (auto& [key, fn] : variants) { add(key, fn); }
+    }
+
+    dispatch(dispatch const&) = delete;
+    dispatch& operator=(dispatch const&) = delete;
+
+   public:
+    /** @throw std::invalid_argument if key is not allowed value of selector config. */
+    template <typename Key_>
+    dispatch& add(Key_ const& key, function_type fn)
+    {
+        auto name     = _name_of(key);
+        auto& allowed = _state->allowed;
+
+        if (not allowed.empty() && std::find(allowed.begin(), allowed.end(), name) == allowed.end())
+            throw std::invalid_argument("dispatch: '" + name + "' is not allowed value of selector");
+
+        auto _ = _owner->_access_lock();
+        _state->variants.push_back({std::move(name), fn});
+        _state->select(_state->selected);
+
+        return *this;
+    }
+
+    /** @throw std::bad_function_call if no variant is added. */
+    Ret_ operator()(Args_... args) const
+    {
+        auto fn = _state->fn.load(std::memory_order_acquire);
+        if (not fn) { throw std::bad_function_call{}; }
+
+        return fn(std::forward<Args_>(args)...);
+    }
+
+    /** nullptr if no variant is added. */
+    function_type get() const noexcept { return _state->fn.load(std::memory_order_acquire); }
+
+    /** name of active variant, which is selector value. empty if no variant is added. */
+    std::string_view active_name() const noexcept
+    {
+        auto active = _state->active.load(std::memory_order_acquire);
+        return active ? std::string_view{active->name} : std::string_view{};
+    }
+
+   private:
+    template <typename Key_>
+    static std::string _name_of(Key_ const& key)
+    {
+        nlohmann::json js = key;
+        return js.is_string() ? js.template get<std::string>() : js.dump();
+    }
+
+    struct _variant
+    {
+        std::string name;
+        function_type fn;
+    };
+
+    // shared with observer of selector config. guarded by owner's update lock, except atomics.
+    struct _table
+    {
+        std::atomic<function_type> fn{nullptr};
+        std::atomic<_variant const*> active{nullptr};
+
+        std::deque<_variant> variants;  // never reallocates, as active refers to it
+        std::vector<std::string> allowed;
+        std::string selected;
+        std::string (*key_name)(void const*) = nullptr;
+
+        void select(std::string name)
+        {
+            selected = std::move(name);
+
+            auto it = std::find_if(variants.begin(), variants.end(),
+                                   [&](_variant const& v) { return v.name == selected; });
+
+            auto found = it != variants.end() ? &*it : variants.empty() ? nullptr : &variants.front();
+            active.store(found, std::memory_order_release);
+            fn.store(found ? found->fn : nullptr, std::memory_order_release);
+        }
+    };
+
+   private:
+    config_registry* _owner;
+    std::shared_ptr<_table> _state;
+};
+}  // namespace perfkit
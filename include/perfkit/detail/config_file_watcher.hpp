@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace perfkit::configs {
+/**
+ * Watches a configuration file on background thread, and reloads it on modification.
+ *
+ * Bursts of modifications (e.g. editor writing temporary file then renaming it) are
+ * debounced, and only values which differ from previously loaded ones are queued, thus
+ * unchanged configs won't get dirty flags. Uses inotify on linux, and polls modification
+ * time on other platforms.
+ */
+class file_watcher
+{
+   public:
+    explicit file_watcher(std::string path, std::chrono::milliseconds debounce = std::chrono::milliseconds{200});
+    ~file_watcher();
+
+    file_watcher(file_watcher const&) = delete;
+    file_watcher& operator=(file_watcher const&) = delete;
+
+   public:
+    auto& path() const noexcept { return _path; }
+    size_t num_reloads() const noexcept { return _num_reloads.load(std::memory_order_relaxed); }
+
+   private:
+    void _worker_fn();
+    void _reload();
+
+   private:
+    std::string const _path;
+    std::chrono::milliseconds const _debounce;
+
+    std::atomic_size_t _num_reloads = 0;
+    std::atomic_bool _active        = true;
+    int _fd_stop                    = -1;
+    std::thread _worker;
+};
+}  // namespace perfkit::configs
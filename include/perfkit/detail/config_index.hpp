@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "perfkit/common/hasher.hxx"
+
+namespace perfkit::_configs {
+/**
+ * Immutable lookup table of string keys, built once from fixed set of entries.
+ *
+ * Entries are kept in flat array sorted by key. Index is hash-and-displace perfect hash:
+ * keys are distributed into small buckets by their hash, then each bucket finds its own
+ * displacement seed which places every key of the bucket into distinct vacant slot. Thus
+ * lookup costs single hash of the key, two array accesses and one key comparison.
+ */
+template <typename Value_>
+class perfect_hash_index
+{
+   public:
+    using value_type = std::pair<std::string_view, Value_>;
+
+   public:
+    /**
+     * Keys must outlive this index.
+     * @return false if index couldn't be built, e.g. duplicated keys.
+     */
+    bool build(std::vector<value_type> entries)
+    {
+        clear();
+        std::sort(entries.begin(), entries.end(),
+                  [](auto& a, auto& b) { return a.first < b.first; });
+
+        auto dup = std::adjacent_find(entries.begin(), entries.end(),
+                                      [](auto& a, auto& b) { return a.first == b.first; });
+        if (dup != entries.end()) { return false; }
+        if (entries.empty()) { return true; }
+
+        auto n_entries = entries.size();
+        auto n_buckets = n_entries / 4 + 1;
+        auto n_slots   = n_entries + n_entries / 4 + 1;  // load factor 0.8
+
+        std::vector<uint64_t> hashes(n_entries);
+        std::vector<std::vector<uint32_t>> buckets(n_buckets);
+        for (uint32_t i = 0; i < n_entries; ++i)
+        {
+            hashes[i] = _hash(entries[i].first);
+            buckets[hashes[i] % n_buckets].push_back(i);
+        }
+
+        std::vector<uint32_t> order(n_buckets);
+        for (uint32_t i = 0; i < n_buckets; ++i) { order[i] = i; }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](auto a, auto b) { return buckets[a].size() > buckets[b].size(); });
+
+        std::vector<uint32_t> seeds(n_buckets, 0);
+        std::vector<uint32_t> slots(n_slots, ~uint32_t{});
+        std::vector<uint32_t> placed;
+
+        for (auto bucket_index : order)
+        {
+            auto& bucket = buckets[bucket_index];
+            if (bucket.empty()) { break; }  // rest of buckets are all empty.
+
+            uint32_t seed = 1;
+            for (; seed < max_seed; ++seed)
+            {
+                placed.clear();
+                for (auto entry : bucket)
+                {
+                    auto slot = _slot_of(hashes[entry], seed, n_slots);
+                    if (slots[slot] != ~uint32_t{}) { break; }
+                    if (std::find(placed.begin(), placed.end(), slot) != placed.end()) { break; }
+
+                    placed.push_back(slot);
+                }
+
+                if (placed.size() == bucket.size()) { break; }
+            }
+
+            if (seed == max_seed) { return false; }  // i.e. two keys with same 64-bit hash.
+
+            seeds[bucket_index] = seed;
+            for (size_t i = 0; i < bucket.size(); ++i) { slots[placed[i]] = bucket[i]; }
+        }
+
+        _entries = std::move(entries);
+        _seeds   = std::move(seeds);
+        _slots   = std::move(slots);
+        return true;
+    }
+
+    Value_ const* find(std::string_view key) const noexcept
+    {
+        if (_entries.empty()) { return nullptr; }
+
+        auto hash  = _hash(key);
+        auto seed  = _seeds[hash % _seeds.size()];
+        auto entry = _slots[_slot_of(hash, seed, _slots.size())];
+
+        if (entry == ~uint32_t{}) { return nullptr; }
+        if (_entries[entry].first != key) { return nullptr; }
+        return &_entries[entry].second;
+    }
+
+    void clear() noexcept
+    {
+        _entries.clear();
+        _seeds.clear();
+        _slots.clear();
+    }
+
+    auto const& entries() const noexcept { return _entries; }
+    size_t size() const noexcept { return _entries.size(); }
+    bool empty() const noexcept { return _entries.empty(); }
+
+   private:
+    enum : uint32_t
+    {
+        max_seed = 1 << 16
+    };
+
+    static uint64_t _hash(std::string_view key) noexcept
+    {
+        return hasher::fnv1a_64(key);
+    }
+
+    static size_t _slot_of(uint64_t hash, uint32_t seed, size_t n_slots) noexcept
+    {
+        // finalizer of murmur3, to decorrelate slot from bucket index
+        auto h = hash ^ (seed * 0x9e3779b97f4a7c15ull);
+        h ^= h >> 33, h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33, h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h % n_slots;
+    }
+
+   private:
+    std::vector<value_type> _entries;  // sorted by key
+    std::vector<uint32_t> _seeds;      // displacement seed per bucket
+    std::vector<uint32_t> _slots;      // slot -> index of entry
+};
+}  // namespace perfkit::_configs
@@ -0,0 +1,150 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "perfkit/common/array_view.hxx"
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit::configs {
+struct journal_options
+{
+    // records are fsync'd at most once in this interval.
+    std::chrono::milliseconds fsync_interval{100};
+
+    // compacts journal into snapshot when number of records exceeds this.
+    size_t compact_threshold = 1 << 16;
+};
+
+/**
+ * Append-only log of applied config changes, which replaces periodic export_to() calls.
+ *
+ * Every change applied by registry update() is appended as single json line, which is
+ * written and fsync'd by background thread in batches, thus cost of saving is proportional
+ * to number of changes instead of size of whole configuration. Container patches are
+ * recorded as patches. Once number of records exceeds threshold, the journal is compacted
+ * into single snapshot record, which is written to temporary file then atomically renamed.
+ *
+ *   {"ts":1634000000000000,"snapshot":{...}}
+ *   {"ts":1634000000000123,"rg":"registry","key":"display|key","src":"net","value":3}
+ *   {"ts":1634000000000456,"rg":"registry","key":"display|key","src":"api","patch":[...]}
+ *
+ * Torn line at the end of file, which can be left by crash, is ignored on read.
+ */
+class journal
+{
+   public:
+    using clock = std::chrono::system_clock;
+    using options = journal_options;
+
+    struct record
+    {
+        enum kind_t
+        {
+            value,
+            patch,
+            snapshot,
+        };
+
+        kind_t kind = value;
+        clock::time_point timestamp;
+        change_source source = change_source::api;
+
+        std::string registry;
+        std::string key;  // display key
+        nlohmann::json data;
+
+        // config and its journal sequence, of records being queued.
+        detail::config_base* _config = nullptr;
+        uint64_t _sequence           = 0;
+    };
+
+   public:
+    /**
+     * Opens journal file for append. New or empty journal starts with snapshot of current
+     * configurations, thus replaying it never depends on other files.
+     *
+     * @return nullptr if file couldn't be opened.
+     */
+    static auto open(std::string path, options opts = {}) -> std::shared_ptr<journal>;
+
+    /**
+     * Reads every valid record of journal in order.
+     * @return false if file couldn't be opened.
+     */
+    static bool read(std::string_view path, std::function<void(record&)> const& visit);
+
+    /**
+     * Reconstructs configurations from journal, then imports them. Records after given time
+     * are ignored, which reproduces configurations of that moment.
+     *
+     * @return false if file couldn't be opened, or given time precedes the journal's snapshot.
+     */
+    static bool replay(std::string_view path, std::optional<clock::time_point> until = {});
+
+   public:
+    ~journal() noexcept;
+
+    journal(journal const&) = delete;
+    journal& operator=(journal const&) = delete;
+
+   public:
+    /** Blocks until every change applied before this call is written and fsync'd. */
+    void flush();
+
+    /** Rewrites journal as single snapshot record. */
+    void compact();
+
+    auto& path() const noexcept { return _path; }
+    size_t num_records() const noexcept;
+
+   public:
+    // called from registry update() under its update lock, with successfully applied configs.
+    static void _bk_record(array_view<detail::config_base* const> changed);
+
+   private:
+    journal(std::string path, options opts);
+
+    bool _open_file();
+    bool _write_snapshot();
+    bool _is_covered(record const& rec) const;
+    void _request(bool compact);
+    void _worker_fn();
+
+   private:
+    std::string const _path;
+    options const _opts;
+    std::FILE* _file = nullptr;
+
+    mutable std::mutex _mtx;
+    std::condition_variable _cvar;
+    std::condition_variable _cvar_done;
+
+    std::vector<record> _queue;
+    size_t _num_records = 0;  // records since last snapshot, including queued ones
+
+    // journal sequence of each config, which the latest snapshot includes.
+    std::unordered_map<detail::config_base const*, uint64_t> _snapshot_fence;
+
+    // requests are served by worker in order of tickets.
+    uint64_t _ticket_issued = 0;
+    uint64_t _ticket_served = 0;
+    bool _compact_requested = false;
+    bool _stop              = false;
+
+    std::thread _worker;
+};
+
+using journal_ptr = std::shared_ptr<journal>;
+}  // namespace perfkit::configs
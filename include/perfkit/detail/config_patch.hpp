@@ -0,0 +1,196 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace perfkit::_configs {
+/**
+ * Single operation of config patch, which is JSON Patch (RFC 6902) like array of objects:
+ *
+ *   {"op": "replace", "path": "/3", "value": 1.5}         replace element, or set map value
+ *   {"op": "add", "path": "/3" | "/-", "value": 1.5}      insert element, or set map value
+ *   {"op": "remove", "path": "/3"}                        erase element, or map key if exists
+ *   {"op": "replace_range", "path": "/3", "value": [..]}  replace consecutive elements
+ *   {"op": "remove_range", "path": "/3", "count": 4}      erase consecutive elements
+ *
+ * Path is JSON pointer. Containers apply patches whose paths are all top-level in place,
+ * others are applied on json representation then deserialized as a whole.
+ */
+struct patch_op
+{
+    enum kind_t
+    {
+        replace,
+        add,
+        remove,
+        replace_range,
+        remove_range,
+    };
+
+    kind_t kind;
+    std::string_view path;
+    std::string token;  // unescaped last reference token of path
+    size_t depth = 0;
+
+    nlohmann::json const* value = nullptr;
+    size_t count                = 0;
+};
+
+/** @return false if any of operation is malformed. */
+bool parse_patch(nlohmann::json const& ops, std::vector<patch_op>* out);
+
+/** whether every operation targets direct child of root. */
+bool is_shallow(std::vector<patch_op> const& ops) noexcept;
+
+/**
+ * Applies patch on json representation.
+ * @warning target may be partially modified on failure. apply on copy to make it atomic.
+ */
+bool apply_patch(nlohmann::json* target, nlohmann::json const& ops);
+
+/** parses array index token. '-' is end of array. */
+bool parse_index(std::string_view token, size_t size, size_t* out) noexcept;
+
+template <typename Ty_, typename = void>
+constexpr bool is_patchable_sequence_v = false;
+
+template <typename Ty_>
+constexpr bool is_patchable_sequence_v<
+        Ty_, std::void_t<typename Ty_::value_type,
+                         decltype(std::declval<Ty_&>().begin() + size_t{}),
+                         decltype(std::declval<Ty_&>().insert(std::declval<Ty_&>().begin(), std::declval<typename Ty_::value_type>())),
+                         decltype(std::declval<Ty_&>().erase(std::declval<Ty_&>().begin(), std::declval<Ty_&>().end()))>>
+        = not std::is_same_v<Ty_, std::string>;
+
+template <typename Ty_, typename = void>
+constexpr bool is_patchable_map_v = false;
+
+template <typename Ty_>
+constexpr bool is_patchable_map_v<
+        Ty_, std::void_t<typename Ty_::key_type,
+                         typename Ty_::mapped_type,
+                         decltype(std::declval<Ty_&>().erase(std::declval<typename Ty_::key_type>()))>>
+        = std::is_same_v<typename Ty_::key_type, std::string>;
+
+template <typename Ty_>
+constexpr bool is_patchable_v = is_patchable_sequence_v<Ty_> || is_patchable_map_v<Ty_>;
+
+/**
+ * Applies shallow patch on container in place. Every operation is validated before target
+ * is modified, thus target is left untouched on failure.
+ */
+template <typename Ty_>
+bool apply_patch(std::vector<patch_op> const& ops, Ty_* target)
+{
+    static_assert(is_patchable_v<Ty_>);
+
+    try
+    {
+        if constexpr (is_patchable_sequence_v<Ty_>)
+        {
+            using value_type = typename Ty_::value_type;
+
+            // validate indices by simulating size changes, and parse all values first.
+            std::vector<std::pair<size_t, std::vector<value_type>>> parsed;
+            parsed.reserve(ops.size());
+
+            size_t size = target->size();
+            for (auto& op : ops)
+            {
+                auto& [index, values] = parsed.emplace_back();
+                if (not parse_index(op.token, size, &index)) { return false; }
+
+                switch (op.kind)
+                {
+                    case patch_op::replace:
+                        if (index >= size) { return false; }
+                        values.push_back(op.value->template get<value_type>());
+                        break;
+
+                    case patch_op::add:
+                        if (index > size) { return false; }
+                        values.push_back(op.value->template get<value_type>());
+                        ++size;
+                        break;
+
+                    case patch_op::remove:
+                        if (index >= size) { return false; }
+                        --size;
+                        break;
+
+                    case patch_op::replace_range:
+                        if (not op.value->is_array()) { return false; }
+                        if (index > size || op.value->size() > size - index) { return false; }
+                        for (auto& elem : *op.value) { values.push_back(elem.template get<value_type>()); }
+                        break;
+
+                    case patch_op::remove_range:
+                        if (index > size || op.count > size - index) { return false; }
+                        size -= op.count;
+                        break;
+                }
+            }
+
+            for (size_t i = 0; i < ops.size(); ++i)
+            {
+                auto& [index, values] = parsed[i];
+                auto at               = target->begin() + index;
+
+                switch (ops[i].kind)
+                {
+                    case patch_op::replace: (*target)[index] = std::move(values[0]); break;
+                    case patch_op::add: target->insert(at, std::move(values[0])); break;
+                    case patch_op::remove: target->erase(at, at + 1); break;
+                    case patch_op::remove_range: target->erase(at, at + ops[i].count); break;
+
+                    case patch_op::replace_range:
+                        for (size_t k = 0; k < values.size(); ++k) { (*target)[index + k] = std::move(values[k]); }
+                        break;
+                }
+            }
+        }
+        else
+        {
+            using mapped_type = typename Ty_::mapped_type;
+            std::vector<mapped_type> parsed;
+            parsed.reserve(ops.size());
+
+            for (auto& op : ops)
+            {
+                switch (op.kind)
+                {
+                    case patch_op::replace:
+                    case patch_op::add:
+                        parsed.push_back(op.value->template get<mapped_type>());
+                        break;
+
+                    case patch_op::remove:
+                        parsed.emplace_back();
+                        break;
+
+                    default:
+                        return false;  // ranges are not applicable for maps
+                }
+            }
+
+            for (size_t i = 0; i < ops.size(); ++i)
+            {
+                if (ops[i].kind == patch_op::remove)
+                    target->erase(ops[i].token);
+                else
+                    (*target)[ops[i].token] = std::move(parsed[i]);
+            }
+        }
+    }
+    catch (nlohmann::json::exception&)
+    {
+        return false;
+    }
+
+    return true;
+}
+}  // namespace perfkit::_configs
@@ -0,0 +1,139 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "perfkit/common/array_view.hxx"
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit::configs {
+struct shared_table_options
+{
+    // bytes reserved for value of each entry. longer strings are not shared.
+    size_t value_capacity = 256;
+
+    // how long a process waits for another one, which created the segment, to initialize it.
+    std::chrono::milliseconds open_timeout{1000};
+
+    // permission bits of created segment, which is masked by umask. anyone who can write to
+    //  the segment can inject config values, thus widen this only for trusted users.
+    uint32_t mode = 0600;
+};
+
+/**
+ * Registry values placed in named POSIX shared-memory segment, which is shared by every
+ * process of the same binary, e.g. workers forked from a single service.
+ *
+ * Segment has fixed layout derived from registry schema: a header which carries schema hash
+ * of the registry, then one entry per config in dense index order. Only configs which
+ * support typed updates, i.e. booleans, numbers and strings, are shared. Each entry is
+ * protected by its own sequence lock, thus readers never block writers, and writers of
+ * different entries never contend.
+ *
+ *   header  : magic, layout version, schema hash, entry count and size, generation
+ *   entry[] : seq, type, full key offset, value size, value bytes
+ *
+ * Values applied by registry update() are written to the segment, unless they came from
+ * the segment itself, and every process applies values written by others on its next
+ * update() as typed updates. Thus neither IPC round trip nor json parsing is involved.
+ * Processes which don't own the registry, e.g. a command line tool, can open the segment
+ * by name and store values directly.
+ *
+ * The first process which opens the segment creates it with its current values. Others
+ * adopt values of the segment on their next update(). Segment outlives processes, until
+ * remove() is called.
+ */
+class shared_table
+{
+   public:
+    using options     = shared_table_options;
+    using typed_value = detail::config_base::typed_value;
+
+   public:
+    /**
+     * Creates or opens segment of given name, then binds registry to it.
+     *
+     * Registry must be updated once before, as its layout is fixed by the first update. A
+     * segment left by different build of the binary mismatches, which must be remove()d.
+     *
+     * @param name name of segment, e.g. "/my-service.configs"
+     * @return nullptr if segment couldn't be mapped, or its layout doesn't match registry.
+     */
+    static auto open(std::shared_ptr<config_registry> rg, std::string name, options opts = {})
+            -> std::shared_ptr<shared_table>;
+
+    /**
+     * Opens existing segment without registry, for writers in other binaries.
+     */
+    static auto open(std::string name, options opts = {}) -> std::shared_ptr<shared_table>;
+
+    /** Removes segment. Processes which have already mapped it keep using it. */
+    static bool remove(std::string_view name);
+
+   public:
+    ~shared_table() noexcept;
+
+    shared_table(shared_table const&) = delete;
+    shared_table& operator=(shared_table const&) = delete;
+
+   public:
+    /**
+     * Stores value of config of given full key. Type of value must match the entry's.
+     * @return false if key is not shared, type mismatches or string is too long.
+     */
+    bool store(std::string_view full_key, typed_value const& value);
+
+    /** Reads value of config of given full key. */
+    std::optional<typed_value> load(std::string_view full_key) const;
+
+    /** Full keys of shared entries. */
+    std::vector<std::string_view> keys() const;
+
+    auto& name() const noexcept { return _name; }
+    uint64_t schema_hash() const noexcept;
+
+   public:
+    // called from registry update() before its update lock, to queue values written by others.
+    static void _bk_pull(config_registry* rg);
+
+    // called from registry update() under its update lock, with successfully applied configs.
+    static void _bk_push(config_registry const* rg, array_view<detail::config_base* const> changed);
+
+   private:
+    struct _header;
+    struct _entry;
+
+    shared_table(std::string name, options opts);
+
+    // creates segment with given layout, or maps existing one if layout is null.
+    bool _map(bool create, std::vector<detail::config_base*> const* layout, uint64_t schema_hash = 0);
+
+    _header* _header_ptr() const noexcept;
+    _entry* _entry_at(size_t index) const noexcept;
+    _entry* _find(std::string_view full_key) const noexcept;
+    std::string_view _key_of(_entry const* entry) const noexcept;
+
+    bool _write(_entry* entry, typed_value const& value, uint32_t* out_seq);
+    bool _read(_entry const* entry, typed_value* out, uint32_t* out_seq) const;
+
+   private:
+    std::string const _name;
+    options const _opts;
+    config_registry* _registry = nullptr;
+    std::vector<detail::config_base*> _bound;  // configs of registry, in dense index order
+
+    void* _base  = nullptr;
+    size_t _size = 0;
+
+    // sequence of each entry which this process has seen, thus applied or written itself.
+    std::mutex _mtx;
+    std::vector<uint32_t> _seen;
+    uint64_t _generation = 0;
+};
+
+using shared_table_ptr = std::shared_ptr<shared_table>;
+}  // namespace perfkit::configs
@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "perfkit/detail/config_storage.hpp"
+
+namespace perfkit {
+template <typename Ty_>
+class config;
+class config_registry;
+
+namespace configs {
+/**
+ * Immutable view of a registry's configuration values, which are all from same update epoch.
+ *
+ * Values are stored in fixed size chunks indexed by dense index of each config. Every update
+ * replaces only chunks which contain changed configs, and rest are shared with previous
+ * epoch, thus publishing new snapshot costs proportional to number of changes.
+ */
+class snapshot
+{
+   public:
+    enum
+    {
+        chunk_size = 64
+    };
+
+    using value_ptr = std::shared_ptr<void const>;
+    using chunk     = std::array<value_ptr, chunk_size>;
+
+   public:
+    uint64_t epoch() const noexcept { return _epoch; }
+    size_t size() const noexcept { return _size; }
+    auto owner() const noexcept { return _owner; }
+
+    /**
+     * @throw std::invalid_argument if config is not from this snapshot's registry.
+     * @throw std::out_of_range if config is not covered, or doesn't support snapshot.
+     */
+    template <typename Ty_>
+    Ty_ const& get(config<Ty_> const& conf) const
+    {
+        if (conf.base().owner() != _owner)
+            throw std::invalid_argument("snapshot: config is not from this snapshot's registry");
+
+        auto& value = at(conf.base().dense_index());
+        if (not value)
+            throw std::out_of_range("snapshot: config is not covered by this snapshot");
+
+        return *static_cast<Ty_ const*>(value.get());
+    }
+
+    template <typename Ty_>
+    Ty_ const& operator[](config<Ty_> const& conf) const
+    {
+        return get(conf);
+    }
+
+    /** @return nullptr if config of given index is not covered, or doesn't support snapshot. */
+    value_ptr const& at(size_t dense_index) const noexcept
+    {
+        static const value_ptr none;
+        if (dense_index >= _size) { return none; }
+
+        return (*_chunks[dense_index / chunk_size])[dense_index % chunk_size];
+    }
+
+   private:
+    friend class perfkit::config_registry;
+
+    config_registry const* _owner = nullptr;
+    uint64_t _epoch               = 0;
+    size_t _size                  = 0;
+
+    // chunks never change once snapshot is published.
+    std::vector<std::shared_ptr<chunk>> _chunks;
+};
+
+using snapshot_ptr = std::shared_ptr<snapshot const>;
+
+/**
+ * Declared subset of a registry's configs. Group's snapshot is republished only when any of
+ * its members changes, thus workers can tell whether they need to reload by its epoch.
+ */
+class group
+{
+   public:
+    static auto create(std::shared_ptr<config_registry> rg,
+                       std::vector<uint32_t> dense_indices) -> std::shared_ptr<group>;
+
+    /** @throw std::invalid_argument if configs are from different registries. */
+    template <typename... Ty_>
+    static auto create(config<Ty_> const&... confs)
+    {
+        static_assert(sizeof...(Ty_) > 0);
+
+        auto rg = (confs.base().owner(), ...);
+        if (((confs.base().owner() != rg) || ...))
+            throw std::invalid_argument("group: configs must be from same registry");
+
+        return create(rg->shared_from_this(), {confs.base().dense_index()...});
+    }
+
+   public:
+    /** Never blocks, never takes lock. */
+    snapshot_ptr snapshot() const { return _cell.snapshot(); }
+
+    auto const& members() const noexcept { return _members; }
+
+   public:
+    explicit group(std::vector<uint32_t> members, snapshot_ptr init);
+
+    bool _contains(uint32_t dense_index) const noexcept;
+    void _publish(snapshot_ptr const& next) { _cell.store(next); }
+
+   private:
+    std::vector<uint32_t> _members;  // sorted
+    _configs::rcu_cell<configs::snapshot> _cell;
+};
+
+using group_ptr = std::shared_ptr<group>;
+}  // namespace configs
+}  // namespace perfkit
@@ -0,0 +1,223 @@
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace perfkit::_configs {
+/**
+ * Seqlock cell for trivially copyable values.
+ *
+ * Single writer (registry's update(), which is serialized by registry update lock), any
+ * number of readers. Readers never block writer, and never write shared cache line.
+ * Payload is stored as array of relaxed atomic words, thus torn read is detected by
+ * sequence number without any data race.
+ */
+template <typename Ty_>
+class seqlock_cell
+{
+    static_assert(std::is_trivially_copyable_v<Ty_>);
+
+    enum
+    {
+        num_words = (sizeof(Ty_) + sizeof(uint64_t) - 1) / sizeof(uint64_t)
+    };
+
+   public:
+    explicit seqlock_cell(Ty_ const& init) noexcept { _store(init); }
+
+    void store(Ty_ const& value) noexcept
+    {
+        auto seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        _store(value);
+
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    Ty_ load() const noexcept
+    {
+        uint64_t buf[num_words];
+
+        for (;;)
+        {
+            auto seq_begin = _seq.load(std::memory_order_acquire);
+            if (seq_begin & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < num_words; ++i)
+                buf[i] = _words[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == seq_begin)
+                break;
+        }
+
+        Ty_ out;
+        memcpy(&out, buf, sizeof(Ty_));
+        return out;
+    }
+
+   private:
+    void _store(Ty_ const& value) noexcept
+    {
+        uint64_t buf[num_words] = {};
+        memcpy(buf, &value, sizeof(Ty_));
+
+        for (size_t i = 0; i < num_words; ++i)
+            _words[i].store(buf[i], std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint64_t> _words[num_words];
+};
+
+/**
+ * Read-copy-update cell for non-trivial values, e.g. strings or containers.
+ *
+ * Holds two immutable snapshots. Readers pin the active slot with per-slot reader count,
+ * and writer replaces the inactive slot only after its readers drain, then flips active
+ * index. Reader counts are kept inline until readers of different threads first collide,
+ * then striped over cache lines by thread, thus uncontended cells stay small while readers
+ * of contended ones rarely touch same cache line.
+ */
+template <typename Ty_>
+class rcu_cell
+{
+    enum
+    {
+        num_stripes = 16
+    };
+
+   public:
+    using snapshot_type = std::shared_ptr<Ty_ const>;
+
+   public:
+    explicit rcu_cell(Ty_ const& init) { _slots[0].value = std::make_shared<Ty_ const>(init); }
+    explicit rcu_cell(snapshot_type init) { _slots[0].value = std::move(init); }
+
+    ~rcu_cell() { delete _stripes.load(); }
+
+    void store(Ty_ const& value) { store(std::make_shared<Ty_ const>(value)); }
+
+    void store(snapshot_type value)
+    {
+        auto next = 1 - _active.load(std::memory_order_relaxed);
+        auto slot = &_slots[next];
+
+        while (_num_readers(next) != 0)
+            std::this_thread::yield();
+
+        slot->value = std::move(value);
+        _active.store(next);
+    }
+
+    template <typename Fn_>
+    decltype(auto) visit(Fn_&& fn) const
+    {
+        auto readers = _pin();
+
+        struct _release_t
+        {
+            std::atomic<uint32_t>* r;
+            ~_release_t() { r->fetch_sub(1, std::memory_order_release); }
+        } _release{readers.second};
+
+        return fn(*readers.first->value);
+    }
+
+    Ty_ load() const
+    {
+        return visit([](Ty_ const& v) { return Ty_{v}; });
+    }
+
+    snapshot_type snapshot() const
+    {
+        auto [slot, readers] = _pin();
+        auto out             = slot->value;
+        readers->fetch_sub(1, std::memory_order_release);
+        return out;
+    }
+
+   private:
+    struct alignas(64) _stripe
+    {
+        mutable std::atomic<uint32_t> readers{0};
+    };
+
+    struct _stripe_block
+    {
+        _stripe slots[2][num_stripes];
+    };
+
+    struct _slot
+    {
+        snapshot_type value;
+        mutable std::atomic<uint32_t> readers{0};  // used until stripes are allocated
+    };
+
+    static size_t _stripe_index() noexcept
+    {
+        static std::atomic_size_t counter = 0;
+        static thread_local size_t index  = counter++ % num_stripes;
+        return index;
+    }
+
+    uint32_t _num_readers(size_t index) const noexcept
+    {
+        // readers which pinned before stripes were allocated still hold inline count.
+        uint32_t sum = _slots[index].readers.load();
+        if (auto stripes = _stripes.load())
+            for (auto& stripe : stripes->slots[index]) { sum += stripe.readers.load(); }
+
+        return sum;
+    }
+
+    auto _pin() const -> std::pair<_slot const*, std::atomic<uint32_t>*>
+    {
+        auto stripes = _stripes.load();
+
+        for (;;)
+        {
+            auto index   = _active.load();
+            auto slot    = &_slots[index];
+            auto readers = stripes ? &stripes->slots[index][_stripe_index()].readers : &slot->readers;
+
+            auto prev = readers->fetch_add(1);
+            if (_active.load() == index)
+            {
+                // other reader holds inline count, thus readers are contended from now on.
+                if (prev != 0 && stripes == nullptr) { _allocate_stripes(); }
+                return {slot, readers};
+            }
+
+            readers->fetch_sub(1);
+        }
+    }
+
+    void _allocate_stripes() const
+    {
+        _stripe_block* expected = nullptr;
+        auto block              = new _stripe_block{};
+        if (not _stripes.compare_exchange_strong(expected, block)) { delete block; }
+    }
+
+   private:
+    _slot _slots[2];
+    std::atomic<uint32_t> _active{0};
+    mutable std::atomic<_stripe_block*> _stripes{nullptr};
+};
+
+template <typename Ty_>
+using config_cell = std::conditional_t<std::is_trivially_copyable_v<Ty_>,
+                                       seqlock_cell<Ty_>,
+                                       rcu_cell<Ty_>>;
+}  // namespace perfkit::_configs
@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "perfkit/common/array_view.hxx"
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit::configs {
+/**
+ * Receives exactly the configs which were changed by registry update(), filtered by
+ * key, registry or display key prefix.
+ *
+ * Readiness is exposed as pollable file descriptor on linux (eventfd), which becomes
+ * readable whenever any change is queued, and is reset by consume(). Once closed, it stays
+ * readable. On other platforms, use wait().
+ */
+class subscription : public std::enable_shared_from_this<subscription>
+{
+   private:
+    subscription();
+
+   public:
+    ~subscription() noexcept;
+    static auto create() -> std::shared_ptr<subscription>;
+
+   public:
+    void watch(detail::config_base const* conf);
+    void watch(config_registry const* rg);
+
+    /** Empty prefix watches every config. If rg is specified, only configs of it are matched. */
+    void watch_prefix(std::string_view display_key_prefix, config_registry const* rg = nullptr);
+
+    /**
+     * Moves every queued change into out, in order of update. Each config appears at most
+     * once, even if it was updated multiple times since last consume.
+     *
+     * @return number of consumed changes.
+     */
+    size_t consume(std::vector<config_shared_ptr>* out);
+
+    /** Block until any change is queued, or subscription is closed. */
+    bool wait();
+    bool wait_for(std::chrono::milliseconds timeout);
+
+    /**
+     * Wakes up every waiter, including ones polling native_handle(). Any wait() after
+     * close returns false immediately.
+     */
+    void close();
+
+    /** eventfd on linux, -1 on other platforms. */
+    int native_handle() const noexcept { return _fd; }
+
+   public:
+    // called from registry update(), with list of successfully applied configs.
+    static void _bk_dispatch(config_registry const* rg, array_view<detail::config_base* const> changed);
+
+   private:
+    bool _matches(config_registry const* rg, detail::config_base const* conf) const;
+    void _push(config_shared_ptr const& conf);
+    void _reset_fd() noexcept;
+
+   private:
+    struct _prefix
+    {
+        std::string value;
+        config_registry const* rg;
+    };
+
+    mutable std::mutex _mtx;
+    std::condition_variable _cvar;
+
+    std::unordered_set<void const*> _keys;
+    std::unordered_set<void const*> _registries;
+    std::vector<_prefix> _prefixes;
+
+    std::vector<config_shared_ptr> _pending;
+    std::unordered_set<void const*> _pending_set;
+    bool _signaled = false;
+    bool _closed   = false;
+
+    int _fd = -1;
+};
+
+using subscription_ptr = std::shared_ptr<subscription>;
+}  // namespace perfkit::configs
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <nlohmann/json.hpp>
+
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit::_configs {
+/**
+ * Tracks whether value queued by an automated controller is applied by registry update(),
+ * and whether the config is modified by others meanwhile.
+ *
+ * Tracker is shared with observer of the config, thus controller itself is never owned by
+ * the observer: controllers restore configs on destruction, which can't be done under
+ * registry update lock.
+ */
+class apply_tracker
+{
+   public:
+    static auto attach(config_shared_ptr const& conf) -> std::shared_ptr<apply_tracker>
+    {
+        auto tracker   = std::make_shared<apply_tracker>();
+        tracker->_conf = conf;
+        conf->_bk_add_observer(
+                [tracker, wconf = config_wptr{conf}](void const* value) {
+                    auto conf = wconf.lock();
+                    return conf && tracker->_on_applied(*conf, value);
+                });
+
+        return tracker;
+    }
+
+   public:
+    /**
+     * Expects given value to be applied next. Call before queueing it. Value is compared in
+     * the form it takes once applied, thus e.g. doubles which lose precision in float config
+     * are still recognized.
+     */
+    void expect(nlohmann::json value)
+    {
+        if (auto conf = _conf.lock()) { conf->normalize(value); }
+
+        std::lock_guard _{_mtx};
+        _expected = std::move(value);
+        _armed    = true;
+    }
+
+    /** Number of times expected values were applied. */
+    size_t num_applied() const noexcept { return _num_applied.load(); }
+
+    bool modified() const noexcept { return _modified.load(); }
+
+    /** Stops tracking. Values applied afterwards are never reported as modification. */
+    void detach() noexcept { _detached.store(true); }
+
+   private:
+    bool _on_applied(detail::config_base const& conf, void const* value)
+    {
+        if (_detached.load()) { return false; }
+
+        nlohmann::json js;
+        conf.serialize(value, js);
+
+        std::lock_guard _{_mtx};
+        if (not _armed) { return true; }  // initial invocation with current value
+
+        if (js == _expected)
+            return _num_applied.fetch_add(1), true;
+
+        _modified.store(true);
+        return false;
+    }
+
+   private:
+    config_wptr _conf;
+
+    std::mutex _mtx;
+    nlohmann::json _expected;
+    bool _armed = false;
+
+    std::atomic_size_t _num_applied{0};
+    std::atomic_bool _modified{false};
+    std::atomic_bool _detached{false};
+};
+}  // namespace perfkit::_configs
@@ -4,7 +4,10 @@
 #pragma once
 #include <any>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <mutex>
 #include <optional>
 #include <set>
@@ -12,6 +15,7 @@
 #include <string_view>
 #include <type_traits>
 #include <utility>
+#include <variant>
 
 #include <nlohmann/json.hpp>
 
@@ -20,6 +24,11 @@
 #include "perfkit/common/macros.hxx"
 #include "perfkit/common/spinlock.hxx"
 #include "perfkit/common/template_utils.hxx"
+#include "perfkit/detail/config_dirty.hpp"
+#include "perfkit/detail/config_index.hpp"
+#include "perfkit/detail/config_patch.hpp"
+#include "perfkit/detail/config_snapshot.hpp"
+#include "perfkit/detail/config_storage.hpp"
 
 namespace perfkit {
 using json = nlohmann::json;
@@ -28,6 +37,30 @@ namespace detail {
 class config_base;
 }
 
+namespace configs {
+class journal;
+class shared_table;
+
+/** Origin of config change, which is recorded along with the change by journal. */
+enum class change_source : uint8_t
+{
+    api,
+    file,
+    flag,
+    env,
+    net,
+    terminal,
+    replay,
+    experiment,
+    tuner,
+    controller,
+    shared,
+};
+
+char const* source_name(change_source source) noexcept;
+bool parse_source_name(std::string_view name, change_source* out) noexcept;
+}  // namespace configs
+
 class config_registry;
 using config_shared_ptr = std::shared_ptr<detail::config_base>;
 using config_wptr       = std::weak_ptr<detail::config_base>;
@@ -35,6 +68,33 @@ using std::shared_ptr;
 using std::weak_ptr;
 
 namespace detail {
+/**
+ * Compact form of config attributes, which are referred frequently during registration
+ * and io. Full json representation is generated lazily on first attribute() call.
+ */
+struct config_attribute
+{
+    enum flag_t : uint8_t
+    {
+        transient            = 1 << 0,
+        block_read           = 1 << 1,
+        hidden               = 1 << 2,
+        is_flag              = 1 << 3,
+        has_custom_validator = 1 << 4,
+    };
+
+    std::string description;
+    std::vector<std::string> flag_binding;
+    uint8_t flags = 0;
+
+    // number of previous values kept for rollback, besides current one. history is opt-in, as
+    //  every kept version is a full copy of value.
+    uint16_t max_history = 0;
+
+    // dumps type dependent attributes: default, min, max, one_of
+    std::function<void(nlohmann::json&)> fn_dump_typed;
+};
+
 /**
  * basic config class
  *
@@ -45,6 +105,31 @@ class config_base
    public:
     using deserializer = std::function<bool(nlohmann::json const&, void*)>;
     using serializer   = std::function<void(nlohmann::json&, void const*)>;
+    using version_ptr  = std::shared_ptr<void const>;
+    using publisher    = std::function<void(void const*, version_ptr const&)>;
+    using snapshotter  = version_ptr (*)(void const*);
+    using patcher      = bool (*)(std::vector<_configs::patch_op> const&, void*);
+    using restorer     = void (*)(void const*, void*);
+    using normalizer   = bool (*)(deserializer const&, serializer const&, nlohmann::json&);
+    using observer     = std::function<bool(void const*)>;
+
+    // small tagged union for json-free updates of arithmetic, boolean and string configs.
+    //  unsigned integers are carried as uint64_t, as int64_t can't represent upper half.
+    using typed_value        = std::variant<std::monostate, bool, int64_t, double, std::string, uint64_t>;
+    using typed_deserializer = std::function<bool(typed_value const&, void*)>;
+
+    using clock = std::chrono::system_clock;
+
+    /**
+     * Applied value of config. Values are immutable and shared between read cell, registry
+     * snapshots and history, thus keeping history never copies them again.
+     */
+    struct version
+    {
+        clock::time_point timestamp;
+        configs::change_source source;
+        version_ptr value;
+    };
 
    public:
     config_base(class config_registry* owner,
@@ -52,7 +137,13 @@ class config_base
                 std::string full_key,
                 deserializer fn_deserial,
                 serializer fn_serial,
-                nlohmann::json&& attribute);
+                config_attribute&& attribute,
+                publisher fn_publish        = {},
+                typed_deserializer fn_typed = {},
+                snapshotter fn_snapshot     = nullptr,
+                patcher fn_patch            = nullptr,
+                restorer fn_restore         = nullptr,
+                normalizer fn_normalize     = nullptr);
 
     /**
      * @warning this function is not re-entrant!
@@ -62,23 +153,65 @@ class config_base
     void serialize(nlohmann::json&);
     void serialize(std::function<void(nlohmann::json const&)> const&);
 
-    nlohmann::json const& attribute() const noexcept { return _attribute; }
-    nlohmann::json const& default_value() const { return _attribute["default"]; }
+    /**
+     * Json representation of attributes. Built once on first call, thus prefer compact
+     * accessors below on hot paths.
+     */
+    nlohmann::json const& attribute() const;
+    nlohmann::json const& default_value() const { return attribute()["default"]; }
 
     bool consume_dirty() { return _dirty.exchange(false); }
 
+    auto owner() const noexcept { return _owner; }
     auto const& full_key() const { return _full_key; }
     auto const& display_key() const { return _display_key; }
-    auto const& description() const { return _attribute["description"].get_ref<std::string const&>(); }
+    auto const& description() const noexcept { return _attr.description; }
     auto tokenized_display_key() const { return make_view(_categories); }
-    void request_modify(nlohmann::json js);
+
+    /**
+     * Converts value into the form it takes once applied, by round trip through type of this
+     * config, e.g. precision of floating point or clamping by rules.
+     * @return false if value can't be applied.
+     */
+    bool normalize(nlohmann::json& value) const
+    {
+        return _normalize ? _normalize(_deserialize, _serialize, value) : true;
+    }
+
+    /** index of this config in registry's snapshot, assigned in registration order. */
+    uint32_t dense_index() const noexcept { return _dense_index; }
+    void request_modify(nlohmann::json js, configs::change_source source = configs::change_source::api);
+
+    /**
+     * Queue element or range level modification. See _configs::patch_op for its format.
+     * Rule-free containers apply top-level patches in place, without re-deserialization.
+     */
+    bool request_patch(nlohmann::json ops, configs::change_source source = configs::change_source::api);
+
+    /** Restores value which was applied at given time. See config_registry::bk_queue_rollback */
+    bool request_rollback(clock::time_point at, configs::change_source source = configs::change_source::api);
+
+    /** Applied values, from the oldest to the current. */
+    std::vector<version> history() const;
+
+    /** Serializes value of a version of this config. */
+    void serialize(version const& ver, nlohmann::json& out) const { _serialize(out, ver.value.get()); }
+
+    /** Serializes arbitrary value of this config's type, e.g. one passed to observers. */
+    void serialize(void const* value, nlohmann::json& out) const { _serialize(out, value); }
 
     size_t num_modified() const { return _fence_modified; };
     size_t num_serialized() const { return _fence_serialized; }
 
-    bool can_export() const noexcept { return not attribute().contains("transient"); }
-    bool can_import() const noexcept { return not attribute().contains("block_read"); }
-    bool is_hidden() const noexcept { return attribute().contains("hidden"); }
+    /** Number of changes applied by owner's update(), excluding queued ones. */
+    size_t num_applied() const noexcept { return _num_applied.load(std::memory_order_relaxed); }
+
+    bool can_export() const noexcept { return not _has(config_attribute::transient); }
+    bool can_import() const noexcept { return not _has(config_attribute::block_read); }
+    bool is_hidden() const noexcept { return _has(config_attribute::hidden); }
+    bool is_flag() const noexcept { return _has(config_attribute::is_flag); }
+    auto const& flag_bindings() const noexcept { return _attr.flag_binding; }
+    auto max_history() const noexcept { return _attr.max_history; }
 
     /**
      * Check if latest marshalling result was invalid
@@ -89,12 +222,40 @@ class config_base
         return _latest_marshal_failed.load(std::memory_order_relaxed);
     }
 
+    bool can_update_typed() const noexcept { return !!_deserialize_typed; }
+    bool can_snapshot() const noexcept { return _snapshot != nullptr; }
+    bool can_patch_in_place() const noexcept { return _patch != nullptr; }
+    bool can_rollback() const noexcept { return _restore != nullptr && _snapshot != nullptr; }
+
+    /**
+     * If every modification after given fence was patch, collects them into single patch.
+     * @param out_fence fence which collected patch brings client to.
+     */
+    bool _bk_patches_since(size_t fence, nlohmann::json* out_ops, size_t* out_fence);
+
+    /**
+     * Observer is invoked with current value immediately, then with every applied value by
+     * owner's update() under its update lock, thus it must be short and must not access the
+     * registry. Observer which returns false is removed.
+     */
+    void _bk_add_observer(observer fn);
+
    private:
     bool _try_deserialize(nlohmann::json const& value);
+    bool _try_deserialize(typed_value const& value);
+    bool _on_deserialized(bool succeeded, version_ptr applied = nullptr);
+    version_ptr _current_version() const;
+    version const* _version_at(clock::time_point at) const noexcept;
+    bool _try_patch();
+    void _reset_patch_log();
+    void _serialize_cache();
     static void _split_categories(std::string_view view, std::vector<std::string_view>& out);
+    bool _has(uint8_t flag) const noexcept { return _attr.flags & flag; }
 
    private:
     friend class perfkit::config_registry;
+    friend class perfkit::configs::journal;
+    friend class perfkit::configs::shared_table;
     perfkit::config_registry* _owner;
 
     std::string _full_key;
@@ -105,14 +266,65 @@ class config_base
 
     std::atomic_size_t _fence_modified   = 0;
     std::atomic_size_t _fence_serialized = ~size_t{};
+    std::atomic_size_t _num_applied      = 0;
     nlohmann::json _cached_serialized;
-    nlohmann::json _attribute;
+
+    config_attribute _attr;
+    mutable std::once_flag _attribute_built;
+    mutable nlohmann::json _attribute;
+
+    // pending value queued via typed channel. serialized to json only on demand.
+    typed_value _pending_typed;
+
+    // whether this config is in owner's pending update list. guarded by owner's update lock.
+    bool _pending = false;
+
+    // origin of the latest queued change. guarded by owner's update lock.
+    configs::change_source _pending_source = configs::change_source::api;
+
+    uint32_t _dense_index = 0;
+
+    // allocated on first patch request. guarded by owner's update lock.
+    struct _patch_state
+    {
+        std::vector<nlohmann::json> pending;
+
+        // recently applied patches, for propagating them instead of whole value.
+        size_t log_base = 0;
+        std::vector<std::pair<size_t, nlohmann::json>> log;
+    };
+
+    std::unique_ptr<_patch_state> _patches;
+
+    // value queued by rollback, which is assigned as-is. guarded by owner's update lock.
+    version_ptr _pending_restore;
+
+    // sequence of the latest applied change, which is recorded by journals. guarded by
+    // owner's update lock.
+    uint64_t _journal_seq = 0;
+
+    // applied values, from oldest to current. empty if neither history nor snapshot of owner
+    //  is enabled, as applied values aren't copied then. guarded by owner's update lock.
+    std::vector<version> _history;
+
+    // guarded by owner's update lock.
+    std::vector<observer> _observers;
 
     std::vector<std::string_view> _categories;
 
     deserializer _deserialize;
     serializer _serialize;
+    publisher _publish;
+    typed_deserializer _deserialize_typed;
+    snapshotter _snapshot;
+    patcher _patch;
+    restorer _restore;
+    normalizer _normalize;
 };
+
+// parsing of config keys, which are exposed only for tests.
+std::string _make_display_key(std::string_view full_key);
+bool _is_valid_flag_name(std::string_view name) noexcept;
 }  // namespace detail
 
 /**
@@ -132,13 +344,26 @@ struct schema_mismatch : parse_error { using parse_error::parse_error; };
 using flag_binding_table = std::map<std::string, config_shared_ptr, std::less<>>;
 flag_binding_table& _flags() noexcept;
 
+// guards flag binding table, as configs can be registered and arguments parsed from any thread.
+std::mutex& _flags_lock() noexcept;
+
 void parse_args(int* argc, char*** argv, bool consume, bool ignore_undefined = false);
 void parse_args(std::vector<std::string_view>* args, bool consume, bool ignore_undefined = false);
 
-bool import_from(json const& data);
+bool import_from(json const& data, change_source source = change_source::file);
 json export_all();
 
-bool import_file(std::string_view path);
+/**
+ * Stream-parse json, MessagePack or CBOR document, which is detected automatically.
+ *
+ * @param changes_only if set, only values which differ from previously loaded document are
+ *  queued, thus unchanged configs won't be marked dirty.
+ */
+bool import_from_memory(void const* data, size_t size, bool changes_only = false);
+
+bool import_file(std::string_view path, bool changes_only = false);
+
+/** Exports as MessagePack if extension is .msgpack or .mpk, CBOR if .cbor, json otherwise. */
 bool export_to(std::string_view path);
 
 /** wait until any configuration update is applied. */
@@ -170,9 +395,70 @@ class config_registry : public std::enable_shared_from_this<config_registry>
     auto const& name() const { return _name; }
 
    public:
-    bool bk_queue_update_value(std::string_view full_key, json value);
+    using change_source = configs::change_source;
+
+    bool bk_queue_update_value(std::string_view full_key, json value,
+                               change_source source = change_source::api);
+
+    /** Queue patch of container config. See _configs::patch_op */
+    bool bk_queue_patch(std::string_view full_key, json ops,
+                        change_source source = change_source::api);
+
+    /** Queue update without json round-trip. Target config must support typed channel. */
+    bool bk_queue_update_typed(std::string_view full_key, detail::config_base::typed_value value,
+                               change_source source = change_source::api);
+
+    using clock = detail::config_base::clock;
+
+    /**
+     * Queue restoring the value which was applied at given time, without any conversion.
+     * @return false if history of config doesn't cover given time.
+     */
+    bool bk_queue_rollback(std::string_view full_key, clock::time_point at,
+                           change_source source = change_source::api);
+
+    /** Queue rollback of every config changed after given time. @return number of queued configs. */
+    size_t bk_queue_rollback_all(clock::time_point at, change_source source = change_source::api);
+
+    /**
+     * Configs whose values differ between two points of time, as {display_key: [from, to]}.
+     * Configs whose history doesn't cover both points are omitted.
+     */
+    json bk_diff(clock::time_point from, clock::time_point to);
+
+   public:
+    // shared between all registries of a batch. last registry which applies the batch
+    //  on its update() notifies waiters.
+    using batch_token = std::shared_ptr<std::atomic_size_t>;
+
+    struct batch_entry
+    {
+        detail::config_base* conf;
+        json value;
+    };
+
+    /**
+     * Queue all changes under single lock acquisition, thus they're applied together on the
+     * next update(). Entries are consumed.
+     */
+    void bk_queue_update_batch(std::vector<batch_entry>* changes, batch_token const& token,
+                               change_source source = change_source::api);
     std::string_view bk_find_key(std::string_view display_key);
+
+    /**
+     * Find config by full key, or display key. O(1) once registry is frozen by first update.
+     * @return empty pointer if not found.
+     */
+    config_shared_ptr const& bk_find(std::string_view full_key) const noexcept;
+    config_shared_ptr const& bk_find_disp(std::string_view display_key) const noexcept;
+
     auto const& bk_all() const noexcept { return _entities; }
+
+    /**
+     * Immutable view of all configs of this registry, whose values are all from the same
+     * update epoch. Never blocks once snapshots are enabled by the first call.
+     */
+    configs::snapshot_ptr snapshot();
     auto bk_schema_class() const noexcept { return _schema_class; }
     auto bk_schema_hash() const noexcept { return _schema_hash; }
 
@@ -182,6 +468,13 @@ class config_registry : public std::enable_shared_from_this<config_registry>
 
     static shared_ptr<config_registry> create(std::string name, std::type_info const* schema = nullptr);
 
+   private:
+    void _queue_pending(detail::config_base* conf);
+    bool _queue_restore(detail::config_base* conf, clock::time_point at, change_source source);
+    void _freeze();
+    void _build_snapshot();
+    void _publish_snapshot(std::vector<detail::config_base*> const& changes);
+
    private:
     // TODO: redesign this!
     static shared_ptr<config_registry> share(std::string_view name, std::type_info const* schema);
@@ -192,12 +485,32 @@ class config_registry : public std::enable_shared_from_this<config_registry>
    public:
     void _put(std::shared_ptr<detail::config_base> o);
     bool _initially_updated() const noexcept { return _initial_update_done.load(); }
+    bool _snapshot_active() const noexcept { return _snapshot_enabled.load(std::memory_order_relaxed); }
+    void _add_group(configs::group_ptr const& grp);
+
+    // guarded by update lock.
+    void _add_dirty_block(_configs::dirty_block* block) { _dirty_blocks.push_back(block); }
+    void _remove_dirty_block(_configs::dirty_block* block);
 
    private:
     std::string _name;
     config_table _entities;
     string_view_table _disp_keymap;
+
+    // flat lookup tables, built once on first update as layout never changes afterwards.
+    _configs::perfect_hash_index<config_shared_ptr> _frozen_entities;
+    _configs::perfect_hash_index<config_shared_ptr> _frozen_disp_keymap;
+    std::atomic_bool _frozen{false};
+
+    // epoch snapshots, which are maintained only after the first snapshot() call.
+    std::vector<detail::config_base*> _dense;
+    _configs::rcu_cell<configs::snapshot> _snapshot;
+    std::atomic_bool _snapshot_enabled{false};
+    std::vector<std::weak_ptr<configs::group>> _groups;
+    std::vector<_configs::dirty_block*> _dirty_blocks;  // of watchers
     std::vector<detail::config_base*> _pending_updates[2];
+    std::vector<batch_token> _pending_batches;
+    bool _pending_standalone = false;  // whether any change was queued outside of batch
     perfkit::spinlock _update_lock;
 
     // this value is used for identifying config registry's schema type, as config registry's
@@ -210,6 +523,51 @@ class config_registry : public std::enable_shared_from_this<config_registry>
     std::atomic_bool _initial_update_done{false};
 };
 
+namespace configs {
+/**
+ * Stages many changes across registries, then commits them at once.
+ *
+ * Changes of each registry are queued under single lock acquisition, thus every change of
+ * a registry is applied by the same update() call, and readers on update thread never
+ * observe half-applied batch. Waiters of wait_any_change() are woken up only once, when
+ * the last registry of the batch applies it.
+ */
+class batch
+{
+   public:
+    explicit batch(change_source source = change_source::api) noexcept : _source(source) {}
+
+   public:
+    /**
+     * @return false if registry does not have given display key. Keys which can't be
+     *  imported are silently skipped.
+     */
+    bool stage(shared_ptr<config_registry> const& rg, std::string_view display_key, json value);
+    void stage(detail::config_base* conf, json value);
+    void reserve(shared_ptr<config_registry> const& rg, size_t num_entries);
+
+    size_t size() const noexcept { return _num_staged; }
+    bool empty() const noexcept { return _num_staged == 0; }
+
+    void commit();
+
+   private:
+    struct _registry_changes
+    {
+        shared_ptr<config_registry> ref;
+        std::vector<config_registry::batch_entry> entries;
+    };
+
+    _registry_changes* _changes_of(config_registry* rg);
+
+   private:
+    std::map<config_registry*, _registry_changes> _staged;
+    _registry_changes* _latest = nullptr;
+    size_t _num_staged         = 0;
+    change_source _source;
+};
+}  // namespace configs
+
 namespace _attr_flag {
 enum ty : uint64_t
 {
@@ -218,6 +576,8 @@ enum ty : uint64_t
     has_validate = 0x01 << 2,
     has_one_of   = 0x01 << 3,
     has_verify   = 0x01 << 4,
+
+    has_rules = has_min | has_max | has_validate | has_one_of | has_verify,
 };
 }
 
@@ -245,6 +605,7 @@ struct _config_attrib_data
 
     std::optional<std::vector<std::string>> flag_binding;
     _config_io_type transient_type = _config_io_type::persistent;
+    uint16_t max_history           = 0;
 };
 
 template <typename Ty_, uint64_t Flags_ = 0>
@@ -346,6 +707,13 @@ class _config_factory
         return flags(std::forward<Str_>(args)...);
     }
 
+    /** number of previous values kept for rollback, which is 0 by default. consider small value for large containers. */
+    auto& history(uint16_t max_versions)
+    {
+        _data.max_history = max_versions;
+        return *this;
+    }
+
     /** transient marked configs won't be saved or loaded from config files. */
     auto& transient()
     {
@@ -406,7 +774,9 @@ class config
             std::string full_key,
             Ty_&& default_value,
             _config_attrib_data<Ty_> attribute) noexcept
-            : _owner(&repo), _value(std::forward<Ty_>(default_value))
+            : _owner(&repo),
+              _value(std::forward<Ty_>(default_value)),
+              _cell(std::make_shared<_configs::config_cell<Ty_>>(_value))
     {
         std::string env = std::move(attribute.env_name);
 
@@ -415,94 +785,89 @@ class config
             out = *(Ty_*)in;
         };
 
-        // set reference attribute
-        nlohmann::json js_attrib;
-        js_attrib["default"] = _value;
+        // set compact attribute. json representation is built lazily from typed attributes.
+        detail::config_attribute attr;
+        attr.description = std::move(attribute.description);
 
-        js_attrib["description"] = attribute.description;
-
-        if constexpr (Flags_ & _attr_flag::has_min)
-        {
-            js_attrib["min"] = *attribute.min;
-        }
-        if constexpr (Flags_ & _attr_flag::has_max)
-        {
-            js_attrib["max"] = *attribute.max;
-        }
-        if constexpr (Flags_ & _attr_flag::has_one_of)
-        {
-            js_attrib["one_of"] = *attribute.one_of;
-        }
         if constexpr (Flags_ & _attr_flag::has_validate)
-        {
-            js_attrib["has_custom_validator"] = true;
-        }
-        else
-        {
-            js_attrib["has_custom_validator"] = false;
-        }
+            attr.flags |= detail::config_attribute::has_custom_validator;
 
         if (attribute.hidden)
-        {
-            js_attrib["hidden"] = true;
-        }
+            attr.flags |= detail::config_attribute::hidden;
 
         if (attribute.flag_binding)
         {
-            std::vector<std::string>& binding = *attribute.flag_binding;
-            js_attrib["is_flag"]              = true;
-            if (not binding.empty())
-            {
-                js_attrib["flag_binding"] = std::move(binding);
-            }
+            attr.flags |= detail::config_attribute::is_flag;
+            attr.flag_binding = std::move(*attribute.flag_binding);
         }
 
         if (attribute.transient_type != _config_io_type::persistent)
         {
-            js_attrib["transient"] = true;
+            attr.flags |= detail::config_attribute::transient;
             if (attribute.transient_type == _config_io_type::transient)
-                js_attrib["block_read"] = true;
+                attr.flags |= detail::config_attribute::block_read;
         }
 
+        attr.max_history = attribute.max_history;
+
+        auto attrib = std::make_shared<_config_attrib_data<Ty_> const>(std::move(attribute));
+
+        attr.fn_dump_typed = [attrib, default_value = _value](nlohmann::json& out) {
+            out["default"] = default_value;
+
+            if constexpr (Flags_ & _attr_flag::has_min)
+                out["min"] = *attrib->min;
+            if constexpr (Flags_ & _attr_flag::has_max)
+                out["max"] = *attrib->max;
+            if constexpr (Flags_ & _attr_flag::has_one_of)
+                out["one_of"] = *attrib->one_of;
+        };
+
+        // apply rules of attribute to parsed value, then assign it to destination.
+        auto fn_apply = [attrib]  //
+                (Ty_& parsed, void* out) {
+                    bool okay = true;
+
+                    _config_attrib_data<Ty_> const& attr = *attrib;
+
+                    if constexpr (Flags_ & _attr_flag::has_min)
+                    {
+                        if constexpr (has_binary_op_v<std::less<>, Ty_>)
+                            parsed = std::max<Ty_>(*attr.min, parsed);
+                    }
+                    if constexpr (Flags_ & _attr_flag::has_max)
+                    {
+                        if constexpr (has_binary_op_v<std::less<>, Ty_>)
+                            parsed = std::min<Ty_>(*attr.max, parsed);
+                    }
+                    if constexpr (Flags_ & _attr_flag::has_one_of)
+                    {
+                        if (attr.one_of->find(parsed) == attr.one_of->end())
+                            return false;
+                    }
+                    if constexpr (Flags_ & _attr_flag::has_verify)
+                    {
+                        if (not attr.verify(parsed))
+                            return false;
+                    }
+                    if constexpr (Flags_ & _attr_flag::has_validate)
+                    {
+                        okay |= attr.validate(parsed);  // value should be validated
+                    }
+
+                    *(Ty_*)out = std::move(parsed);
+                    return okay;
+                };
+
         // setup marshaller / de-marshaller with given rule of attribute
-        detail::config_base::deserializer fn_m = [attrib = std::move(attribute)]  //
+        detail::config_base::deserializer fn_m = [fn_apply]  //
                 (nlohmann::json const& in, void* out) {
                     try
                     {
                         Ty_ parsed;
-
-                        bool okay = true;
-
-                        _config_attrib_data<Ty_> const& attr = attrib;
                         nlohmann::from_json(in, parsed);
 
-                        if constexpr (Flags_ & _attr_flag::has_min)
-                        {
-                            if constexpr (has_binary_op_v<std::less<>, Ty_>)
-                                parsed = std::max<Ty_>(*attr.min, parsed);
-                        }
-                        if constexpr (Flags_ & _attr_flag::has_max)
-                        {
-                            if constexpr (has_binary_op_v<std::less<>, Ty_>)
-                                parsed = std::min<Ty_>(*attr.max, parsed);
-                        }
-                        if constexpr (Flags_ & _attr_flag::has_one_of)
-                        {
-                            if (attr.one_of->find(parsed) == attr.one_of->end())
-                                return false;
-                        }
-                        if constexpr (Flags_ & _attr_flag::has_verify)
-                        {
-                            if (not attr.verify(parsed))
-                                return false;
-                        }
-                        if constexpr (Flags_ & _attr_flag::has_validate)
-                        {
-                            okay |= attr.validate(parsed);  // value should be validated
-                        }
-
-                        *(Ty_*)out = parsed;
-                        return okay;
+                        return fn_apply(parsed, out);
                     }
                     catch (std::exception&)
                     {
@@ -510,6 +875,54 @@ class config
                     }
                 };
 
+        // typed update channel, which bypasses json for arithmetic and string types.
+        detail::config_base::typed_deserializer fn_t;
+        if constexpr (_is_typed_channel_v)
+        {
+            fn_t = [fn_apply](detail::config_base::typed_value const& in, void* out) {
+                Ty_ parsed;
+                if (not _from_typed(in, &parsed)) { return false; }
+
+                return fn_apply(parsed, out);
+            };
+        }
+
+        // publish updated value to lock-free read cell. non-trivial values share applied
+        //  version instead of copying it again.
+        detail::config_base::publisher fn_p = [cell = _cell](void const* in, detail::config_base::version_ptr const& applied) {
+            if constexpr (std::is_trivially_copyable_v<Ty_>)
+                cell->store(*(Ty_ const*)in);
+            else if (applied)
+                cell->store(std::static_pointer_cast<Ty_ const>(applied));
+            else
+                cell->store(*(Ty_ const*)in);
+        };
+
+        // patches rule-free containers in place. others are patched through json.
+        detail::config_base::patcher fn_patch = nullptr;
+        if constexpr (_configs::is_patchable_v<Ty_> && (Flags_ & _attr_flag::has_rules) == 0)
+        {
+            fn_patch = [](std::vector<_configs::patch_op> const& ops, void* out) {
+                return _configs::apply_patch(ops, (Ty_*)out);
+            };
+        }
+
+        // copies applied value into immutable version, which is shared by snapshots and history
+        detail::config_base::snapshotter fn_s = [](void const* in) -> std::shared_ptr<void const> {
+            return std::make_shared<Ty_ const>(*(Ty_ const*)in);
+        };
+
+        // assigns previously applied version back on rollback
+        detail::config_base::restorer fn_r = [](void const* in, void* out) {
+            *(Ty_*)out = *(Ty_ const*)in;
+        };
+
+        // round trip of json value through Ty_, which applied values go through
+        detail::config_base::normalizer fn_n = [](auto const& deserialize, auto const& serialize, nlohmann::json& value) {
+            Ty_ parsed;
+            return deserialize(value, &parsed) && (serialize(value, &parsed), true);
+        };
+
         // instantiate config instance
         _opt = std::make_shared<detail::config_base>(
                 _owner,
@@ -517,7 +930,13 @@ class config
                 std::move(full_key),
                 std::move(fn_m),
                 std::move(fn_d),
-                std::move(js_attrib));
+                std::move(attr),
+                std::move(fn_p),
+                std::move(fn_t),
+                fn_s,
+                fn_patch,
+                fn_r,
+                fn_n);
 
         // put instance to global queue
         repo._put(_opt);
@@ -534,7 +953,7 @@ class config
                             env_value, env_value + strlen(env_value), nullptr, false);
 
                 if (not parsed_json.is_discarded())
-                    _opt->request_modify(std::move(parsed_json));
+                    _opt->request_modify(std::move(parsed_json), configs::change_source::env);
             }
     }
 
@@ -552,11 +971,24 @@ class config
     Ty_ const& ref() const noexcept { return _value; }
 
     /**
-     * Provides thread-safe access for configuration.
+     * Provides thread-safe access for configuration, without taking any shared lock.
+     *
+     * Trivially copyable types are read via seqlock, others are copied from RCU snapshot
+     * which is published on registry's update().
      *
      * @return
      */
-    Ty_ _copy() const noexcept { return _owner->_access_lock(), Ty_{_value}; }
+    Ty_ _copy() const noexcept { return _cell->load(); }
+
+    /**
+     * Thread-safe, immutable snapshot of non-trivially copyable configuration. Snapshot
+     * remains valid and unchanged even after subsequent updates.
+     */
+    template <typename T_ = Ty_, typename = std::enable_if_t<not std::is_trivially_copyable_v<T_>>>
+    auto snapshot() const noexcept
+    {
+        return _cell->snapshot();
+    }
 
     Ty_ const& operator*() const noexcept { return ref(); }
     Ty_ const* operator->() const noexcept { return &ref(); }
@@ -564,20 +996,109 @@ class config
 
     [[deprecated]] bool check_dirty_and_consume() const { return _opt->consume_dirty(); }
     bool check_update() const { return _opt->consume_dirty(); }
-    void async_modify(Ty_ v) { _owner->bk_queue_update_value(_opt->full_key(), std::move(v)); }
+    void async_modify(Ty_ v)
+    {
+        if constexpr (_is_typed_channel_v)
+            _owner->bk_queue_update_typed(_opt->full_key(), _to_typed(std::move(v)));
+        else
+            _owner->bk_queue_update_value(_opt->full_key(), std::move(v));
+    }
 
     auto& base() const { return *_opt; }
 
+   private:
+    static constexpr bool _is_typed_channel_v
+            = std::is_arithmetic_v<Ty_> || std::is_same_v<Ty_, std::string>;
+
+    static auto _to_typed(Ty_&& v) -> detail::config_base::typed_value
+    {
+        if constexpr (std::is_same_v<Ty_, bool>)
+            return v;
+        else if constexpr (std::is_integral_v<Ty_> && std::is_unsigned_v<Ty_>)
+            return uint64_t(v);
+        else if constexpr (std::is_integral_v<Ty_>)
+            return int64_t(v);
+        else if constexpr (std::is_floating_point_v<Ty_>)
+            return double(v);
+        else
+            return std::move(v);
+    }
+
+    static bool _from_typed(detail::config_base::typed_value const& v, Ty_* out)
+    {
+        if constexpr (std::is_same_v<Ty_, bool>)
+        {
+            if (auto p = std::get_if<bool>(&v)) { return *out = *p, true; }
+        }
+        else if constexpr (std::is_integral_v<Ty_>)
+        {
+            // values which don't fit are rejected, as converting them is either undefined
+            //  (from double) or silently wraps around (from int64).
+            using limits = std::numeric_limits<Ty_>;
+
+            if (auto p = std::get_if<int64_t>(&v))
+            {
+                bool fits = std::is_signed_v<Ty_>
+                                    ? *p >= int64_t(limits::min()) && *p <= int64_t(limits::max())
+                                    : *p >= 0 && uint64_t(*p) <= uint64_t(limits::max());
+
+                return fits && (*out = Ty_(*p), true);
+            }
+
+            if (auto p = std::get_if<uint64_t>(&v))
+            {
+                bool fits = *p <= uint64_t(limits::max());
+                return fits && (*out = Ty_(*p), true);
+            }
+
+            if (auto p = std::get_if<double>(&v))
+            {
+                // NaN fails both comparisons. upper bound 2^digits is exact in double.
+                auto value = std::trunc(*p);
+                bool fits  = value >= double(limits::min()) && value < std::ldexp(1., limits::digits);
+
+                return fits && (*out = Ty_(value), true);
+            }
+        }
+        else if constexpr (std::is_floating_point_v<Ty_>)
+        {
+            if (auto p = std::get_if<int64_t>(&v)) { return *out = Ty_(*p), true; }
+            if (auto p = std::get_if<uint64_t>(&v)) { return *out = Ty_(*p), true; }
+            if (auto p = std::get_if<double>(&v)) { return *out = Ty_(*p), true; }
+        }
+        else
+        {
+            if (auto p = std::get_if<std::string>(&v)) { return *out = *p, true; }
+        }
+
+        return false;
+    }
+
    private:
     config_shared_ptr _opt;
 
     config_registry* _owner;
     Ty_ _value;
+    std::shared_ptr<_configs::config_cell<Ty_>> _cell;
 };
 
 namespace configs {
+/**
+ * Tracks which configs were changed by registry update() since last check.
+ *
+ * Each watched config is assigned a dense slot on its first check, or by watch(), and
+ * registry update() sets dirty bits of applied configs. Thus checking a config costs
+ * a few array accesses and single bit test, and takes lock only on its first check.
+ */
 class watcher
 {
+   public:
+    watcher() noexcept = default;
+    ~watcher() noexcept;
+
+    watcher(watcher const&) = delete;
+    watcher& operator=(watcher const&) = delete;
+
    public:
     template <typename ConfTy_>
     bool check_dirty(ConfTy_ const& conf) const
@@ -585,19 +1106,41 @@ class watcher
         return _check_update_and_consume(&conf.base());
     }
 
+    /** Same as check_dirty(), which is now safe to be called from multiple threads. */
     template <typename ConfTy_>
     bool check_dirty_safe(ConfTy_ const& conf) const
     {
-        auto _{std::lock_guard{_lock}};
         return _check_update_and_consume(&conf.base());
     }
 
+    /**
+     * Assigns slot to config in advance. Config which has ever been modified is reported
+     * as dirty on its first check.
+     */
+    template <typename ConfTy_>
+    void watch(ConfTy_ const& conf) const
+    {
+        _find(&conf.base()).first || (_watch(&conf.base()), 0);
+    }
+
+    /**
+     * Collects every watched config changed since last check, and clears them.
+     * @return number of collected configs.
+     */
+    size_t consume(std::vector<detail::config_base*>* out) const;
+
    private:
+    using _slot = std::pair<_configs::dirty_block*, uint32_t>;
+
     bool _check_update_and_consume(detail::config_base* ptr) const;
+    _slot _find(detail::config_base* ptr) const noexcept;
+    _slot _watch(detail::config_base* ptr) const;
 
-   public:
-    mutable std::unordered_map<detail::config_base*, uint64_t> _table;
-    mutable perfkit::spinlock _lock;
+   private:
+    // one block per registry, which are never removed until destruction.
+    struct _node;
+    mutable std::atomic<_node*> _head{nullptr};
+    mutable perfkit::spinlock _lock;  // only for assigning slots
 };
 }  // namespace configs
 
@@ -0,0 +1,164 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "perfkit/detail/config_tracker.hpp"
+#include "perfkit/detail/configs.hpp"
+#include "perfkit/detail/metrics.hpp"
+#include "perfkit/detail/tracer.hpp"
+
+namespace perfkit {
+struct controller_options
+{
+    enum policy_t
+    {
+        pid,
+        aimd,
+    };
+
+    policy_t policy = pid;
+
+    // target of the metric, in unit of the node. timers are in nanoseconds.
+    double setpoint = 0;
+
+    // percentile of each window of samples, which is held under setpoint.
+    double percentile = 0.99;
+
+    // number of samples per control step. samples collected before the registry applies
+    // latest output, and warmup iterations after that, are discarded.
+    size_t window = 64;
+    size_t warmup = 1;
+
+    // whether increasing config decreases the metric, e.g. prefetch depth against latency.
+    bool inverse = false;
+
+    // gains of PID, on error normalized by setpoint. each step is relative to current output,
+    // or to 1% of the range near zero, thus gains don't depend on unit of config. e.g. ki of
+    // 0.3 moves output by 30% while metric is twice of setpoint.
+    double kp = 0.3;
+    double ki = 0.3;
+    double kd = 0;
+
+    // AIMD moves output by `additive` while metric is under setpoint, otherwise shrinks
+    // its distance from the safe bound of range by `multiplicative`.
+    double additive       = 1;
+    double multiplicative = 0.5;
+
+    // metric category where controller state is published.
+    std::string category = "controllers";
+};
+
+/**
+ * Closed-loop controller, which continuously adjusts a numeric config to hold a trace
+ * node at setpoint, e.g. keeps p99 of 'process' timer under 2 ms by batch size.
+ *
+ * Samples are collected on every fork() of the tracer, and each window of them is handed
+ * to background thread of controller, which computes the percentile and the next output
+ * by PID, in velocity form thus no integral windup occurs on clamping, or by AIMD. Output is
+ * clamped to min and max attributes of the config, which are required.
+ *
+ * If the config is modified by others, e.g. by operator, the controller adopts the value as
+ * its output and continues from there. Config is left as-is when controller is destroyed.
+ *
+ * State and changes of controller are published as trace subtree of its metric category.
+ */
+class controller : public metrics::if_source,
+                   public std::enable_shared_from_this<controller>
+{
+   public:
+    using options = controller_options;
+
+    struct status
+    {
+        double setpoint = 0;
+        double measured = 0;
+        double output   = 0;
+        bool is_timer   = false;
+
+        size_t num_steps   = 0;
+        size_t num_changes = 0;
+    };
+
+   public:
+    /**
+     * Starts controlling given config.
+     *
+     * @param node full hierarchy of target node, e.g. {"all", "process"}
+     * @return nullptr if arguments are invalid.
+     */
+    static auto start(config_shared_ptr conf,
+                      tracer_ptr target,
+                      std::vector<std::string> node,
+                      options opts) -> std::shared_ptr<controller>;
+
+   public:
+    ~controller() override;
+
+    controller(controller const&) = delete;
+    controller& operator=(controller const&) = delete;
+
+   public:
+    /** Changes setpoint. Takes effect from next control step. */
+    void setpoint(double value);
+
+    /** Can be called from any thread. */
+    status report() const;
+
+    auto& name() const noexcept { return _name; }
+
+   public:
+    void publish(tracer_proxy& node) override;
+
+   private:
+    controller(config_shared_ptr conf, options opts);
+
+    bool _on_iteration(tracer const& trc);
+    void _worker_fn();
+    void _step(std::unique_lock<std::mutex>& lock, std::vector<double>& samples);
+    void _adopt_current();
+
+   private:
+    config_shared_ptr const _conf;
+    options _opts;
+    std::string const _name;
+
+    double _min = 0;
+    double _max = 0;
+    bool _integral = false;
+
+    std::vector<std::string> _node;
+    std::vector<std::string_view> _node_view;
+    tracer::trace const* _node_cache = nullptr;
+
+    mutable std::mutex _mtx;
+    std::condition_variable _cvar;
+    bool _stop = false;
+
+    std::shared_ptr<_configs::apply_tracker> _tracker;
+    size_t _num_requested = 0;
+    size_t _num_skip      = 0;
+    bool _waiting         = false;
+
+    std::vector<double> _window;
+    std::vector<double> _window_full;
+    bool _window_ready = false;
+
+    // controller state. accessed under lock, but updated only from worker.
+    status _status;
+    nlohmann::json _current;  // latest requested value
+    double _output   = 0;     // unrounded output, which accumulates small steps
+    double _error[2] = {};    // previous two errors, for PID in velocity form
+    size_t _num_errors = 0;
+    std::string _last_change;
+
+    std::shared_ptr<metrics::category> _category;
+    std::thread _worker;
+};
+}  // namespace perfkit
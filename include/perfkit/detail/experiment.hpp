@@ -0,0 +1,174 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "perfkit/common/event.hxx"
+#include "perfkit/detail/config_tracker.hpp"
+#include "perfkit/detail/configs.hpp"
+#include "perfkit/detail/tracer.hpp"
+
+namespace perfkit {
+struct experiment_options
+{
+    // number of samples collected for an arm, before switching to the other one.
+    size_t block_size = 16;
+
+    // iterations discarded after each switch. iteration during which the switch was
+    // applied is always discarded, as it may have run with both values.
+    size_t warmup = 1;
+
+    // samples per arm required before early stop is considered.
+    size_t min_samples = 64;
+
+    // experiment finishes as inconclusive once every arm collected this many samples.
+    size_t max_samples = 4096;
+
+    // two-sided significance level of the final test.
+    double alpha = 0.05;
+};
+
+/**
+ * Online A/B experiment, which interleaves two values of a config and compares the
+ * distribution of a trace node under each of them.
+ *
+ * Value is switched every block_size samples of target node, thus both arms are exposed to
+ * the same drift of load, unlike before/after comparisons. Arms are compared by Mann-Whitney
+ * U test, and difference of means is reported with Welch confidence interval, both in normal
+ * approximation. Test is repeated after every pair of blocks with O'Brien-Fleming like
+ * boundary, thus experiment stops early as soon as the difference is significant without
+ * inflating false positive rate much. Original value is restored once finished or stopped.
+ *
+ * Target node is sampled on every fork() of its tracer, and can be timer, integer or
+ * floating point node. Samples are attributed to an arm only after owning registry applied
+ * its value, and experiment is aborted if the config is modified by others meanwhile.
+ *
+ * @code
+ *   auto exp = experiment::start(cfg_batch_size, 32, 64, tracer, {"all", "update"});
+ *   exp->on_finish += [](experiment::result const& r) { ... ; return false; };
+ * @endcode
+ */
+class experiment : public std::enable_shared_from_this<experiment>
+{
+   public:
+    using options = experiment_options;
+
+    enum class state_t
+    {
+        running,
+        significant,   // stopped early, or finished with significant difference
+        inconclusive,  // reached max_samples without significant difference
+        stopped,       // stopped by user
+        aborted,       // config was modified by others
+    };
+
+    struct arm_result
+    {
+        nlohmann::json value;
+        size_t count  = 0;
+        double mean   = 0;  // nanoseconds, if target is timer
+        double median = 0;
+        double stddev = 0;
+    };
+
+    struct result
+    {
+        state_t state = state_t::running;
+        bool is_timer = false;
+        arm_result arms[2];
+
+        // mean of b - mean of a, and its confidence interval of level 1 - alpha.
+        double diff    = 0;
+        double ci_low  = 0;
+        double ci_high = 0;
+
+        double z       = 0;  // Mann-Whitney statistic, positive if b tends to be larger
+        double p_value = 1;
+    };
+
+   public:
+    /**
+     * Starts experiment on given config, by queueing value_a.
+     *
+     * @param node full hierarchy of target node, e.g. {"all", "update", "draw"}
+     * @return nullptr if arguments are invalid.
+     */
+    static auto start(config_shared_ptr conf,
+                      nlohmann::json value_a,
+                      nlohmann::json value_b,
+                      tracer_ptr target,
+                      std::vector<std::string> node,
+                      options opts = {}) -> std::shared_ptr<experiment>;
+
+    template <typename Ty_>
+    static auto start(config<Ty_> const& conf, Ty_ const& value_a, Ty_ const& value_b,
+                      tracer_ptr target, std::vector<std::string> node,
+                      options opts = {}) -> std::shared_ptr<experiment>
+    {
+        auto& base = conf.base();
+        return start(base.owner()->bk_find(base.full_key()), value_a, value_b,
+                     std::move(target), std::move(node), opts);
+    }
+
+   public:
+    ~experiment() noexcept;
+
+    experiment(experiment const&) = delete;
+    experiment& operator=(experiment const&) = delete;
+
+   public:
+    /** Stops experiment and restores original value. No effect if already finished. */
+    void stop();
+
+    /** Current statistics. Can be called from any thread. */
+    result report() const;
+
+    state_t state() const noexcept;
+    bool finished() const noexcept { return state() != state_t::running; }
+
+   public:
+    /** Invoked with final result once, from the thread which finished the experiment. */
+    event<result const&> on_finish;
+
+   private:
+    experiment(config_shared_ptr conf, options opts);
+
+    bool _on_iteration(tracer const& trc);
+
+    // queues value of given arm, or original value if arm is negative.
+    void _queue(int arm);
+    void _finish(std::unique_lock<std::mutex>& lock, state_t state, bool restore = true);
+
+    result _evaluate() const;
+
+   private:
+    config_shared_ptr const _conf;
+    options const _opts;
+    double _z_alpha = 0;
+
+    nlohmann::json _original;
+    nlohmann::json _values[2];
+    std::shared_ptr<_configs::apply_tracker> _tracker;
+
+    std::vector<std::string> _node;
+    std::vector<std::string_view> _node_view;
+    tracer::trace const* _node_cache = nullptr;
+
+    mutable std::mutex _mtx;
+    state_t _state = state_t::running;
+    bool _is_timer = false;
+    std::vector<double> _samples[2];
+
+    int _active         = -1;  // arm whose value is applied
+    int _expected       = -1;  // arm whose value is queued
+    size_t _num_applied = 0;
+    size_t _num_skip    = 0;
+    size_t _block_count = 0;
+};
+
+char const* to_string(experiment::state_t state) noexcept;
+}  // namespace perfkit
@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace perfkit {
+/**
+ * Fixed size, log-linear histogram of non-negative integer samples.
+ *
+ * Each power-of-two range is split into 4 linear sub-buckets, thus relative error of
+ * percentile queries is bounded by 12.5%. Memory footprint never changes after
+ * construction, which makes this safe to keep in hot-path, per-thread state.
+ */
+class histogram
+{
+   public:
+    enum
+    {
+        num_sub_buckets = 4,
+        num_buckets     = 64 * num_sub_buckets,
+    };
+
+   public:
+    void record(uint64_t value, uint64_t count = 1) noexcept
+    {
+        _buckets[_index_of(value)] += count;
+        _count += count;
+        _sum += value * count;
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    template <typename Rep_, typename Period_>
+    void record(std::chrono::duration<Rep_, Period_> value) noexcept
+    {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(value).count();
+        record(ns < 0 ? 0 : uint64_t(ns));
+    }
+
+    void merge(histogram const& other) noexcept
+    {
+        for (size_t i = 0; i < _buckets.size(); ++i) { _buckets[i] += other._buckets[i]; }
+        _count += other._count;
+        _sum += other._sum;
+        _min = std::min(_min, other._min);
+        _max = std::max(_max, other._max);
+    }
+
+    void reset() noexcept { *this = {}; }
+
+    uint64_t count() const noexcept { return _count; }
+    uint64_t sum() const noexcept { return _sum; }
+    uint64_t min() const noexcept { return _count ? _min : 0; }
+    uint64_t max() const noexcept { return _max; }
+    double mean() const noexcept { return _count ? double(_sum) / _count : 0.; }
+
+    /**
+     * @param ratio percentile in range [0, 1]
+     * @return representative value of the bucket where given percentile resides.
+     */
+    uint64_t percentile(double ratio) const noexcept
+    {
+        if (_count == 0) { return 0; }
+
+        auto target = uint64_t(std::clamp(ratio, 0., 1.) * _count);
+        target      = std::clamp<uint64_t>(target, 1, _count);
+
+        uint64_t accum = 0;
+        for (size_t i = 0; i < _buckets.size(); ++i)
+        {
+            if ((accum += _buckets[i]) >= target)
+            {
+                return std::clamp(_midpoint_of(i), min(), max());
+            }
+        }
+
+        return _max;
+    }
+
+    /** Number of samples recorded in bucket which contains given value */
+    uint64_t bucket_count_of(uint64_t value) const noexcept { return _buckets[_index_of(value)]; }
+
+    template <typename Fn_>
+    void for_each_bucket(Fn_&& fn) const
+    {
+        for (size_t i = 0; i < _buckets.size(); ++i)
+        {
+            if (_buckets[i]) { fn(_lower_bound_of(i), _midpoint_of(i), _buckets[i]); }
+        }
+    }
+
+   public:
+    static size_t _index_of(uint64_t value) noexcept
+    {
+        if (value < num_sub_buckets) { return size_t(value); }
+
+        int exp = 63;
+        while ((value >> exp) == 0) { --exp; }
+
+        auto sub = (value >> (exp - 2)) & (num_sub_buckets - 1);
+        return (exp - 1) * num_sub_buckets + sub;
+    }
+
+    static uint64_t _lower_bound_of(size_t index) noexcept
+    {
+        if (index < num_sub_buckets) { return index; }
+
+        auto exp = index / num_sub_buckets + 1;
+        auto sub = index % num_sub_buckets;
+        return (num_sub_buckets + sub) << (exp - 2);
+    }
+
+    static uint64_t _midpoint_of(size_t index) noexcept
+    {
+        if (index < num_sub_buckets) { return index; }
+
+        auto exp = index / num_sub_buckets + 1;
+        return _lower_bound_of(index) + ((uint64_t{1} << (exp - 2)) >> 1);
+    }
+
+   private:
+    friend class atomic_histogram;
+
+    std::array<uint64_t, num_buckets> _buckets = {};
+    uint64_t _count                            = 0;
+    uint64_t _sum                              = 0;
+    uint64_t _min                              = ~uint64_t{};
+    uint64_t _max                              = 0;
+};
+
+/**
+ * Lock-free counterpart of histogram, which is recorded concurrently by many threads with
+ * relaxed atomic increments, and periodically drained by a single reader.
+ *
+ * Fields are drained one by one, thus a sample recorded during drain may be split across
+ * two windows. Bucket counts are authoritative; sample count is derived from them.
+ */
+class atomic_histogram
+{
+   public:
+    void record(uint64_t value) noexcept
+    {
+        _buckets[histogram::_index_of(value)].fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(value, std::memory_order_relaxed);
+
+        for (auto min = _min.load(std::memory_order_relaxed); value < min;)
+            if (_min.compare_exchange_weak(min, value, std::memory_order_relaxed)) { break; }
+
+        for (auto max = _max.load(std::memory_order_relaxed); value > max;)
+            if (_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) { break; }
+    }
+
+    /** Moves samples recorded since the last drain into out, which is overwritten. */
+    void drain(histogram* out) noexcept
+    {
+        out->_count = 0;
+        for (size_t i = 0; i < _buckets.size(); ++i)
+        {
+            // skips writing to cache lines of empty buckets.
+            auto n = _buckets[i].load(std::memory_order_relaxed);
+            if (n) { n = _buckets[i].exchange(0, std::memory_order_relaxed); }
+
+            out->_buckets[i] = n;
+            out->_count += n;
+        }
+
+        out->_sum = _sum.exchange(0, std::memory_order_relaxed);
+        out->_min = _min.exchange(~uint64_t{}, std::memory_order_relaxed);
+        out->_max = _max.exchange(0, std::memory_order_relaxed);
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, histogram::num_buckets> _buckets = {};
+    std::atomic<uint64_t> _sum{0};
+    std::atomic<uint64_t> _min{~uint64_t{}};
+    std::atomic<uint64_t> _max{0};
+};
+}  // namespace perfkit
@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "perfkit/detail/tracer.hpp"
+
+#if _MSC_VER
+#    include <intrin.h>
+#elif __x86_64__ or __i386__
+#    include <x86intrin.h>
+#endif
+
+namespace perfkit::metrics {
+/**
+ * A metric source which publishes its state as trace subtree.
+ *
+ * Sources are grouped into named categories, where each category owns a tracer of same
+ * name. Background publisher periodically forks category tracers, and invokes publish()
+ * of every source belongs to it, thus metrics appear on every trace watcher without
+ * requiring any thread of the application to fork().
+ */
+class if_source
+{
+   public:
+    virtual ~if_source() = default;
+
+    /**
+     * Called from publisher thread. Implementations should only read their state here.
+     *
+     * @param node trace node dedicated to this source.
+     */
+    virtual void publish(tracer_proxy& node) = 0;
+};
+
+class category : public std::enable_shared_from_this<category>
+{
+   public:
+    explicit category(std::string name);
+
+    /** Find or create category of given name. */
+    static auto share(std::string_view name) -> std::shared_ptr<category>;
+    static auto all() noexcept -> std::vector<std::shared_ptr<category>>;
+
+   public:
+    void add(std::string name, if_source* source);
+    void remove(if_source* source);
+
+    /** Fork category tracer and publish all sources. Called from publisher thread. */
+    void update();
+
+    auto& name() const noexcept { return _name; }
+    auto& tracer() const noexcept { return _tracer; }
+
+   private:
+    struct _source
+    {
+        std::string name;
+        if_source* ref;
+    };
+
+    std::string const _name;
+    tracer_ptr const _tracer;
+
+    std::mutex _mtx;
+    std::vector<_source> _sources;
+};
+
+/**
+ * Cheap timestamp for hot path stamping. Uses TSC on x86, steady clock nanoseconds
+ * elsewhere. Convert differences with tsc_to_duration().
+ */
+inline uint64_t tsc_now() noexcept
+{
+#if _MSC_VER or __x86_64__ or __i386__
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   clock_type::now().time_since_epoch())
+            .count();
+#endif
+}
+
+/** Nanoseconds per tick of tsc_now(). Calibrated once against steady clock on first call. */
+double tsc_ns_per_tick() noexcept;
+
+inline clock_type::duration tsc_to_duration(uint64_t ticks) noexcept
+{
+    return std::chrono::duration_cast<clock_type::duration>(
+            std::chrono::nanoseconds(uint64_t(ticks * tsc_ns_per_tick())));
+}
+
+/**
+ * Sets interval of background publisher.
+ */
+void publish_interval(std::chrono::milliseconds interval);
+}  // namespace perfkit::metrics
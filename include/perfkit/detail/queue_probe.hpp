@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <string_view>
+
+#include "perfkit/detail/histogram.hpp"
+#include "perfkit/detail/metrics.hpp"
+
+namespace perfkit {
+/**
+ * Instruments a producer/consumer queue or thread pool.
+ *
+ * Producers stamp each task on enqueue, and consumers report dequeue and completion with
+ * that stamp. Wait time (enqueue to dequeue), execution time, queue depth seen by each
+ * enqueue, throughput and utilization are published as trace subtree of a metric category.
+ * Every statistic but total completion count covers only the latest publish interval.
+ *
+ * A stage is starved when depth stays near zero while utilization is low, and saturated
+ * when depth and wait time keep growing while utilization approaches number of workers.
+ */
+class queue_probe : public metrics::if_source
+{
+   public:
+    using stamp_type = uint64_t;
+
+   public:
+    explicit queue_probe(std::string name, std::string_view category = "queues")
+            : _category(metrics::category::share(category))
+    {
+        _category->add(std::move(name), this);
+    }
+
+    ~queue_probe() override { _category->remove(this); }
+
+    queue_probe(queue_probe const&) = delete;
+    queue_probe& operator=(queue_probe const&) = delete;
+
+   public:
+    /** Call on producer side. Returned stamp should be carried with the task. */
+    stamp_type on_enqueue() noexcept
+    {
+        auto depth = _depth.fetch_add(1, std::memory_order_relaxed);
+        _depth_samples.record(uint64_t(std::max<int64_t>(0, depth)));
+        return metrics::tsc_now();
+    }
+
+    /** Call when consumer pops the task. Returned stamp is for on_complete(). */
+    stamp_type on_dequeue(stamp_type enqueued) noexcept
+    {
+        _depth.fetch_sub(1, std::memory_order_relaxed);
+
+        auto now = metrics::tsc_now();
+        _wait.record(now - enqueued);
+
+        return now;
+    }
+
+    /** Call when consumer finishes the task */
+    void on_complete(stamp_type dequeued) noexcept
+    {
+        _exec.record(metrics::tsc_now() - dequeued);
+    }
+
+    /** Call instead of on_dequeue(), when a queued task is dropped without execution */
+    void on_discard() noexcept { _depth.fetch_sub(1, std::memory_order_relaxed); }
+
+    /**
+     * Wraps a callable into a task which reports its own enqueue, dequeue and completion.
+     * Enqueue is stamped on this call, thus it should be called right before pushing.
+     */
+    template <typename Fn_>
+    auto wrap(Fn_&& fn)
+    {
+        return [this, stamp = on_enqueue(), fn = std::forward<Fn_>(fn)]() mutable {
+            auto dequeued = on_dequeue(stamp);
+            fn();
+            on_complete(dequeued);
+        };
+    }
+
+    auto depth() const noexcept { return _depth.load(std::memory_order_relaxed); }
+
+   public:
+    void publish(tracer_proxy& node) override
+    {
+        // every statistic below covers samples since the previous publish.
+        histogram wait, exec, depths;
+        _wait.drain(&wait);
+        _exec.drain(&exec);
+        _depth_samples.drain(&depths);
+
+        auto now   = clock_type::now();
+        auto depth = std::max<int64_t>(0, _depth.load(std::memory_order_relaxed));
+
+        auto to_duration = [](uint64_t ticks) { return metrics::tsc_to_duration(ticks); };
+        auto busy        = to_duration(exec.sum());
+        auto elapsed     = std::chrono::duration<double>(now - _prev_publish);
+
+        if (_prev_publish != clock_type::time_point{} && elapsed.count() > 0)
+        {
+            node["throughput"]  = exec.count() / elapsed.count();
+            node["utilization"] = std::chrono::duration<double>(busy).count() / elapsed.count();
+        }
+
+        _prev_publish = now;
+        _total_completed += exec.count();
+
+        node["depth"]     = depth;
+        node["depth_p50"] = depths.percentile(.5);
+        node["depth_max"] = depths.max();
+        node["completed"] = _total_completed;
+
+        {
+            auto wait_node   = node["wait"];
+            wait_node["p50"] = to_duration(wait.percentile(.5));
+            wait_node["p99"] = to_duration(wait.percentile(.99));
+            wait_node["max"] = to_duration(wait.max());
+        }
+        {
+            auto exec_node   = node["exec"];
+            exec_node["p50"] = to_duration(exec.percentile(.5));
+            exec_node["p99"] = to_duration(exec.percentile(.99));
+            exec_node["max"] = to_duration(exec.max());
+        }
+    }
+
+   private:
+    std::atomic<int64_t> _depth{0};
+
+    // recorded by producers and consumers, drained on publish. wait and exec are in tsc ticks.
+    atomic_histogram _wait;
+    atomic_histogram _exec;
+    atomic_histogram _depth_samples;
+
+    // publisher thread only
+    clock_type::time_point _prev_publish = {};
+    uint64_t _total_completed            = 0;
+
+    std::shared_ptr<metrics::category> _category;
+};
+}  // namespace perfkit
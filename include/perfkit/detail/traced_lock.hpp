@@ -0,0 +1,173 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "perfkit/common/spinlock.hxx"
+#include "perfkit/detail/histogram.hpp"
+#include "perfkit/detail/metrics.hpp"
+
+namespace perfkit {
+/**
+ * Labels current scope as lock holder. While it's alive, every traced lock acquired by
+ * this thread attributes its hold time to given label, which is reported as
+ * 'longest holder' of the lock.
+ *
+ * @warning label must outlive this object. String literals are recommended.
+ */
+class lock_scope
+{
+   public:
+    explicit lock_scope(char const* label) noexcept : _prev(_current()) { _current() = label; }
+    ~lock_scope() noexcept { _current() = _prev; }
+
+    lock_scope(lock_scope const&) = delete;
+    lock_scope& operator=(lock_scope const&) = delete;
+
+    static char const*& _current() noexcept
+    {
+        static thread_local char const* label = nullptr;
+        return label;
+    }
+
+   private:
+    char const* _prev;
+};
+
+/**
+ * Drop-in lockable wrapper, which publishes contention statistics of the underlying lock
+ * as trace nodes of metric category.
+ *
+ * Uncontended acquisition costs one relaxed atomic increment over the underlying lock.
+ * Waits are timed only when try_lock() fails, and hold times are sampled on every
+ * contended acquisition, or every 2^sample_shift th acquisition.
+ */
+template <typename Mutex_>
+class basic_traced_lock : public metrics::if_source
+{
+   public:
+    using mutex_type = Mutex_;
+
+    enum
+    {
+        sample_shift = 6,
+        sample_mask  = (1 << sample_shift) - 1,
+    };
+
+   public:
+    explicit basic_traced_lock(std::string name, std::string_view category = "locks")
+            : _category(metrics::category::share(category))
+    {
+        _category->add(std::move(name), this);
+    }
+
+    ~basic_traced_lock() override { _category->remove(this); }
+
+    basic_traced_lock(basic_traced_lock const&) = delete;
+    basic_traced_lock& operator=(basic_traced_lock const&) = delete;
+
+   public:
+    void lock()
+    {
+        auto n = _num_acquire.fetch_add(1, std::memory_order_relaxed);
+
+        if (_mtx.try_lock())
+        {
+            if ((n & sample_mask) == 0) { _hold_begin = clock_type::now(); }
+            return;
+        }
+
+        _lock_slow();
+    }
+
+    bool try_lock()
+    {
+        if (not _mtx.try_lock()) { return false; }
+
+        _num_acquire.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void unlock()
+    {
+        if (_hold_begin != clock_type::time_point{}) { _record_hold(); }
+        _mtx.unlock();
+    }
+
+    auto& native() noexcept { return _mtx; }
+
+   public:
+    void publish(tracer_proxy& node) override
+    {
+        histogram wait;
+        clock_type::duration hold_max;
+        char const* holder;
+        uint64_t num_contended;
+
+        {
+            std::lock_guard _{_stat_lock};
+            wait          = _wait;
+            hold_max      = _hold_max;
+            holder        = _holder;
+            num_contended = _num_contended;
+        }
+
+        using std::chrono::nanoseconds;
+        auto num_acquire = _num_acquire.load(std::memory_order_relaxed);
+
+        node["acquisitions"]    = num_acquire;
+        node["contended"]       = num_contended;
+        node["contention_rate"] = num_acquire ? double(num_contended) / num_acquire : 0.;
+        node["wait_p50"]        = clock_type::duration{nanoseconds(wait.percentile(.5))};
+        node["wait_p99"]        = clock_type::duration{nanoseconds(wait.percentile(.99))};
+        node["wait_max"]        = clock_type::duration{nanoseconds(wait.max())};
+        node["hold_max"]        = hold_max;
+        node["longest_holder"]  = std::string_view{holder ? holder : "<unlabeled>"};
+    }
+
+   private:
+    void _lock_slow()
+    {
+        auto begin = clock_type::now();
+        _mtx.lock();
+        _hold_begin = clock_type::now();
+
+        std::lock_guard _{_stat_lock};
+        ++_num_contended;
+        _wait.record(_hold_begin - begin);
+    }
+
+    void _record_hold()
+    {
+        auto elapsed = clock_type::now() - _hold_begin;
+        _hold_begin  = {};
+
+        std::lock_guard _{_stat_lock};
+        if (elapsed > _hold_max)
+        {
+            _hold_max = elapsed;
+            _holder   = lock_scope::_current();
+        }
+    }
+
+   private:
+    mutex_type _mtx;
+    std::atomic<uint64_t> _num_acquire{0};
+
+    // protected by _mtx itself; only the holder touches it.
+    clock_type::time_point _hold_begin = {};
+
+    // slow path statistics
+    spinlock _stat_lock;
+    uint64_t _num_contended        = 0;
+    histogram _wait                = {};
+    clock_type::duration _hold_max = {};
+    char const* _holder            = nullptr;
+
+    std::shared_ptr<metrics::category> _category;
+};
+
+using traced_mutex    = basic_traced_lock<std::mutex>;
+using traced_spinlock = basic_traced_lock<spinlock>;
+}  // namespace perfkit
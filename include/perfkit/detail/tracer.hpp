@@ -8,6 +8,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <variant>
 #include <vector>
@@ -22,6 +23,7 @@ namespace fmt {
 
 namespace perfkit {
 class tracer;
+class tracer_async_span;
 
 using clock_type         = std::chrono::steady_clock;
 using trace_variant_type = std::variant<nullptr_t,
@@ -42,6 +44,16 @@ struct trace
         return {};
     }
 
+    /** Value of timer, integer or floating point node. Timers are in nanoseconds. */
+    std::optional<double> as_number() const noexcept
+    {
+        if (auto ptr = std::get_if<clock_type::duration>(&data))
+            return double(std::chrono::duration_cast<std::chrono::nanoseconds>(*ptr).count());
+        if (auto ptr = std::get_if<int64_t>(&data)) { return double(*ptr); }
+        if (auto ptr = std::get_if<double>(&data)) { return *ptr; }
+        return {};
+    }
+
     void subscribe(bool enabled) noexcept
     {
         _is_subscribed->store(enabled, std::memory_order_relaxed);
@@ -93,6 +105,14 @@ struct _entity_ty
     std::atomic_bool is_folded{false};
     _entity_ty const* parent = nullptr;
 };
+
+struct async_record
+{
+    _entity_ty* node = nullptr;
+    clock_type::duration elapsed;
+    std::thread::id thread_begin;
+    std::thread::id thread_end;
+};
 }  // namespace _trace
 
 class tracer_proxy
@@ -105,6 +125,8 @@ class tracer_proxy
 
     tracer_proxy branch(std::string_view n) noexcept;
     tracer_proxy timer(std::string_view n) noexcept;
+    tracer_proxy timer(std::string_view n, clock_type::duration deadline) noexcept;
+    tracer_async_span async_span(std::string_view n) noexcept;
 
     template <size_t N_>
     tracer_proxy operator[](char const (&s)[N_]) noexcept
@@ -184,10 +206,12 @@ class tracer_proxy
         _owner             = other._owner;
         _ref               = other._ref;
         _epoch_if_required = other._epoch_if_required;
+        _deadline          = other._deadline;
 
         other._owner             = {};
         other._ref               = {};
         other._epoch_if_required = {};
+        other._deadline          = {};
 
         return *this;
     }
@@ -209,6 +233,44 @@ class tracer_proxy
     tracer* _owner                            = nullptr;
     _trace::_entity_ty* _ref                  = nullptr;
     clock_type::time_point _epoch_if_required = {};
+    clock_type::duration _deadline            = {};
+};
+
+/**
+ * A span which can be started on one thread, then moved to and finished on another one.
+ *
+ * Unlike tracer_proxy, async span is not bound to lexical scope or forking thread. Only the
+ * creation must occur on the fork()ed thread, as it attributes the span to a node of
+ * tracer's tree. Finished spans are collected by owning tracer on its next fork(), which
+ * publishes latest duration, latency distribution and begin/end threads of the span node.
+ */
+class tracer_async_span
+{
+   public:
+    tracer_async_span() noexcept = default;
+    tracer_async_span(tracer_async_span&& o) noexcept { *this = std::move(o); }
+    tracer_async_span& operator=(tracer_async_span&& o) noexcept;
+    ~tracer_async_span() noexcept { finish(); }
+
+    /**
+     * Finish this span and report elapsed time to owning tracer. Can be called from any
+     * thread, regardless of the one which created this span. Calling finish() on already finished span has no effect.
+     */
+    void finish() noexcept;
+
+    /** Discard this span without reporting */
+    void discard() noexcept { _owner.reset(), _ref = nullptr; }
+
+    bool is_valid() const noexcept { return _ref != nullptr; }
+    auto begin_thread() const noexcept { return _thread_begin; }
+    auto elapsed() const noexcept { return clock_type::now() - _epoch; }
+
+   private:
+    friend class tracer;
+    std::weak_ptr<tracer> _owner;
+    _trace::_entity_ty* _ref     = nullptr;
+    clock_type::time_point _epoch = {};
+    std::thread::id _thread_begin = {};
 };
 
 class tracer : public std::enable_shared_from_this<tracer>
@@ -244,6 +306,13 @@ class tracer : public std::enable_shared_from_this<tracer>
    public:
     event<fetched_traces const&> on_fetch;
 
+    /**
+     * Invoked on fork()ed thread whenever fork() begins new iteration, before anything of
+     * previous iteration is overwritten. Unlike on_fetch, nothing is copied, thus handlers
+     * can cheaply sample nodes of every iteration with find().
+     */
+    event<tracer const&> on_iteration;
+
    public:
     /**
      * Fork new proxy.
@@ -267,20 +336,57 @@ class tracer : public std::enable_shared_from_this<tracer>
      */
     tracer_proxy timer(std::string_view name);
 
+    /**
+     * Create new timer branch, which counts deadline misses.
+     *
+     * Timer node will have children of miss count, current and longest consecutive miss
+     * streak, and overrun distribution.
+     */
+    tracer_proxy timer(std::string_view name, clock_type::duration deadline);
+
+    /**
+     * Declares expected period between fork() invocations. Zero disables.
+     *
+     * Once declared, '__Time_Since_Last_Iteration' node will have children of deadline
+     * miss count, current and longest consecutive miss streak, and jitter (absolute
+     * deviation from period) distribution.
+     *
+     * @param tolerance iteration is counted as miss only when it's longer than period + tolerance.
+     */
+    void expected_period(clock_type::duration period, clock_type::duration tolerance = {});
+
     /**
      * Create new branch from topmost trace stack
      * @return
      */
     tracer_proxy branch(std::string_view name);
 
+    /**
+     * Create new async span from topmost trace stack.
+     *
+     * Returned span can be moved to other thread, and finished there.
+     */
+    tracer_async_span async_span(std::string_view name);
+
     /**
      * Reserves for async data sort
      */
     void request_fetch_data();
 
+    /**
+     * Finds node by its full hierarchy, e.g. {"all", "update", "draw"}.
+     * Only valid on fork()ed thread, e.g. from on_iteration handlers.
+     *
+     * @return nullptr if such node was never created.
+     */
+    trace const* find(array_view<std::string_view> hierarchy) const noexcept;
+
     auto& name() const noexcept { return _name; }
     auto order() const noexcept { return _occurrence_order; }
 
+    /** Sequence number of latest iteration. Nodes touched in it have same fence. */
+    auto fence() const noexcept { return _fence_active; }
+
    private:
     uint64_t _hash_active(_trace::_entity_ty const* parent, std::string_view top);
     bool _deliver_previous_result();
@@ -290,8 +396,16 @@ class tracer : public std::enable_shared_from_this<tracer>
     static std::vector<std::weak_ptr<tracer>>& _all() noexcept;
     void _try_pop(_trace::_entity_ty const* body);
 
+    tracer_async_span _new_async_span(_trace::_entity_ty const* parent, std::string_view name);
+    void _queue_async_record(_trace::async_record const& record);
+    void _flush_async_records();
+
+    void _on_deadline_timer(_trace::_entity_ty* node, clock_type::duration elapsed, clock_type::duration deadline);
+    void _on_iteration_period(_trace::_entity_ty* node, clock_type::duration elapsed);
+
    private:
     friend class tracer_proxy;
+    friend class tracer_async_span;
 
     // 고려사항
     // 1. consumer가 오랫동안 안 읽어갈수도 있음 -> 매번 메모리 비우고 할당하기 = 낭비
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "perfkit/common/event.hxx"
+#include "perfkit/detail/tracer.hpp"
+
+namespace perfkit {
+/**
+ * Aggregates structurally identical trees of multiple tracers into single snapshot.
+ *
+ * Nodes of each member tracer are matched by their hierarchical hash, thus tracers
+ * which share same schema (e.g. one tracer per shard, or per class instance) are merged
+ * into one tree, with per-node sum, mean, min, max and the instance which produced max.
+ */
+class tracer_group : public std::enable_shared_from_this<tracer_group>
+{
+   public:
+    enum class value_type
+    {
+        none,
+        duration,
+        integer,
+        floating_point,
+        boolean,
+        string,
+    };
+
+    struct aggregated_node
+    {
+        std::string key;
+        uint64_t hash        = 0;
+        uint64_t parent_hash = 0;
+        size_t depth         = 0;
+        size_t unique_order  = 0;
+
+        value_type type = value_type::none;
+        size_t num_instances = 0;
+
+        // durations are represented in seconds.
+        double sum  = 0;
+        double min  = 0;
+        double max  = 0;
+        double mean = 0;
+
+        std::string argmax_instance;
+        std::string sample;  // first instance's value, for non-numeric types
+
+        bool subscribing = false;  // whether any instance subscribes this node
+
+        void dump_data(std::string& out) const;
+    };
+
+    using snapshot = std::vector<aggregated_node>;
+
+   private:
+    explicit tracer_group(std::string name);
+
+   public:
+    ~tracer_group() noexcept;
+
+    static auto create(std::string name) -> std::shared_ptr<tracer_group>;
+    static auto all() noexcept -> std::vector<std::shared_ptr<tracer_group>>;
+
+   public:
+    /** Invoked from group's background thread, whenever aggregated snapshot is ready */
+    event<snapshot const&> on_fetch;
+
+   public:
+    void add(std::shared_ptr<tracer> member);
+    void remove(tracer const* member);
+    size_t size() const;
+
+    /**
+     * Requests fetch of all member tracers. Once every member delivers its traces, or
+     * member timeout expires, merge occurs on background thread and on_fetch is invoked.
+     */
+    void request_fetch_data();
+
+    /** Subscribes node of given hash on every member which has ever delivered it. */
+    void subscribe(uint64_t hash, bool enabled);
+
+    auto& name() const noexcept { return _name; }
+
+    void member_timeout(std::chrono::milliseconds value)
+    {
+        std::lock_guard _{_mtx};
+        _member_timeout = value;
+    }
+
+   private:
+    struct _member_trace
+    {
+        uint64_t hash;
+        uint64_t parent_hash;
+        size_t depth;
+        size_t unique_order;
+        std::string_view key;
+        trace_variant_type data;
+        bool subscribing;
+    };
+
+    struct _member
+    {
+        std::shared_ptr<tracer> ref;
+        std::vector<_member_trace> traces;
+        size_t fence_received = 0;
+
+        // subscription flags of delivered nodes, which live as long as the tracer.
+        std::unordered_map<uint64_t, std::atomic_bool*> subscriptions;
+    };
+
+    struct _merge_source
+    {
+        std::shared_ptr<tracer> ref;
+        std::vector<_member_trace> traces;
+    };
+
+    bool _on_member_fetch(tracer const* member, tracer::fetched_traces const& traces);
+    void _worker_fn();
+    void _merge(std::vector<_merge_source> const& sources, snapshot* out);
+
+   private:
+    std::string const _name;
+
+    mutable std::mutex _mtx;
+    std::condition_variable _cvar;
+    std::vector<std::unique_ptr<_member>> _members;
+    size_t _fence_request = 0;
+    size_t _fence_merged  = 0;
+    bool _active          = true;
+
+    std::chrono::milliseconds _member_timeout{1000};
+    snapshot _reused_snapshot;
+    std::thread _worker;
+};
+
+using tracer_group_ptr = std::shared_ptr<tracer_group>;
+}  // namespace perfkit
@@ -0,0 +1,211 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "perfkit/common/event.hxx"
+#include "perfkit/detail/config_tracker.hpp"
+#include "perfkit/detail/configs.hpp"
+#include "perfkit/detail/tracer.hpp"
+
+namespace perfkit {
+struct tuner_options
+{
+    // samples of target node collected per measurement of a candidate.
+    size_t iterations = 32;
+
+    // iterations discarded after candidate is applied, in addition to the one during which
+    // it was applied.
+    size_t warmup = 1;
+
+    // total number of samples. checked between configs, thus may be slightly exceeded.
+    size_t budget = 4096;
+
+    // maximum passes over all configs. stops earlier if a pass changes nothing.
+    size_t rounds = 3;
+
+    // number of candidates of numeric config, evenly spaced in its [min, max]. spacing is
+    // geometric if the range spans more than two orders of magnitude.
+    size_t grid = 8;
+
+    // percentile of samples which is minimized, or maximized.
+    double percentile = 0.5;
+    bool maximize     = false;
+
+    // tuning is aborted if any measurement is worse than baseline by this ratio, e.g. 1.0
+    // aborts once the metric doubles. zero disables.
+    double abort_ratio = 1.0;
+};
+
+/**
+ * Budgeted search over configs' min/max/one_of spaces, which minimizes a trace node.
+ *
+ * Search is coordinate descent: configs are tuned one by one, while others are fixed at
+ * their best values. Candidates of a config, including its current best, are compared by
+ * successive halving: every candidate is measured over `iterations` samples, then the
+ * better half survives and is measured again, until a single one remains. Thus most of
+ * the budget is spent on promising candidates, and the incumbent is always re-measured
+ * along with its rivals under the same load.
+ *
+ * Candidates are applied by a config batch, and measured only after the registry applied
+ * them. Current values are measured first as baseline. Once finished, best values are
+ * committed. Original values are restored if tuning is stopped or aborted, which occurs
+ * when a measurement degrades past abort_ratio, or a config is modified by others.
+ *
+ * Target node is sampled on every fork() of its tracer, thus the search runs at the
+ * iteration cadence of the application itself.
+ */
+class tuner : public std::enable_shared_from_this<tuner>
+{
+   public:
+    using options = tuner_options;
+
+    enum class state_t
+    {
+        running,
+        finished,
+        stopped,
+        aborted,
+    };
+
+    struct progress
+    {
+        size_t round = 0;
+        size_t level = 0;  // level of successive halving
+        std::string key;   // display key of config being tuned. empty on baseline.
+        nlohmann::json value;
+
+        bool is_timer   = false;  // scores are in nanoseconds, if true
+        double score    = 0;
+        double baseline = 0;
+
+        size_t used   = 0;
+        size_t budget = 0;
+    };
+
+    struct result
+    {
+        state_t state = state_t::running;
+        nlohmann::json best = nlohmann::json::object();  // display key -> value
+
+        bool is_timer     = false;
+        double baseline   = 0;
+        double best_score = 0;
+
+        size_t round        = 0;
+        size_t num_measured = 0;
+        size_t used         = 0;
+        size_t budget       = 0;
+    };
+
+   public:
+    /**
+     * Starts tuning given configs. Every config must have one_of, or min and max attributes,
+     * unless it's boolean.
+     *
+     * @param node full hierarchy of target node, e.g. {"all", "update", "draw"}
+     * @return nullptr if arguments are invalid.
+     */
+    static auto start(std::vector<config_shared_ptr> confs,
+                      tracer_ptr target,
+                      std::vector<std::string> node,
+                      options opts = {}) -> std::shared_ptr<tuner>;
+
+   public:
+    ~tuner() noexcept;
+
+    tuner(tuner const&) = delete;
+    tuner& operator=(tuner const&) = delete;
+
+   public:
+    /** Stops tuning and restores original values. No effect if already finished. */
+    void stop();
+
+    /** Current best, or final result. Can be called from any thread. */
+    result report() const;
+
+    state_t state() const noexcept;
+    bool finished() const noexcept { return state() != state_t::running; }
+
+   public:
+    /** Invoked on fork()ed thread whenever a candidate is measured. */
+    event<progress const&> on_progress;
+
+    /** Invoked with final result once, from the thread which finished tuning. */
+    event<result const&> on_finish;
+
+   private:
+    explicit tuner(options opts) : _opts(opts) {}
+
+    bool _on_iteration(tracer const& trc);
+
+    // moves to next candidate. returns true if search is over.
+    bool _advance(configs::batch* changes);
+    bool _begin_config(configs::batch* changes);
+    void _apply(configs::batch* changes, nlohmann::json const* value);
+
+    void _finish(std::unique_lock<std::mutex>& lock, state_t state, progress const* last = nullptr);
+
+    double _score(std::vector<double> const& samples) const;
+    bool _is_worse(double score, double than) const noexcept;
+    result _report() const;
+
+   private:
+    struct _config
+    {
+        config_shared_ptr ref;
+        std::shared_ptr<_configs::apply_tracker> tracker;
+        std::vector<nlohmann::json> space;
+
+        nlohmann::json original;
+        nlohmann::json best;
+        nlohmann::json current;  // latest requested value
+
+        size_t num_requested = 0;
+    };
+
+    struct _candidate
+    {
+        nlohmann::json value;
+        std::vector<double> samples;
+        double score = 0;
+    };
+
+   private:
+    options const _opts;
+
+    std::vector<_config> _targets;
+    std::vector<std::string> _node;
+    std::vector<std::string_view> _node_view;
+    tracer::trace const* _node_cache = nullptr;
+
+    mutable std::mutex _mtx;
+    state_t _state = state_t::running;
+    bool _is_timer = false;
+
+    // candidates of current config which survived, and the one being measured.
+    std::vector<_candidate> _rung;
+    size_t _rung_index = 0;
+    size_t _level      = 0;
+
+    size_t _config_index = 0;
+    size_t _round        = 0;
+    bool _baseline_phase = true;
+    bool _changed        = false;  // whether current round changed any config
+
+    bool _waiting        = false;  // until registry applies requested values
+    size_t _num_skip     = 0;
+    size_t _num_visited  = 0;  // samples in current measurement
+    size_t _num_measured = 0;
+    size_t _used         = 0;
+
+    double _baseline   = 0;
+    double _best_score = 0;
+};
+
+char const* to_string(tuner::state_t state) noexcept;
+}  // namespace perfkit
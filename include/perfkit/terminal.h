@@ -105,12 +105,15 @@ void initialize_with_basic_commands(if_terminal* ref);
  * @param to
  * @param cmd_write usage: cmd_write [path]. if path is not specified, previous path will be used.
  * @param cmd_read usage: cmd_read [path]. if path is not specified, previous path will be used.
+ * @param cmd_watch usage: cmd_watch [path|off]. reloads changed values whenever file is modified.
+ *                  opt-in, as it spawns background thread. not registered if empty.
  */
 void register_conffile_io_commands(
         if_terminal* ref,
         std::string_view cmd_load     = "load-config",  // e.g. "ld"
         std::string_view cmd_store    = "save-config",
-        std::string_view initial_path = {});  // e.g. "w"
+        std::string_view initial_path = {},  // e.g. "w"
+        std::string_view cmd_watch    = {});  // e.g. "watch-config"
 
 /**
  * Register option manipulation command
@@ -125,7 +128,11 @@ void register_conffile_io_commands(
  *      <cmd> <config:bool> toggle
  *      <cmd> <config:bool> detail
  *      <cmd> *<category-name>
+ *      <cmd> history <registry> <config>
+ *      <cmd> rollback <registry> [config] <time>
+ *      <cmd> diff <registry> <from> [to]
  *
+ *  where <time> is duration ago (e.g. 500ms, 30s, 5m, 1h), or milliseconds since epoch.
  */
 void register_config_manip_command(
         if_terminal* ref,
@@ -146,6 +153,64 @@ void register_trace_manip_command(
         if_terminal* ref,
         std::string_view cmd = "trace");
 
+/**
+ * Register online A/B experiment command. See perfkit::experiment
+ *
+ * @param ref
+ * @param cmd
+ *
+ * @details
+ *
+ *      <cmd> start <registry> <config> <value-a> <value-b> <tracer> <node> [block-size]
+ *      <cmd> status
+ *      <cmd> stop
+ *
+ *  where <node> is full hierarchy of target trace joined with '.', e.g. all.update.draw
+ *  Result is written to terminal once the experiment finishes.
+ */
+void register_experiment_command(
+        if_terminal* ref,
+        std::string_view cmd = "experiment");
+
+/**
+ * Register config autotuning command. See perfkit::tuner
+ *
+ * @param ref
+ * @param cmd
+ *
+ * @details
+ *
+ *      <cmd> start <registry> <config>... minimize|maximize <tracer> <node> [iterations] [budget]
+ *      <cmd> status
+ *      <cmd> stop
+ *
+ *  Every measurement is written to terminal as progress, and the best values are applied
+ *  once tuning finishes.
+ */
+void register_tune_command(
+        if_terminal* ref,
+        std::string_view cmd = "tune");
+
+/**
+ * Register closed-loop config controller command. See perfkit::controller
+ *
+ * @param ref
+ * @param cmd
+ *
+ * @details
+ *
+ *      <cmd> start <registry> <config> <tracer> <node> <setpoint> [pid|aimd] [inverse]
+ *      <cmd> setpoint <config> <setpoint>
+ *      <cmd> stop <config>
+ *      <cmd> list
+ *
+ *  where <setpoint> is p99 of target node, with unit suffix (ns, us, ms, s) for timers.
+ *  State of each controller is published under 'controllers' trace.
+ */
+void register_control_command(
+        if_terminal* ref,
+        std::string_view cmd = "control");
+
 /**
  * Register logging manipulation command
  *
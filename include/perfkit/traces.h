@@ -1,5 +1,12 @@
 #pragma once
 #include "perfkit/detail/tracer.hpp"
+#include "perfkit/detail/experiment.hpp"
+#include "perfkit/detail/metrics.hpp"
+#include "perfkit/detail/queue_probe.hpp"
+#include "perfkit/detail/traced_lock.hpp"
+#include "perfkit/detail/tracer_group.hpp"
+#include "perfkit/detail/controller.hpp"
+#include "perfkit/detail/tuner.hpp"
 
 #define INTERNAL_PERFKIT_TRACER_STRINGIFY2(X) #X
 #define INTERNAL_PERFKIT_TRACER_STRINGIFY(X)  INTERNAL_PERFKIT_TRACER_STRINGIFY2(X)
@@ -0,0 +1,250 @@
+#include "perfkit/detail/command_index.hpp"
+
+#include <algorithm>
+
+namespace perfkit::commands {
+struct radix_index::_node
+{
+    std::string label;  // edge from parent
+    bool terminal = false;
+    size_t count  = 0;  // keys in subtree, including this
+
+    // sorted by first character of label, which is unique among siblings.
+    std::vector<std::unique_ptr<_node>> children;
+
+    auto _lower_bound(char ch)
+    {
+        return std::lower_bound(children.begin(), children.end(), ch,
+                                [](auto& child, char c) { return child->label[0] < c; });
+    }
+
+    _node* child_of(char ch) const
+    {
+        auto it = const_cast<_node*>(this)->_lower_bound(ch);
+        return it != children.end() && (*it)->label[0] == ch ? it->get() : nullptr;
+    }
+};
+
+static size_t _common_length(std::string_view a, std::string_view b) noexcept
+{
+    size_t n = 0;
+    for (auto max = std::min(a.size(), b.size()); n < max && a[n] == b[n];) { ++n; }
+    return n;
+}
+
+radix_index::radix_index() : _root(std::make_unique<_node>()) {}
+radix_index::~radix_index() noexcept = default;
+
+radix_index::radix_index(radix_index&&) noexcept = default;
+radix_index& radix_index::operator=(radix_index&&) noexcept = default;
+
+bool radix_index::insert(std::string_view key)
+{
+    if (contains(key)) { return false; }
+    _cache_valid = false;
+
+    auto node = _root.get();
+    for (;;)
+    {
+        ++node->count;
+        if (key.empty()) { return node->terminal = true; }
+
+        auto it = node->_lower_bound(key[0]);
+        if (it == node->children.end() || (*it)->label[0] != key[0])
+        {
+            auto leaf      = std::make_unique<_node>();
+            leaf->label    = std::string{key};
+            leaf->terminal = true;
+            leaf->count    = 1;
+            node->children.insert(it, std::move(leaf));
+            return true;
+        }
+
+        auto child = it->get();
+        auto n     = _common_length(child->label, key);
+
+        if (n < child->label.size())
+        {
+            // split edge, where the intermediate node takes common part of label.
+            auto mid   = std::make_unique<_node>();
+            mid->label = child->label.substr(0, n);
+            mid->count = child->count;
+
+            child->label.erase(0, n);
+            mid->children.push_back(std::move(*it));
+            *it = std::move(mid);
+            child = it->get();
+        }
+
+        node = child;
+        key.remove_prefix(n);
+    }
+}
+
+bool radix_index::erase(std::string_view key)
+{
+    if (not contains(key)) { return false; }
+    _cache_valid = false;
+
+    std::vector<_node*> path{_root.get()};
+    for (auto node = _root.get(); not key.empty();)
+    {
+        node = node->child_of(key[0]);
+        key.remove_prefix(node->label.size());
+        path.push_back(node);
+    }
+
+    for (auto node : path) { --node->count; }
+    path.back()->terminal = false;
+
+    // drop emptied subtree, then merge chain of single child left by it.
+    for (size_t i = path.size() - 1; i > 0; --i)
+    {
+        auto node   = path[i];
+        auto parent = path[i - 1];
+
+        if (node->count == 0)
+        {
+            parent->children.erase(parent->_lower_bound(node->label[0]));
+            continue;
+        }
+
+        if (not node->terminal && node->children.size() == 1)
+        {
+            auto child = std::move(node->children[0]);
+            child->label.insert(0, node->label);
+            *parent->_lower_bound(child->label[0]) = std::move(child);
+        }
+
+        break;
+    }
+
+    return true;
+}
+
+void radix_index::clear() noexcept
+{
+    _root        = std::make_unique<_node>();
+    _cache_valid = false;
+}
+
+bool radix_index::contains(std::string_view key) const
+{
+    auto loc = _locate(key);
+    return loc.node && loc.tail.empty() && loc.node->terminal;
+}
+
+size_t radix_index::size() const noexcept
+{
+    return _root->count;
+}
+
+auto radix_index::_locate(std::string_view prefix) const -> _locus
+{
+    _node const* node = _root.get();
+    size_t consumed   = 0;
+
+    // continue from the latest query, if this one narrows it.
+    if (_cache_valid && prefix.size() >= _cached_prefix.size()
+        && prefix.substr(0, _cached_prefix.size()) == _cached_prefix)
+    {
+        if (_cached.node == nullptr) { return {}; }
+
+        auto rest = prefix.substr(_cached_prefix.size());
+        auto n    = _common_length(_cached.tail, rest);
+
+        if (n < _cached.tail.size())
+        {
+            if (n < rest.size()) { return {}; }
+            return {_cached.node, _cached.tail.substr(n)};
+        }
+
+        node     = _cached.node;
+        consumed = _cached_prefix.size() + n;
+    }
+
+    _locus found;
+    for (;;)
+    {
+        if (consumed == prefix.size()) { found = {node, {}}; break; }
+
+        auto child = node->child_of(prefix[consumed]);
+        if (child == nullptr) { break; }
+
+        auto rest = prefix.substr(consumed);
+        auto n    = _common_length(child->label, rest);
+
+        if (n == rest.size()) { found = {child, std::string_view{child->label}.substr(n)}; break; }
+        if (n < child->label.size()) { break; }
+
+        node = child, consumed += n;
+    }
+
+    _cached_prefix.assign(prefix.data(), prefix.size());
+    _cached      = found;
+    _cache_valid = true;
+    return found;
+}
+
+size_t radix_index::count(std::string_view prefix) const
+{
+    auto loc = _locate(prefix);
+    return loc.node ? loc.node->count : 0;
+}
+
+size_t radix_index::collect(std::string_view prefix, size_t offset, size_t limit,
+                            std::vector<std::string>* out) const
+{
+    auto loc = _locate(prefix);
+    if (loc.node == nullptr || offset >= loc.node->count || limit == 0) { return 0; }
+
+    std::string key{prefix};
+    key.append(loc.tail.data(), loc.tail.size());
+
+    size_t num_appended = 0;
+    auto visit          = [&](auto&& self, _node const* node) -> void {
+        if (node->terminal)
+        {
+            if (offset > 0)
+                --offset;
+            else if (out->push_back(key), ++num_appended == limit)
+                return;
+        }
+
+        for (auto& child : node->children)
+        {
+            if (num_appended == limit) { return; }
+            if (child->count <= offset) { offset -= child->count; continue; }  // skip subtree
+
+            key += child->label;
+            self(self, child.get());
+            key.resize(key.size() - child->label.size());
+        }
+    };
+
+    visit(visit, loc.node);
+    return num_appended;
+}
+
+bool radix_index::common_prefix(std::string_view prefix, std::string* out) const
+{
+    auto loc = _locate(prefix);
+    if (loc.node == nullptr || loc.node->count == 0) { return false; }
+
+    out->assign(prefix.data(), prefix.size());
+    out->append(loc.tail.data(), loc.tail.size());
+
+    for (auto node = loc.node; not node->terminal && node->children.size() == 1;)
+    {
+        node = node->children[0].get();
+        *out += node->label;
+    }
+
+    return true;
+}
+
+bool radix_index::find_unique(std::string_view prefix, std::string* out) const
+{
+    return count(prefix) == 1 && common_prefix(prefix, out);
+}
+}  // namespace perfkit::commands
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <optional>
 #include <regex>
 
 #include <range/v3/action/push_back.hpp>
@@ -20,7 +21,6 @@ namespace {
 using std::lock_guard;
 using std::unique_lock;
 
-const static std::regex rg_argv_token{R"RG((?:"((?:\\.|[^"\\])*)"|((?:[^\s\\]|\\.)+)))RG"};
 const static std::regex rg_cmd_token{R"(^\S(.*\S|$))"};
 }  // namespace
 
@@ -45,6 +45,8 @@ perfkit::commands::registry::node* perfkit::commands::registry::node::_add_subco
         throw command_name_invalid_exception{};
     }
 
+    _index.insert(cmd);
+
     auto& subcmd          = _subcommands[std::move(cmd)];
     subcmd._invoke        = std::move(handler);
     subcmd._suggest       = std::move(suggest);
@@ -81,29 +83,16 @@ perfkit::commands::registry::node const* perfkit::commands::registry::node::_fin
 
     if (auto it = _aliases.find(cmd_or_alias); it != _aliases.end())
     {
-        return &_subcommands.find(cmd_or_alias)->second;
+        return &_subcommands.find(it->second)->second;
     }
 
     // find initial and unique match ...
-    node const* subcmd = {};
-    {
-        auto it = _subcommands.lower_bound(cmd_or_alias);
-        for (; it != _subcommands.end() && it->first.find(cmd_or_alias) == 0; ++it)
-        {
-            if (subcmd) { return nullptr; }
-            subcmd = _find_subcommand(it->first);
-        }
-    }
+    if (std::string name; _index.find_unique(cmd_or_alias, &name))
     {
-        auto it = _aliases.lower_bound(cmd_or_alias);
-        for (; it != _aliases.end() && it->first.find(cmd_or_alias) == 0; ++it)
-        {
-            if (subcmd) { return nullptr; }
-            subcmd = _find_subcommand(it->first);
-        }
+        return _find_subcommand(name);
     }
 
-    return subcmd;
+    return nullptr;
 }
 
 perfkit::commands::registry::node* perfkit::commands::registry::node::_find_subcommand(std::string_view cmd_or_alias)
@@ -124,6 +113,7 @@ bool perfkit::commands::registry::node::erase_subcommand(std::string_view cmd_or
             auto& [alias, cmd] = *it_a;
             if (cmd == cmd_or_alias)
             {
+                _index.erase(alias);
                 _aliases.erase(it_a++);
             }
             else
@@ -132,11 +122,13 @@ bool perfkit::commands::registry::node::erase_subcommand(std::string_view cmd_or
             }
         }
 
+        _index.erase(it->first);
         _subcommands.erase(it);
         return true;
     }
     if (auto it = _aliases.find(cmd_or_alias); it != _aliases.end())
     {
+        _index.erase(it->first);
         _aliases.erase(it);
         return true;
     }
@@ -161,7 +153,8 @@ bool perfkit::commands::registry::node::alias(
         return false;
     }
 
-    _aliases.try_emplace(alias, cmd);
+    _index.insert(alias);
+    _aliases.try_emplace(std::move(alias), cmd);
     return true;
 }
 
@@ -185,34 +178,18 @@ std::string perfkit::commands::registry::node::suggest(
         std::vector<std::string>& out_candidates,
         bool space_after_last_token,
         int* target_token_index,
-        bool* out_has_unique_match)
+        bool* out_has_unique_match,
+        suggest_page* page)
 {
     lock_guard _{*_subcmd_lock};
     if (_hook_pre_op) { _hook_pre_op(this, full_tokens); }
 
     using namespace ranges;
-    string_set user_candidates;
-
-    if (full_tokens.empty())
-    {
-        out_candidates |= actions::push_back(_subcommands | views::keys);
-        out_candidates |= actions::push_back(_aliases | views::keys);
-
-        if (_suggest)
-        {
-            _suggest(full_tokens, user_candidates);
-            out_candidates.insert(out_candidates.end(),
-                                  std::move(user_candidates).begin(),
-                                  std::move(user_candidates).end());
-        }
-
-        return {};
-    }
 
-    auto exec          = full_tokens[0];
-    bool is_last_token = full_tokens.size() == 1;
+    std::string_view exec = full_tokens.empty() ? std::string_view{} : full_tokens[0];
+    bool is_last_token    = full_tokens.size() == 1;
 
-    if (node* subcmd = {}; !is_last_token)
+    if (node* subcmd = {}; not full_tokens.empty() && !is_last_token)
     {
         subcmd = _find_subcommand(exec);
 
@@ -226,56 +203,90 @@ std::string perfkit::commands::registry::node::suggest(
                                    out_candidates,
                                    space_after_last_token,
                                    target_token_index,
-                                   out_has_unique_match);
+                                   out_has_unique_match,
+                                   page);
         }
     }
 
     // find default suggestion list by rule.
     //
-    // note: maps are already sorted, thus one don't need to iterate all elements, but
-    // simply find lower bound then iterate until meet one doesn't start with compared.
-    auto filter_starts_with = [&](auto&& map, auto& compare) {
-        for (auto it = map.lower_bound(compare);
-             it != map.end() && it->first.find(compare) == 0;
-             ++it)
-        {
-            out_candidates.push_back(it->first);
-        }
-    };
+    // note: subcommands, aliases and indexed suggests are radix-indexed, thus only the page of
+    // candidates is copied out. legacy suggest handler is sorted, thus only the range of
+    // candidates which starts with compared is visited.
+    auto hint    = full_tokens.empty() ? full_tokens : full_tokens.subspan(0, full_tokens.size() - 1);
+    auto indexed = _indexed_suggests(hint);
 
-    filter_starts_with(_subcommands, exec);
-    filter_starts_with(_aliases, exec);
+    string_set user_candidates;
+    if (_suggest) { _suggest(full_tokens, user_candidates); }
+
+    auto user_begin = user_candidates.lower_bound(exec);
+    auto user_end   = user_begin;
+    size_t num_user = 0;
+    for (; user_end != user_candidates.end() && user_end->find(exec) == 0; ++user_end) { ++num_user; }
 
-    if (_suggest)
     {
-        _suggest(full_tokens, user_candidates);
-        for (auto it = user_candidates.lower_bound(exec);
-             it != user_candidates.end() && it->find(exec) == 0;
-             ++it)
+        size_t offset = page ? page->offset : 0;
+        size_t limit  = page ? page->limit : ~size_t{};
+
+        auto collect_index = [&](radix_index const* index) {
+            if (not index) { return; }
+
+            auto num_matched = index->count(exec);
+            limit -= index->collect(exec, offset, limit, &out_candidates);
+            offset -= std::min(offset, num_matched);
+        };
+
+        collect_index(&_index);
+        collect_index(indexed);
+
+        for (auto it = user_begin; it != user_end && limit > 0; ++it)
         {
-            out_candidates.push_back(std::move(*it));
+            if (offset > 0) { --offset; }
+            else { out_candidates.push_back(*it), --limit; }
         }
+
+        page && (page->total = _index.count(exec) + (indexed ? indexed->count(exec) : 0) + num_user);
     }
 
-    if (out_candidates.empty() == false)
+    if (full_tokens.empty())
     {
-        auto sharing = out_candidates.front();
+        return {};
+    }
 
-        for (auto candidate : out_candidates | views::tail)
-        {
-            // look for initial occlusion of two string
-            size_t j = 0;
-            for (; j < std::min(sharing.size(), candidate.size()) && sharing[j] == candidate[j]; ++j) {}
+    // longest common part of every candidate, merged from each source.
+    std::optional<std::string> sharing;
+    auto merge_sharing = [&](std::string_view common) {
+        if (not sharing) { return void(sharing = std::string{common}); }
 
-            sharing = sharing.substr(0, j);
-            if (sharing.empty()) { break; }
-        }
+        size_t j = 0;
+        for (; j < std::min(sharing->size(), common.size()) && (*sharing)[j] == common[j]; ++j) {}
+        sharing->resize(j);
+    };
+
+    std::string common;
+    _index.common_prefix(exec, &common) && (merge_sharing(common), 0);
+    indexed && indexed->common_prefix(exec, &common) && (merge_sharing(common), 0);
+
+    if (num_user > 0)
+    {
+        // common part of sorted range is the one of its first and last.
+        merge_sharing(*user_begin);
+        merge_sharing(*std::prev(user_end));
+    }
+
+    if (sharing)
+    {
+        // every candidate starts with sharing, thus it is unique match if none is longer.
+        auto num_longer = [&](radix_index const* index) {
+            return index ? index->count(*sharing) - index->contains(*sharing) : 0;
+        };
 
-        bool is_unique_match = check_unique_prefix(sharing, out_candidates);
+        bool is_unique_match = num_longer(&_index) + num_longer(indexed) == 0
+                               && num_user - user_candidates.count(*sharing) == 0;
         out_has_unique_match && (*out_has_unique_match = is_unique_match);
 
         if (node* subcmd = {}; (space_after_last_token || is_unique_match)
-                               && (subcmd = _find_subcommand(sharing))
+                               && (subcmd = _find_subcommand(*sharing))
                                && _check_name_exist(exec))
         {
             out_candidates.clear();
@@ -284,10 +295,11 @@ std::string perfkit::commands::registry::node::suggest(
                                    out_candidates,
                                    space_after_last_token,
                                    target_token_index,
-                                   out_has_unique_match);
+                                   out_has_unique_match,
+                                   page);
         }
 
-        return std::string{sharing};
+        return std::move(*sharing);
     }
 
     return {};
@@ -330,6 +342,7 @@ void perfkit::commands::registry::node::clear()
 
     _subcommands.clear();
     _aliases.clear();
+    _index.clear();
 }
 
 void perfkit::commands::registry::node::reset_suggest_handler(
@@ -340,6 +353,39 @@ void perfkit::commands::registry::node::reset_suggest_handler(
     _suggest = std::move(fn);
 }
 
+void perfkit::commands::registry::node::reset_suggest_index(
+        autocomplete_suggest_fn fn)
+{
+    unique_lock _{*_subcmd_lock};
+
+    _suggest_indexed.reset();
+    if (fn) { (_suggest_indexed = std::make_unique<_suggest_cache>())->fn = std::move(fn); }
+}
+
+perfkit::commands::radix_index const*
+perfkit::commands::registry::node::_indexed_suggests(args_view hint)
+{
+    using namespace std::literals;
+    if (not _suggest_indexed) { return nullptr; }
+
+    // candidates are assumed stable while user types a token, though they may change in
+    // meantime, e.g. config registered later, thus kept only for a short period.
+    auto cache = _suggest_indexed.get();
+    auto now   = std::chrono::steady_clock::now();
+
+    if (now < cache->expiry && ranges::equal(cache->hint, hint)) { return &cache->index; }
+
+    string_set candidates;
+    cache->fn(hint, candidates);
+
+    cache->index.clear();
+    for (auto& candidate : candidates) { cache->index.insert(candidate); }
+
+    cache->hint.assign(hint.begin(), hint.end());
+    cache->expiry = now + 1s;
+    return &cache->index;
+}
+
 void perfkit::commands::registry::node::reset_opreation_hook(
         std::function<void(node*, args_view)> hook)
 {
@@ -348,56 +394,92 @@ void perfkit::commands::registry::node::reset_opreation_hook(
     _hook_pre_op = std::move(hook);
 }
 
+namespace {
+bool is_space(char ch) noexcept { return ch == ' ' || ('\t' <= ch && ch <= '\r'); }
+bool is_line_end(char ch) noexcept { return ch == '\n' || ch == '\r'; }
+
+// length of run which consists of escape pairs, and characters accepted by pred. escaped
+// line end is not an escape pair, which stops the run.
+template <typename Pred_>
+size_t scan_token(std::string_view src, size_t at, Pred_&& accept) noexcept
+{
+    auto const begin = at;
+
+    while (at < src.size())
+    {
+        if (src[at] == '\\')
+        {
+            if (at + 1 == src.size() || is_line_end(src[at + 1])) { break; }
+            at += 2;
+        }
+        else if (accept(src[at]))
+        {
+            at += 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return at - begin;
+}
+}  // namespace
+
 void perfkit::commands::tokenize_by_argv_rule(
         std::string* io,
         std::vector<std::string_view>& tokens,
         std::vector<stroffset>* token_indexes)
 {
-    auto const src = *io;
-    io->clear(), io->reserve(src.size());
-
-    std::cregex_iterator iter{src.data(), src.data() + src.size(), rg_argv_token};
-    std::cregex_iterator iter_end{};
+    // unescaped token never exceeds its source, and tokens are written without separator,
+    // thus every token is compacted in place, behind the cursor which reads source.
+    std::string_view const src = *io;
+    auto const buf             = io->data();
+    size_t written             = 0;
 
-    for (; iter != iter_end; ++iter)
+    for (size_t at = 0; at < src.size();)
     {
-        auto& match = *iter;
-        if (!match.ready()) { continue; }
-
-        size_t n                = 0, position, length;
+        size_t position, length;
         bool wrapped_with_quote = false;
-        if (match[1].matched)
+
+        if (src[at] == '"'
+            && (length = scan_token(src, at + 1, [](char ch) { return ch != '"'; }),
+                at + 1 + length < src.size() && src[at + 1 + length] == '"'))
         {
-            n                  = 1;
+            position           = at + 1;
             wrapped_with_quote = true;
+            at                 = position + length + 1;
         }
-        else if (match[2].matched)
+        else if ((length = scan_token(src, at, [](char ch) { return not is_space(ch); })) > 0)
         {
-            n                  = 2;
-            wrapped_with_quote = false;
+            position = at;
+            at       = position + length;
         }
         else
         {
-            throw;
+            ++at;
+            continue;
         }
 
-        position = match.position(n), length = match.length(n);
-
         if (token_indexes)
         {
             token_indexes->push_back({position, length, wrapped_with_quote});
         }
 
         // correct escapes
-        std::string str = src.substr(position, length);
-        const static std::regex rg_escape{R"(\\([ \\"']))"};
+        auto const begin = written;
+        for (size_t i = position, end = position + length; i < end; ++i)
+        {
+            bool escaped = src[i] == '\\' && i + 1 < end
+                           && (src[i + 1] == ' ' || src[i + 1] == '\\' || src[i + 1] == '"' || src[i + 1] == '\'');
 
-        auto end = std::regex_replace(str.begin(), str.begin(), str.end(), rg_escape, "$1");
-        str.resize(end - str.begin());
+            buf[written++] = src[i += escaped];
+        }
 
-        tokens.emplace_back(io->c_str() + io->size(), str.size());
-        io->append(str);
+        tokens.emplace_back(buf + begin, written - begin);
     }
+
+    io->resize(written);
 }
 
 bool perfkit::commands::registry::invoke_command(std::string command)
@@ -439,7 +521,7 @@ bool perfkit::commands::registry::remove_invoke_hook(intptr_t id)
 }
 
 std::string perfkit::commands::registry::suggest(
-        std::string line, std::vector<std::string>* candidates)
+        std::string line, std::vector<std::string>* candidates, suggest_page* page)
 {
     using namespace std::literals;
     int position = 0;
@@ -458,7 +540,7 @@ std::string perfkit::commands::registry::suggest(
     auto sharing = rg->suggest(
             tokens, suggests,
             not line.empty() && line.back() == ' ',
-            &target_token, &has_unique_match);
+            &target_token, &has_unique_match, page);
 
     if (not tokens.empty())
     {
@@ -1,8 +1,17 @@
 //
 // Created by Seungwoo on 2021-10-01.
 //
+#include <filesystem>
 #include <fstream>
 #include <list>
+#include <mutex>
+
+#if __unix__
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
 
 #include <range/v3/algorithm/copy.hpp>
 #include <range/v3/range/conversion.hpp>
@@ -70,10 +79,39 @@ class if_state
     state_ptr _child;
 };
 
+// flag bindings are only added, thus table is frozen again only when new binding appears.
+// _flags_lock() must be held while using returned index.
+_configs::perfect_hash_index<config_shared_ptr> const& _flag_index()
+{
+    static _configs::perfect_hash_index<config_shared_ptr> index;
+    static size_t num_indexed = 0;
+
+    if (num_indexed != _flags().size())
+    {
+        std::vector<std::pair<std::string_view, config_shared_ptr>> entries;
+        entries.reserve(_flags().size());
+
+        for (auto& [key, conf] : _flags()) { entries.emplace_back(key, conf); }
+        index.build(std::move(entries));  // on failure, index remains empty and map is used.
+
+        num_indexed = _flags().size();
+    }
+
+    return index;
+}
+
 config_shared_ptr _find_conf(std::string_view name, bool ignore_undefined)
 {
-    auto it = _flags().find(name);
-    if (it != _flags().end()) { return it->second; }
+    std::unique_lock lock{_flags_lock()};
+    if (auto& index = _flag_index(); not index.empty())
+    {
+        if (auto found = index.find(name)) { return *found; }
+    }
+    else if (auto it = _flags().find(name); it != _flags().end())
+    {
+        return it->second;
+    }
+    lock.unlock();
     if (!ignore_undefined) { throw invalid_flag_name{"flag not exist: {}"_fmt % name}; }
     return {};
 }
@@ -109,7 +147,7 @@ class value_parse : public if_state
                 std::string data;
                 data.reserve(2 + tok.size());
                 (R"("{}")"_fmt % tok) > data;
-                _conf->request_modify(nlohmann::json::parse(data.begin(), data.end()));
+                _conf->request_modify(nlohmann::json::parse(data.begin(), data.end()), change_source::flag);
             }
             else if (_conf->default_value().is_array())
             {
@@ -126,11 +164,11 @@ class value_parse : public if_state
                 }
 
                 curvalue.emplace_back(std::move(jsvalue));
-                _conf->request_modify(std::move(curvalue));
+                _conf->request_modify(std::move(curvalue), change_source::flag);
             }
             else
             {
-                _conf->request_modify(nlohmann::json::parse(tok.begin(), tok.end()));
+                _conf->request_modify(nlohmann::json::parse(tok.begin(), tok.end()), change_source::flag);
             }
         }
         catch (nlohmann::json::parse_error& e)
@@ -179,7 +217,7 @@ class single_dash_parse : public if_state
                 throw parse_error("flag {} is not boolean"_fmt % ch);
             }
 
-            conf->request_modify(value);
+            conf->request_modify(value, change_source::flag);
         }
 
         return do_return(true, next);
@@ -200,7 +238,7 @@ class double_dash_parse : public if_state
         bool is_not = tok.find("no-") == 0;
         if (conf->default_value().is_boolean())
         {
-            conf->request_modify(not is_not);
+            conf->request_modify(not is_not, change_source::flag);
             return do_return(true, next);
         }
         else if (is_not)
@@ -243,6 +281,7 @@ class initial_state : public if_state
                 flag_mappings;
 
         std::string str;
+        std::lock_guard _{_flags_lock()};
 
         using namespace ranges;
         str += "\n\nusage: <program> ";
@@ -314,46 +353,107 @@ perfkit::configs::flag_binding_table& perfkit::configs::_flags() noexcept
     return _inst;
 }
 
-bool perfkit::configs::import_file(std::string_view path)
+std::mutex& perfkit::configs::_flags_lock() noexcept
 {
-    std::ifstream fs{std::string{path}};
-    if (not fs.is_open())
-    {
-        CPPH_ERROR("config load failed: file '{}' does not exist", path);
-        return false;
-    }
+    static std::mutex _inst;
+    return _inst;
+}
 
-    try
+namespace perfkit::configs::_io {
+/** Read-only view of whole file. Memory mapped where available. */
+class mapped_file
+{
+   public:
+    explicit mapped_file(std::string const& path)
     {
-        auto js = json::parse(std::istream_iterator<char>{fs}, std::istream_iterator<char>{});
-        if (js.is_object())
-        {
-            return import_from(js);
-        }
-        else
+#if __unix__
+        _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (_fd == -1) { return; }
+
+        struct stat st = {};
+        if (fstat(_fd, &st) == 0 && st.st_size > 0)
         {
-            CPPH_ERROR("config load failed: file '{}' is not a json object!", path);
+            auto ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (ptr != MAP_FAILED)
+            {
+                madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+                _data = static_cast<char const*>(ptr), _size = st.st_size;
+                return;
+            }
         }
+
+        ::close(_fd), _fd = -1;
+#endif
+        // fallback: read whole file at once.
+        std::ifstream fs{path, std::ios::binary};
+        if (not fs.is_open()) { return; }
+
+        _fallback.assign(std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{});
+        _data = _fallback.data(), _size = _fallback.size();
+        _valid = true;
     }
-    catch (json::parse_error& e)
+
+    ~mapped_file()
     {
-        CPPH_ERROR(
-                "config load failed: file '{}' is not valid json: (error at {}) {}",
-                path, e.byte, e.what());
+#if __unix__
+        if (_fd != -1) { munmap(const_cast<char*>(_data), _size), ::close(_fd); }
+#endif
     }
 
-    return false;
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    bool is_open() const noexcept { return _valid || _fd != -1; }
+    auto data() const noexcept { return _data; }
+    auto size() const noexcept { return _size; }
+
+   private:
+    char const* _data = nullptr;
+    size_t _size      = 0;
+    int _fd           = -1;
+    bool _valid       = false;
+    std::string _fallback;
+};
+}  // namespace perfkit::configs::_io
+
+bool perfkit::configs::import_file(std::string_view path, bool changes_only)
+{
+    _io::mapped_file file{std::string{path}};
+    if (not file.is_open())
+    {
+        CPPH_ERROR("config load failed: file '{}' does not exist", path);
+        return false;
+    }
+
+    if (not import_from_memory(file.data(), file.size(), changes_only))
+    {
+        CPPH_ERROR("config load failed: file '{}' is not a valid configuration document!", path);
+        return false;
+    }
+
+    return true;
 }
 
 bool perfkit::configs::export_to(std::string_view path)
 {
-    std::ofstream fs{std::string{path}};
+    std::ofstream fs{std::string{path}, std::ios::binary};
     if (not fs.is_open())
     {
         CPPH_ERROR("config export failed: not valid file path: {}", path);
         return false;
     }
 
-    fs << export_all().dump(2);
+    auto ext = std::filesystem::path{path}.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return char(tolower(c)); });
+
+    std::vector<uint8_t> binary;
+    if (ext == ".msgpack" || ext == ".mpk")
+        json::to_msgpack(export_all(), binary);
+    else if (ext == ".cbor")
+        json::to_cbor(export_all(), binary);
+    else
+        return fs << export_all().dump(2), true;
+
+    fs.write(reinterpret_cast<char const*>(binary.data()), binary.size());
     return true;
 }
@@ -0,0 +1,137 @@
+#include "perfkit/detail/config_file_watcher.hpp"
+
+#include <filesystem>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/common/macros.hxx"
+#include "perfkit/detail/base.hpp"
+#include "perfkit/detail/configs.hpp"
+
+#if __linux__
+#    include <poll.h>
+#    include <sys/eventfd.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit::configs {
+file_watcher::file_watcher(std::string path, std::chrono::milliseconds debounce)
+        : _path(std::move(path)), _debounce(debounce)
+{
+#if __linux__
+    _fd_stop = eventfd(0, EFD_CLOEXEC);
+#endif
+
+    _worker = std::thread{[this] { _worker_fn(); }};
+}
+
+file_watcher::~file_watcher()
+{
+    _active = false;
+
+#if __linux__
+    uint64_t one = 1;
+    _fd_stop != -1 && ::write(_fd_stop, &one, sizeof one);
+#endif
+
+    _worker.joinable() && (_worker.join(), 0);
+
+#if __linux__
+    _fd_stop != -1 && ::close(_fd_stop);
+#endif
+}
+
+void file_watcher::_reload()
+{
+    CPPH_INFO("config file '{}' modified. reloading changes ...", _path);
+
+    if (import_file(_path, true))
+        _num_reloads.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if __linux__
+void file_watcher::_worker_fn()
+{
+    namespace fs = std::filesystem;
+
+    // watch directory instead of the file itself, as many editors replace file on save.
+    auto target = fs::path{_path};
+    auto dir    = target.has_parent_path() ? target.parent_path() : fs::path{"."};
+    auto name   = target.filename().string();
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) == -1)
+    {
+        CPPH_ERROR("failed to watch config file '{}'", _path);
+        fd != -1 && ::close(fd);
+        return;
+    }
+
+    // returns true if any event of target file was read.
+    auto drain = [&] {
+        alignas(inotify_event) char buf[4096];
+        bool matched = false;
+
+        for (ssize_t n; (n = ::read(fd, buf, sizeof buf)) > 0;)
+        {
+            for (char* p = buf; p < buf + n;)
+            {
+                auto ev = reinterpret_cast<inotify_event*>(p);
+                matched |= ev->len && name == ev->name;
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+
+        return matched;
+    };
+
+    pollfd fds[2] = {{fd, POLLIN, 0}, {_fd_stop, POLLIN, 0}};
+    bool pending  = false;
+
+    while (_active)
+    {
+        auto timeout = pending ? int(_debounce.count()) : -1;
+        auto n_ready = poll(fds, 2, timeout);
+
+        if (not _active || (fds[1].revents & POLLIN)) { break; }
+
+        if (n_ready == 0)
+        {  // quiet for debounce period after last modification
+            pending = false;
+            _reload();
+        }
+        else if (n_ready > 0 && (fds[0].revents & POLLIN))
+        {
+            pending |= drain();
+        }
+    }
+
+    ::close(fd);
+}
+#else
+void file_watcher::_worker_fn()
+{
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    auto latest  = fs::last_write_time(_path, ec);
+    bool pending = false;
+
+    while (_active)
+    {
+        std::this_thread::sleep_for(_debounce);
+
+        auto mtime = fs::last_write_time(_path, ec);
+        if (ec) { continue; }
+
+        if (mtime != latest)
+            latest = mtime, pending = true;
+        else if (pending)
+            pending = false, _reload();
+    }
+}
+#endif
+}  // namespace perfkit::configs
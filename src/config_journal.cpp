@@ -0,0 +1,458 @@
+#include "perfkit/detail/config_journal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/detail/base.hpp"
+
+#if __unix__
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit::configs {
+namespace {
+auto _all_journals()
+{
+    static std::vector<journal*> _inst;
+    static std::mutex _lock;
+    return std::make_pair(&_inst, std::unique_lock{_lock});
+}
+
+// lets registry update() skip journaling without taking any lock.
+std::atomic_size_t _num_journals{0};
+
+// orders every applied change which is journaled.
+std::atomic_uint64_t _sequence{0};
+}  // namespace
+
+static void _append_string(std::string* out, std::string_view str)
+{
+    *out += nlohmann::json(str).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+static void _dump_line(journal::record const& rec, std::string* out)
+{
+    using namespace std::chrono;
+    auto ts = duration_cast<microseconds>(rec.timestamp.time_since_epoch()).count();
+
+    *out += R"({"ts":)";
+    *out += std::to_string(ts);
+
+    if (rec.kind == journal::record::snapshot)
+    {
+        *out += R"(,"snapshot":)";
+    }
+    else
+    {
+        *out += R"(,"rg":)", _append_string(out, rec.registry);
+        *out += R"(,"key":)", _append_string(out, rec.key);
+        *out += R"(,"src":")", *out += source_name(rec.source);
+        *out += rec.kind == journal::record::patch ? R"(","patch":)" : R"(","value":)";
+    }
+
+    *out += rec.data.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    *out += "}\n";
+}
+
+static bool _parse_line(std::string_view line, journal::record* out)
+{
+    auto js = nlohmann::json::parse(line.begin(), line.end(), nullptr, false);
+    if (js.is_discarded() || not js.is_object()) { return false; }
+
+    auto it_ts = js.find("ts");
+    if (it_ts == js.end() || not it_ts->is_number_integer()) { return false; }
+
+    auto ts        = std::chrono::microseconds{it_ts->get<int64_t>()};
+    out->timestamp = journal::clock::time_point{
+            std::chrono::duration_cast<journal::clock::duration>(ts)};
+
+    if (auto it = js.find("snapshot"); it != js.end())
+    {
+        out->kind = journal::record::snapshot;
+        out->registry.clear(), out->key.clear();
+        out->data = std::move(*it);
+        return out->data.is_object();
+    }
+
+    auto it_rg  = js.find("rg");
+    auto it_key = js.find("key");
+    if (it_rg == js.end() || not it_rg->is_string()) { return false; }
+    if (it_key == js.end() || not it_key->is_string()) { return false; }
+
+    out->registry = it_rg->get_ref<std::string const&>();
+    out->key      = it_key->get_ref<std::string const&>();
+
+    out->source = change_source::api;
+    if (auto it = js.find("src"); it != js.end() && it->is_string())
+        parse_source_name(it->get_ref<std::string const&>(), &out->source);
+
+    if (auto it = js.find("value"); it != js.end())
+        out->kind = journal::record::value, out->data = std::move(*it);
+    else if (auto it = js.find("patch"); it != js.end() && it->is_array())
+        out->kind = journal::record::patch, out->data = std::move(*it);
+    else
+        return false;
+
+    return true;
+}
+
+static bool _sync(std::FILE* fp) noexcept
+{
+    if (std::fflush(fp) != 0) { return false; }
+
+#if __unix__
+    return ::fsync(::fileno(fp)) == 0;
+#else
+    return true;
+#endif
+}
+
+journal::journal(std::string path, options opts)
+        : _path(std::move(path)), _opts(opts) {}
+
+auto journal::open(std::string path, options opts) -> std::shared_ptr<journal>
+{
+    std::shared_ptr<journal> ptr{new journal{std::move(path), opts}};
+    if (not ptr->_open_file()) { return nullptr; }
+
+    // new journal starts with snapshot, thus it can be replayed by itself.
+    std::error_code ec;
+    if (std::filesystem::file_size(ptr->_path, ec) == 0 && not ptr->_write_snapshot())
+        return nullptr;
+
+    ptr->_worker = std::thread{&journal::_worker_fn, ptr.get()};
+
+    auto [all, _] = _all_journals();
+    all->push_back(ptr.get());
+    _num_journals.store(all->size(), std::memory_order_release);
+
+    return ptr;
+}
+
+journal::~journal() noexcept
+{
+    {
+        auto [all, _] = _all_journals();
+        all->erase(std::remove(all->begin(), all->end(), this), all->end());
+        _num_journals.store(all->size(), std::memory_order_release);
+    }
+
+    {
+        std::lock_guard _{_mtx};
+        _stop = true;
+    }
+
+    _cvar.notify_all();
+    _worker.joinable() && (_worker.join(), 0);
+    _file && std::fclose(_file);
+}
+
+bool journal::read(std::string_view path, std::function<void(record&)> const& visit)
+{
+    std::ifstream fs{std::string{path}, std::ios::binary};
+    if (not fs.is_open())
+    {
+        CPPH_ERROR("config journal read failed: not valid file path: {}", path);
+        return false;
+    }
+
+    std::string line;
+    record rec;
+
+    for (size_t line_no = 1; std::getline(fs, line); ++line_no)
+    {
+        if (line.empty()) { continue; }
+
+        // mostly a torn record at the end of file, which was being written on crash.
+        if (not _parse_line(line, &rec))
+        {
+            CPPH_WARN("config journal '{}': skipping invalid record at line {}", path, line_no);
+            continue;
+        }
+
+        visit(rec);
+    }
+
+    return true;
+}
+
+bool journal::replay(std::string_view path, std::optional<clock::time_point> until)
+{
+    std::optional<nlohmann::json> doc;
+    size_t num_replayed = 0;
+    bool too_old        = false;
+
+    auto fn_visit = [&](record& rec) {
+        if (until && rec.timestamp > *until)
+        {
+            // compacted journal can't reproduce configurations before its snapshot.
+            too_old |= rec.kind == record::snapshot && not doc;
+            return;
+        }
+
+        if (rec.kind == record::snapshot)
+        {
+            doc = std::move(rec.data);
+            return;
+        }
+
+        // journal which doesn't start with snapshot is applied on current configurations.
+        doc || (doc = export_all(), 0);
+
+        auto& category = (*doc)[rec.registry];
+        if (category.is_null()) { category = nlohmann::json::object(); }
+        if (not category.is_object()) { return; }
+
+        auto& value = category[rec.key];
+        if (rec.kind == record::value)
+            value = std::move(rec.data);
+        else if (not _configs::apply_patch(&value, rec.data))
+            return CPPH_WARN("config journal '{}': failed to apply patch of '{}'", path, rec.key);
+
+        ++num_replayed;
+    };
+
+    if (not read(path, fn_visit)) { return false; }
+
+    if (too_old)
+        return CPPH_ERROR("config journal '{}': given time precedes its snapshot", path), false;
+
+    if (not doc) { return true; }  // empty journal
+
+    CPPH_INFO("config journal '{}': replaying {} changes", path, num_replayed);
+    return import_from(*doc, change_source::replay);
+}
+
+void journal::flush()
+{
+    _request(false);
+}
+
+void journal::compact()
+{
+    _request(true);
+}
+
+size_t journal::num_records() const noexcept
+{
+    std::lock_guard _{_mtx};
+    return _num_records;
+}
+
+void journal::_bk_record(array_view<detail::config_base* const> changed)
+{
+    if (_num_journals.load(std::memory_order_acquire) == 0) { return; }
+
+    auto now = clock::now();
+
+    std::vector<record> records;
+    records.reserve(changed.size());
+
+    // sequences are assigned and queued under the same lock, thus records of every registry
+    //  are written in order of sequence.
+    auto [all, _] = _all_journals();
+
+    for (auto conf : changed)
+    {
+        if (not conf->can_export()) { continue; }  // won't be exported either
+
+        auto& rec     = records.emplace_back();
+        rec.timestamp = now;
+        rec.source    = conf->_pending_source;
+        rec.registry  = conf->owner()->name();
+        rec.key       = conf->display_key();
+        rec._config   = conf;
+        rec._sequence = conf->_journal_seq = _sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        // patches applied without rule are recorded as-is, which are mostly much smaller.
+        auto& patches = conf->_patches;
+        if (patches && not patches->log.empty() && patches->log.back().first == conf->_fence_modified)
+        {
+            rec.kind = record::patch;
+            rec.data = patches->log.back().second;
+            continue;
+        }
+
+        // value is captured as applied, as later patch records are based on it.
+        if (auto nmodify = conf->num_modified(); conf->_fence_serialized != nmodify)
+        {
+            conf->_serialize_cache();
+            conf->_fence_serialized = nmodify;
+        }
+
+        rec.data = conf->_cached_serialized;
+    }
+
+    for (auto jr : *all)
+    {
+        {
+            std::lock_guard lc{jr->_mtx};
+            for (auto& rec : records)
+                if (not jr->_is_covered(rec)) { jr->_queue.push_back(rec), ++jr->_num_records; }
+        }
+
+        jr->_cvar.notify_all();
+    }
+}
+
+bool journal::_is_covered(record const& rec) const
+{
+    auto it = _snapshot_fence.find(rec._config);
+    return it != _snapshot_fence.end() && rec._sequence <= it->second;
+}
+
+bool journal::_open_file()
+{
+    _file = std::fopen(_path.c_str(), "ab");
+    if (_file == nullptr)
+    {
+        CPPH_ERROR("config journal open failed: not valid file path: {}", _path);
+        return false;
+    }
+
+    return true;
+}
+
+bool journal::_write_snapshot()
+{
+    record rec;
+    rec.kind      = record::snapshot;
+    rec.timestamp = clock::now();
+    rec.data      = export_all();
+
+    // values of updated registries are read again with their journal sequences under the
+    // same lock, thus records which the snapshot already includes can be told exactly.
+    std::unordered_map<detail::config_base const*, uint64_t> fence;
+    for (auto const& rg : config_registry::bk_enumerate_registries())
+    {
+        if (not rg->_initially_updated()) { continue; }
+
+        auto& category = rec.data[rg->name()];
+        for (auto const& [_, conf] : rg->bk_all())
+        {
+            if (not conf->can_export()) { continue; }
+
+            conf->serialize([&, conf = conf.get()](nlohmann::json const& value) {
+                category[conf->display_key()] = value;
+                fence[conf]                   = conf->_journal_seq;
+            });
+        }
+    }
+
+    std::string line;
+    _dump_line(rec, &line);
+
+    // write snapshot to temporary file, then atomically replace journal with it.
+    auto tmp_path = _path + ".tmp";
+    auto fp       = std::fopen(tmp_path.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        CPPH_ERROR("config journal compaction failed: can't open {}", tmp_path);
+        return false;
+    }
+
+    bool ok = std::fwrite(line.data(), 1, line.size(), fp) == line.size() && _sync(fp);
+    std::fclose(fp);
+
+    std::error_code ec;
+    ok && (std::filesystem::rename(tmp_path, _path, ec), not ec);
+
+    if (not ok)
+    {
+        CPPH_ERROR("config journal compaction failed: can't write {}", tmp_path);
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+
+#if __unix__
+    // make the rename itself durable.
+    auto dir = std::filesystem::path{_path}.parent_path();
+    if (int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_CLOEXEC); fd != -1)
+        ::fsync(fd), ::close(fd);
+#endif
+
+    // previous handle refers to replaced file.
+    std::fclose(_file);
+    if (not _open_file()) { return false; }
+
+    // records queued until now, which the snapshot includes, must not be written after it,
+    // as replaying a patch twice is not idempotent.
+    std::lock_guard _{_mtx};
+    _snapshot_fence = std::move(fence);
+
+    auto it = std::remove_if(_queue.begin(), _queue.end(), [&](auto& queued) { return _is_covered(queued); });
+    _queue.erase(it, _queue.end());
+
+    _num_records = _queue.size();
+    return true;
+}
+
+void journal::_request(bool compact)
+{
+    std::unique_lock lc{_mtx};
+    auto ticket = ++_ticket_issued;
+    compact && (_compact_requested = true);
+
+    _cvar.notify_all();
+    _cvar_done.wait(lc, [&] { return _ticket_served >= ticket; });
+}
+
+void journal::_worker_fn()
+{
+    std::vector<record> records;
+    std::string buffer;
+
+    for (bool stop = false; not stop;)
+    {
+        uint64_t ticket;
+        bool compact;
+
+        {
+            std::unique_lock lc{_mtx};
+            auto fn_requested = [&] { return _stop || _ticket_issued != _ticket_served; };
+
+            _cvar.wait(lc, [&] { return fn_requested() || not _queue.empty(); });
+
+            // gather records for a while to fsync them at once, unless explicitly requested.
+            _cvar.wait_for(lc, _opts.fsync_interval, fn_requested);
+
+            records.swap(_queue);
+            ticket  = _ticket_issued;
+            compact = std::exchange(_compact_requested, false)
+                   || _num_records >= _opts.compact_threshold;
+            stop    = _stop;
+        }
+
+        buffer.clear();
+        for (auto& rec : records) { _dump_line(rec, &buffer); }
+        records.clear();
+
+        if (_file && not buffer.empty())
+        {
+            bool ok = std::fwrite(buffer.data(), 1, buffer.size(), _file) == buffer.size();
+            if (not ok || not _sync(_file))
+                CPPH_ERROR("config journal '{}': failed to write records", _path);
+        }
+
+        if (compact && _file)
+        {
+            CPPH_DEBUG("config journal '{}': compacting ...", _path);
+            _write_snapshot();
+        }
+
+        {
+            std::lock_guard _{_mtx};
+            _ticket_served = ticket;
+        }
+
+        _cvar_done.notify_all();
+    }
+}
+}  // namespace perfkit::configs
@@ -0,0 +1,185 @@
+#include "perfkit/detail/config_patch.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace perfkit::_configs {
+static bool _parse_kind(std::string_view name, patch_op::kind_t* out) noexcept
+{
+    static constexpr std::pair<std::string_view, patch_op::kind_t> table[] = {
+            {"replace", patch_op::replace},
+            {"add", patch_op::add},
+            {"remove", patch_op::remove},
+            {"replace_range", patch_op::replace_range},
+            {"remove_range", patch_op::remove_range},
+    };
+
+    for (auto& [key, kind] : table)
+        if (key == name) { return *out = kind, true; }
+
+    return false;
+}
+
+static std::string _unescape(std::string_view token)
+{
+    std::string out;
+    out.reserve(token.size());
+
+    for (size_t i = 0; i < token.size(); ++i)
+    {
+        if (token[i] == '~' && i + 1 < token.size())
+        {
+            if (token[i + 1] == '0') { out += '~', ++i; continue; }
+            if (token[i + 1] == '1') { out += '/', ++i; continue; }
+        }
+
+        out += token[i];
+    }
+
+    return out;
+}
+
+bool parse_patch(nlohmann::json const& ops, std::vector<patch_op>* out)
+{
+    out->clear();
+    if (not ops.is_array()) { return false; }
+
+    out->reserve(ops.size());
+    for (auto& op : ops)
+    {
+        if (not op.is_object()) { return false; }
+
+        auto it_op   = op.find("op");
+        auto it_path = op.find("path");
+        if (it_op == op.end() || not it_op->is_string()) { return false; }
+        if (it_path == op.end() || not it_path->is_string()) { return false; }
+
+        auto& dst = out->emplace_back();
+        if (not _parse_kind(it_op->get_ref<std::string const&>(), &dst.kind)) { return false; }
+
+        dst.path = it_path->get_ref<std::string const&>();
+        if (not dst.path.empty() && dst.path[0] != '/') { return false; }
+
+        dst.depth = std::count(dst.path.begin(), dst.path.end(), '/');
+        dst.token = _unescape(dst.path.substr(dst.path.find_last_of('/') + 1));
+
+        switch (dst.kind)
+        {
+            case patch_op::replace:
+            case patch_op::add:
+            case patch_op::replace_range:
+                if (auto it = op.find("value"); it != op.end())
+                    dst.value = &*it;
+                else
+                    return false;
+                break;
+
+            case patch_op::remove_range:
+                if (auto it = op.find("count"); it != op.end() && it->is_number_integer() && *it >= 0)
+                    dst.count = it->get<size_t>();
+                else
+                    return false;
+                break;
+
+            case patch_op::remove:
+                break;
+        }
+
+        // only replacing whole document is allowed on root.
+        if (dst.depth == 0 && dst.kind != patch_op::replace) { return false; }
+    }
+
+    return true;
+}
+
+bool is_shallow(std::vector<patch_op> const& ops) noexcept
+{
+    return std::all_of(ops.begin(), ops.end(), [](auto& op) { return op.depth == 1; });
+}
+
+bool parse_index(std::string_view token, size_t size, size_t* out) noexcept
+{
+    if (token == "-") { return *out = size, true; }
+    if (token.empty() || (token.size() > 1 && token[0] == '0')) { return false; }
+
+    auto end = token.data() + token.size();
+    auto r   = std::from_chars(token.data(), end, *out);
+    return r.ec == std::errc{} && r.ptr == end;
+}
+
+bool apply_patch(nlohmann::json* target, nlohmann::json const& ops)
+{
+    std::vector<patch_op> parsed;
+    if (not parse_patch(ops, &parsed)) { return false; }
+
+    try
+    {
+        for (auto& op : parsed)
+        {
+            if (op.depth == 0)
+            {
+                *target = *op.value;
+                continue;
+            }
+
+            auto parent_path = std::string{op.path.substr(0, op.path.find_last_of('/'))};
+            auto& parent     = target->at(nlohmann::json::json_pointer{parent_path});
+
+            if (parent.is_array())
+            {
+                size_t index;
+                if (not parse_index(op.token, parent.size(), &index)) { return false; }
+
+                switch (op.kind)
+                {
+                    case patch_op::replace:
+                        if (index >= parent.size()) { return false; }
+                        parent[index] = *op.value;
+                        break;
+
+                    case patch_op::add:
+                        if (index > parent.size()) { return false; }
+                        parent.insert(parent.begin() + index, *op.value);
+                        break;
+
+                    case patch_op::remove:
+                        if (index >= parent.size()) { return false; }
+                        parent.erase(index);
+                        break;
+
+                    case patch_op::replace_range:
+                        if (not op.value->is_array()) { return false; }
+                        if (index > parent.size() || op.value->size() > parent.size() - index) { return false; }
+                        for (size_t k = 0; k < op.value->size(); ++k) { parent[index + k] = (*op.value)[k]; }
+                        break;
+
+                    case patch_op::remove_range:
+                        if (index > parent.size() || op.count > parent.size() - index) { return false; }
+                        parent.erase(parent.begin() + index, parent.begin() + index + op.count);
+                        break;
+                }
+            }
+            else if (parent.is_object())
+            {
+                switch (op.kind)
+                {
+                    case patch_op::replace:
+                    case patch_op::add: parent[op.token] = *op.value; break;
+                    case patch_op::remove: parent.erase(op.token); break;
+                    default: return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+    catch (nlohmann::json::exception&)
+    {
+        return false;
+    }
+
+    return true;
+}
+}  // namespace perfkit::_configs
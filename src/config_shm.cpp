@@ -0,0 +1,541 @@
+#include "perfkit/detail/config_shm.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/detail/base.hpp"
+
+#if __unix__
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit::configs {
+namespace {
+auto _all_tables()
+{
+    static std::vector<shared_table*> _inst;
+    static std::mutex _lock;
+    return std::make_pair(&_inst, std::unique_lock{_lock});
+}
+
+// lets registry update() skip shared tables without taking any lock.
+std::atomic_size_t _num_tables{0};
+
+constexpr uint64_t _magic          = 0x31'46'43'4d'48'53'4b'50;  // "PKSHMCF1"
+constexpr uint32_t _layout_version = 3;
+constexpr size_t _alignment        = 64;
+
+constexpr size_t _align(size_t n) { return (n + _alignment - 1) / _alignment * _alignment; }
+constexpr size_t _num_words(size_t n) { return (n + sizeof(uint64_t) - 1) / sizeof(uint64_t); }
+
+// payload is copied as relaxed atomic words, thus copy torn by concurrent writer is detected
+// by entry's sequence without any data race, as seqlock_cell does.
+void _store_words(std::atomic_uint64_t* words, void const* src, size_t size) noexcept
+{
+    auto bytes = static_cast<char const*>(src);
+    for (size_t i = 0; i < _num_words(size); ++i)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i * sizeof word, std::min(sizeof word, size - i * sizeof word));
+        words[i].store(word, std::memory_order_relaxed);
+    }
+}
+
+void _load_words(std::atomic_uint64_t const* words, void* dst, size_t size) noexcept
+{
+    auto bytes = static_cast<char*>(dst);
+    for (size_t i = 0; i < _num_words(size); ++i)
+    {
+        auto word = words[i].load(std::memory_order_relaxed);
+        std::memcpy(bytes + i * sizeof word, &word, std::min(sizeof word, size - i * sizeof word));
+    }
+}
+}  // namespace
+
+struct shared_table::_header
+{
+    uint64_t magic;
+    uint32_t layout_version;
+    uint32_t num_entries;
+    uint64_t schema_hash;
+    uint32_t entry_size;
+    uint32_t value_capacity;
+    uint32_t keys_offset;
+    uint32_t keys_size;
+
+    // set by creator once every entry is initialized.
+    std::atomic_uint32_t ready;
+
+    // incremented on every write, thus readers skip scanning entries if unchanged.
+    alignas(_alignment) std::atomic_uint64_t generation;
+};
+
+struct alignas(sizeof(uint64_t)) shared_table::_entry
+{
+    // sequence lock. odd while being written, zero if never written.
+    std::atomic_uint32_t seq;
+
+    uint8_t type;  // index of typed_value, or zero if not shared
+    uint8_t _reserved[3];
+
+    uint32_t key_offset;
+    uint32_t key_size;
+    std::atomic_uint32_t size;  // bytes of value
+
+    // value words follow the entry.
+    auto words() noexcept { return reinterpret_cast<std::atomic_uint64_t*>(this + 1); }
+    auto words() const noexcept { return reinterpret_cast<std::atomic_uint64_t const*>(this + 1); }
+};
+
+static_assert(std::atomic_uint32_t::is_always_lock_free && std::atomic_uint64_t::is_always_lock_free,
+              "atomics in shared memory must be lock free");
+
+static auto _to_typed(nlohmann::json const& js) -> shared_table::typed_value
+{
+    switch (js.type())
+    {
+        case nlohmann::json::value_t::boolean: return js.get<bool>();
+        case nlohmann::json::value_t::number_integer: return js.get<int64_t>();
+        case nlohmann::json::value_t::number_unsigned: return js.get<uint64_t>();
+        case nlohmann::json::value_t::number_float: return js.get<double>();
+        case nlohmann::json::value_t::string: return js.get<std::string>();
+        default: return {};
+    }
+}
+
+shared_table::shared_table(std::string name, options opts)
+        : _name(std::move(name)), _opts(opts)
+{
+}
+
+shared_table::~shared_table() noexcept
+{
+    if (_registry)
+    {
+        auto [all, _] = _all_tables();
+        all->erase(std::find(all->begin(), all->end(), this));
+        _num_tables.fetch_sub(1, std::memory_order_release);
+    }
+
+#if __unix__
+    _base && ::munmap(_base, _size);
+#endif
+}
+
+auto shared_table::_header_ptr() const noexcept -> _header*
+{
+    return static_cast<_header*>(_base);
+}
+
+auto shared_table::_entry_at(size_t index) const noexcept -> _entry*
+{
+    auto hdr = _header_ptr();
+    auto ptr = static_cast<char*>(_base) + _align(sizeof(_header)) + index * hdr->entry_size;
+    return reinterpret_cast<_entry*>(ptr);
+}
+
+std::string_view shared_table::_key_of(_entry const* entry) const noexcept
+{
+    auto keys = static_cast<char const*>(_base) + _header_ptr()->keys_offset;
+    return {keys + entry->key_offset, entry->key_size};
+}
+
+auto shared_table::_find(std::string_view full_key) const noexcept -> _entry*
+{
+    for (size_t i = 0; i < _header_ptr()->num_entries; ++i)
+        if (auto entry = _entry_at(i); _key_of(entry) == full_key) { return entry; }
+
+    return nullptr;
+}
+
+uint64_t shared_table::schema_hash() const noexcept
+{
+    return _header_ptr()->schema_hash;
+}
+
+bool shared_table::_write(_entry* entry, typed_value const& value, uint32_t* out_seq)
+{
+    if (entry->type == 0 || value.index() != entry->type) { return false; }
+
+    auto str = std::get_if<std::string>(&value);
+    if (str && str->size() > _header_ptr()->value_capacity) { return false; }
+
+    // acquire entry by making its sequence odd. spins only while another writer writes
+    // the same entry, which never takes long unless the writer died in the middle.
+    auto seq = entry->seq.load(std::memory_order_relaxed);
+    for (size_t spin = 0;; ++spin)
+    {
+        if (spin == 1 << 20)
+            return CPPH_ERROR("shared table '{}': entry '{}' is locked", _name, _key_of(entry)), false;
+
+        if (seq & 1)
+            std::this_thread::yield(), seq = entry->seq.load(std::memory_order_relaxed);
+        else if (entry->seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+            break;
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t size = 0;
+    std::visit(
+            [&](auto&& v) {
+                using value_t = std::decay_t<decltype(v)>;
+
+                if constexpr (std::is_same_v<value_t, std::string>)
+                    _store_words(entry->words(), v.data(), size = uint32_t(v.size()));
+                else if constexpr (not std::is_same_v<value_t, std::monostate>)
+                    _store_words(entry->words(), &v, size = sizeof v);
+            },
+            value);
+
+    entry->size.store(size, std::memory_order_relaxed);
+
+    entry->seq.store(seq + 2, std::memory_order_release);
+    _header_ptr()->generation.fetch_add(1, std::memory_order_release);
+
+    *out_seq = seq + 2;
+    return true;
+}
+
+bool shared_table::_read(_entry const* entry, typed_value* out, uint32_t* out_seq) const
+{
+    char buf[sizeof(int64_t)];
+    std::string str;
+
+    for (size_t retry = 0; retry < 64; ++retry)
+    {
+        auto seq = entry->seq.load(std::memory_order_acquire);
+        if (seq == 0) { return false; }
+        if (seq & 1) { std::this_thread::yield(); continue; }
+
+        // value can be torn by concurrent writer, which is detected by sequence below.
+        auto size = std::min<uint32_t>(entry->size.load(std::memory_order_relaxed), _header_ptr()->value_capacity);
+        if (entry->type == 4)
+            str.resize(size), _load_words(entry->words(), str.data(), size);
+        else
+            _load_words(entry->words(), buf, sizeof buf);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry->seq.load(std::memory_order_relaxed) != seq) { continue; }
+
+        switch (entry->type)
+        {
+            case 1: *out = bool(buf[0]); break;
+            case 2: *out = int64_t{}, std::memcpy(&std::get<int64_t>(*out), buf, sizeof(int64_t)); break;
+            case 3: *out = double{}, std::memcpy(&std::get<double>(*out), buf, sizeof(double)); break;
+            case 4: *out = std::move(str); break;
+            case 5: *out = uint64_t{}, std::memcpy(&std::get<uint64_t>(*out), buf, sizeof(uint64_t)); break;
+            default: return false;
+        }
+
+        *out_seq = seq;
+        return true;
+    }
+
+    return false;
+}
+
+bool shared_table::store(std::string_view full_key, typed_value const& value)
+{
+    auto entry = _find(full_key);
+    if (entry == nullptr) { return false; }
+
+    uint32_t seq;
+    return _write(entry, value, &seq);
+}
+
+auto shared_table::load(std::string_view full_key) const -> std::optional<typed_value>
+{
+    auto entry = _find(full_key);
+    if (entry == nullptr) { return {}; }
+
+    typed_value value;
+    uint32_t seq;
+    return _read(entry, &value, &seq) ? std::optional{std::move(value)} : std::nullopt;
+}
+
+std::vector<std::string_view> shared_table::keys() const
+{
+    std::vector<std::string_view> out;
+    for (size_t i = 0; i < _header_ptr()->num_entries; ++i)
+        if (auto entry = _entry_at(i); entry->type != 0) { out.push_back(_key_of(entry)); }
+
+    return out;
+}
+
+#if __unix__
+bool shared_table::_map(bool create, std::vector<detail::config_base*> const* layout, uint64_t schema_hash)
+{
+    int fd = -1;
+
+    if (create)
+    {
+        size_t keys_size = 0;
+        for (auto conf : *layout) { keys_size += conf->full_key().size(); }
+
+        auto num_words   = _num_words(std::max(_opts.value_capacity, sizeof(int64_t)));
+        auto entry_size  = _align(sizeof(_entry) + num_words * sizeof(uint64_t));
+        auto keys_offset = _align(sizeof(_header)) + layout->size() * entry_size;
+        _size            = keys_offset + keys_size;
+
+        fd = ::shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, mode_t(_opts.mode));
+        if (fd < 0) { return false; }
+
+        if (::ftruncate(fd, _size) != 0)
+        {
+            CPPH_ERROR("shared table '{}': ftruncate failed: {}", _name, strerror(errno));
+            return ::close(fd), ::shm_unlink(_name.c_str()), false;
+        }
+
+        _base = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (_base == MAP_FAILED) { return _base = nullptr, ::shm_unlink(_name.c_str()), false; }
+
+        auto hdr            = new (_base) _header{};
+        hdr->magic          = _magic;
+        hdr->layout_version = _layout_version;
+        hdr->num_entries    = uint32_t(layout->size());
+        hdr->schema_hash    = schema_hash;
+        hdr->entry_size     = uint32_t(entry_size);
+        hdr->value_capacity = uint32_t(_opts.value_capacity);
+        hdr->keys_offset    = uint32_t(keys_offset);
+        hdr->keys_size      = uint32_t(keys_size);
+
+        auto keys = static_cast<char*>(_base) + keys_offset;
+        for (size_t i = 0, offset = 0; i < layout->size(); ++i)
+        {
+            auto& key  = (*layout)[i]->full_key();
+            auto entry = new (_entry_at(i)) _entry{};
+            for (size_t j = 0; j < num_words; ++j) { new (entry->words() + j) std::atomic_uint64_t{0}; }
+
+            entry->key_offset = uint32_t(offset);
+            entry->key_size   = uint32_t(key.size());
+            std::memcpy(keys + offset, key.data(), key.size());
+            offset += key.size();
+        }
+
+        return true;
+    }
+
+    fd = ::shm_open(_name.c_str(), O_RDWR, 0);
+    if (fd < 0) { return CPPH_ERROR("shared table '{}': {}", _name, strerror(errno)), false; }
+
+    // creator may not have sized, or initialized the segment yet.
+    auto until = std::chrono::steady_clock::now() + _opts.open_timeout;
+    for (struct stat st;; std::this_thread::sleep_for(std::chrono::milliseconds{1}))
+    {
+        if (std::chrono::steady_clock::now() > until)
+            return CPPH_ERROR("shared table '{}': timeout waiting for creator", _name), ::close(fd), false;
+
+        if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(_header)) { continue; }
+
+        if (_base == nullptr)
+        {
+            _size = st.st_size;
+            _base = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (_base == MAP_FAILED) { return _base = nullptr, ::close(fd), false; }
+        }
+
+        if (_header_ptr()->ready.load(std::memory_order_acquire)) { break; }
+    }
+
+    ::close(fd);
+
+    auto hdr = _header_ptr();
+    if (hdr->magic != _magic || hdr->layout_version != _layout_version)
+        return CPPH_ERROR("shared table '{}': incompatible segment", _name), false;
+
+    // every offset is validated before any entry is touched, as segment may be written by
+    //  anyone who can open it. computed in 64 bits, thus never overflows.
+    uint64_t entries_end = _align(sizeof(_header)) + uint64_t{hdr->num_entries} * hdr->entry_size;
+    uint64_t value_end   = sizeof(_entry) + _num_words(std::max<size_t>(hdr->value_capacity, sizeof(int64_t))) * sizeof(uint64_t);
+
+    bool valid = hdr->entry_size % alignof(_entry) == 0
+              && value_end <= hdr->entry_size
+              && entries_end <= hdr->keys_offset
+              && uint64_t{hdr->keys_offset} + hdr->keys_size <= _size;
+
+    for (size_t i = 0; valid && i < hdr->num_entries; ++i)
+    {
+        auto entry = _entry_at(i);
+        valid      = uint64_t{entry->key_offset} + entry->key_size <= hdr->keys_size
+                  && entry->type < std::variant_size_v<typed_value>;
+    }
+
+    if (not valid)
+        return CPPH_ERROR("shared table '{}': malformed segment", _name), false;
+
+    return true;
+}
+
+bool shared_table::remove(std::string_view name)
+{
+    return ::shm_unlink(std::string{name}.c_str()) == 0;
+}
+#else
+bool shared_table::_map(bool, std::vector<detail::config_base*> const*, uint64_t)
+{
+    return CPPH_ERROR("shared table is not supported on this platform"), false;
+}
+
+bool shared_table::remove(std::string_view)
+{
+    return false;
+}
+#endif
+
+auto shared_table::open(std::shared_ptr<config_registry> rg, std::string name, options opts)
+        -> std::shared_ptr<shared_table>
+{
+    if (not rg || not rg->_initially_updated())
+        return CPPH_ERROR("shared table '{}': registry must be updated once before", name), nullptr;
+
+    // registry is bound only once the table is registered, thus a table which failed to
+    // open is never looked up, nor unregistered on destruction.
+    std::shared_ptr<shared_table> self{new shared_table{std::move(name), opts}};
+
+    std::vector<detail::config_base*> layout(rg->bk_all().size());
+    for (auto& [_, conf] : rg->bk_all()) { layout[conf->dense_index()] = conf.get(); }
+
+    bool created = self->_map(true, &layout, rg->bk_schema_hash().value);
+    if (not created && not self->_map(false, nullptr)) { return nullptr; }
+
+    auto hdr = self->_header_ptr();
+    if (hdr->schema_hash != rg->bk_schema_hash().value || hdr->num_entries != layout.size())
+    {
+        CPPH_ERROR("shared table '{}': schema of registry '{}' mismatches", self->_name, rg->name());
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        if (self->_key_of(self->_entry_at(i)) == layout[i]->full_key()) { continue; }
+
+        CPPH_ERROR("shared table '{}': layout of registry '{}' mismatches", self->_name, rg->name());
+        return nullptr;
+    }
+
+    self->_seen.assign(layout.size(), 0);
+    self->_bound = std::move(layout);
+
+    if (created)
+    {
+        // current values are written before other processes can see the segment.
+        for (size_t i = 0; i < self->_bound.size(); ++i)
+        {
+            auto conf  = self->_bound[i];
+            auto value = _to_typed(conf->serialize());
+            if (not conf->can_update_typed() || value.index() == 0) { continue; }
+
+            auto entry  = self->_entry_at(i);
+            entry->type = uint8_t(value.index());
+
+            if (not self->_write(entry, value, &self->_seen[i]))
+                CPPH_WARN("shared table '{}': value of '{}' exceeds capacity", self->_name, conf->display_key());
+        }
+
+        self->_generation = hdr->generation.load();
+        hdr->ready.store(1, std::memory_order_release);
+    }
+
+    {
+        auto [all, _] = _all_tables();
+        auto it       = std::find_if(all->begin(), all->end(), [&](auto p) { return p->_registry == rg.get(); });
+        if (it != all->end())
+            return CPPH_ERROR("registry '{}' is already bound to shared table '{}'", rg->name(), (*it)->_name), nullptr;
+
+        self->_registry = rg.get();
+        all->push_back(self.get());
+        _num_tables.fetch_add(1, std::memory_order_release);
+    }
+
+    CPPH_INFO("shared table '{}' {} for registry '{}': {} entries",
+              self->_name, created ? "created" : "opened", rg->name(), self->_bound.size());
+
+    return self;
+}
+
+auto shared_table::open(std::string name, options opts) -> std::shared_ptr<shared_table>
+{
+    std::shared_ptr<shared_table> self{new shared_table{std::move(name), opts}};
+    return self->_map(false, nullptr) ? self : nullptr;
+}
+
+void shared_table::_bk_pull(config_registry* rg)
+{
+    if (_num_tables.load(std::memory_order_acquire) == 0) { return; }
+
+    std::vector<std::pair<detail::config_base*, typed_value>> changes;
+    {
+        auto [all, _] = _all_tables();
+        auto it       = std::find_if(all->begin(), all->end(), [&](auto p) { return p->_registry == rg; });
+        if (it == all->end()) { return; }
+
+        auto self = *it;
+        std::lock_guard lc{self->_mtx};
+
+        auto generation = self->_header_ptr()->generation.load(std::memory_order_acquire);
+        if (generation == self->_generation) { return; }
+
+        self->_generation = generation;
+        for (size_t i = 0; i < self->_bound.size(); ++i)
+        {
+            auto entry = self->_entry_at(i);
+            if (entry->type == 0) { continue; }
+
+            auto seq = entry->seq.load(std::memory_order_relaxed);
+            if (seq == self->_seen[i]) { continue; }
+
+            typed_value value;
+            if (self->_read(entry, &value, &seq))
+                self->_seen[i] = seq, changes.emplace_back(self->_bound[i], std::move(value));
+            else
+                self->_generation = 0;  // retry on next update
+        }
+    }
+
+    for (auto& [conf, value] : changes)
+        rg->bk_queue_update_typed(conf->full_key(), std::move(value), change_source::shared);
+}
+
+void shared_table::_bk_push(config_registry const* rg, array_view<detail::config_base* const> changed)
+{
+    if (_num_tables.load(std::memory_order_acquire) == 0) { return; }
+
+    auto [all, _] = _all_tables();
+    auto it       = std::find_if(all->begin(), all->end(), [&](auto p) { return p->_registry == rg; });
+    if (it == all->end()) { return; }
+
+    auto self = *it;
+    std::lock_guard lc{self->_mtx};
+
+    for (auto conf : changed)
+    {
+        if (conf->_pending_source == change_source::shared) { continue; }  // don't echo
+
+        auto index = conf->_dense_index;
+        auto entry = self->_entry_at(index);
+        if (entry->type == 0) { continue; }
+
+        if (auto fence = conf->_fence_modified.load(); conf->_fence_serialized != fence)
+        {
+            conf->_serialize_cache();
+            conf->_fence_serialized = fence;
+        }
+
+        if (not self->_write(entry, _to_typed(conf->_cached_serialized), &self->_seen[index]))
+            CPPH_WARN("shared table '{}': couldn't share '{}'", self->_name, conf->display_key());
+    }
+}
+}  // namespace perfkit::configs
@@ -0,0 +1,30 @@
+#include "perfkit/detail/config_snapshot.hpp"
+
+#include <algorithm>
+
+#include "perfkit/detail/configs.hpp"
+
+namespace perfkit::configs {
+group::group(std::vector<uint32_t> members, snapshot_ptr init)
+        : _members(std::move(members)),
+          _cell(std::move(init))
+{
+}
+
+auto group::create(std::shared_ptr<config_registry> rg, std::vector<uint32_t> dense_indices)
+        -> std::shared_ptr<group>
+{
+    std::sort(dense_indices.begin(), dense_indices.end());
+    dense_indices.erase(std::unique(dense_indices.begin(), dense_indices.end()), dense_indices.end());
+
+    auto grp = std::make_shared<group>(std::move(dense_indices), rg->snapshot());
+    rg->_add_group(grp);
+
+    return grp;
+}
+
+bool group::_contains(uint32_t dense_index) const noexcept
+{
+    return std::binary_search(_members.begin(), _members.end(), dense_index);
+}
+}  // namespace perfkit::configs
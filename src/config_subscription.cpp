@@ -0,0 +1,186 @@
+#include "perfkit/detail/config_subscription.hpp"
+
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/common/macros.hxx"
+#include "perfkit/detail/base.hpp"
+
+#if __linux__
+#    include <sys/eventfd.h>
+#    include <unistd.h>
+#endif
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit::configs {
+namespace {
+auto _all_subscriptions()
+{
+    static std::vector<std::weak_ptr<subscription>> _inst;
+    static std::mutex _lock;
+    return std::make_pair(&_inst, std::unique_lock{_lock});
+}
+}  // namespace
+
+subscription::subscription()
+{
+#if __linux__
+    _fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_fd == -1) { CPPH_ERROR("failed to create eventfd for config subscription"); }
+#endif
+}
+
+subscription::~subscription() noexcept
+{
+#if __linux__
+    _fd != -1 && ::close(_fd);
+#endif
+}
+
+auto subscription::create() -> std::shared_ptr<subscription>
+{
+    std::shared_ptr<subscription> ptr{new subscription};
+
+    auto [all, _] = _all_subscriptions();
+    all->erase(std::remove_if(all->begin(), all->end(), [](auto&& w) { return w.expired(); }),
+               all->end());
+    all->push_back(ptr);
+
+    return ptr;
+}
+
+void subscription::watch(detail::config_base const* conf)
+{
+    std::lock_guard _{_mtx};
+    _keys.insert(conf);
+}
+
+void subscription::watch(config_registry const* rg)
+{
+    std::lock_guard _{_mtx};
+    _registries.insert(rg);
+}
+
+void subscription::watch_prefix(std::string_view display_key_prefix, config_registry const* rg)
+{
+    std::lock_guard _{_mtx};
+    _prefixes.push_back({std::string{display_key_prefix}, rg});
+}
+
+size_t subscription::consume(std::vector<config_shared_ptr>* out)
+{
+    std::lock_guard _{_mtx};
+
+    auto n = _pending.size();
+    out->insert(out->end(),
+                std::make_move_iterator(_pending.begin()),
+                std::make_move_iterator(_pending.end()));
+
+    _pending.clear();
+    _pending_set.clear();
+    _signaled = false;
+
+    // descriptor of closed subscription stays readable, to wake up every poller.
+    if (not _closed) { _reset_fd(); }
+
+    return n;
+}
+
+bool subscription::wait()
+{
+    std::unique_lock lc{_mtx};
+    _cvar.wait(lc, [&] { return _signaled || _closed; });
+
+    _signaled = false;
+    return not _closed;
+}
+
+bool subscription::wait_for(std::chrono::milliseconds timeout)
+{
+    std::unique_lock lc{_mtx};
+    if (not _cvar.wait_for(lc, timeout, [&] { return _signaled || _closed; }))
+        return false;
+
+    _signaled = false;
+    return not _closed;
+}
+
+void subscription::close()
+{
+    std::lock_guard _{_mtx};
+    if (_closed) { return; }
+
+    _closed = true;
+    _cvar.notify_all();
+
+#if __linux__
+    uint64_t one = 1;
+    _fd != -1 && ::write(_fd, &one, sizeof one);
+#endif
+}
+
+void subscription::_bk_dispatch(config_registry const* rg, array_view<detail::config_base* const> changed)
+{
+    auto [all, _] = _all_subscriptions();
+    if (all->empty()) { return; }
+
+    for (auto& wptr : *all)
+    {
+        auto sub = wptr.lock();
+        if (not sub) { continue; }
+
+        for (auto conf : changed)
+        {
+            if (not sub->_matches(rg, conf)) { continue; }
+
+            // entity table never changes after first update, thus no lock is required here.
+            if (auto& ptr = rg->bk_find(conf->full_key()))
+                sub->_push(ptr);
+        }
+    }
+}
+
+bool subscription::_matches(config_registry const* rg, detail::config_base const* conf) const
+{
+    std::lock_guard _{_mtx};
+
+    if (_registries.count(rg) || _keys.count(conf)) { return true; }
+
+    auto& key = conf->display_key();
+    return std::any_of(
+            _prefixes.begin(), _prefixes.end(),
+            [&](_prefix const& p) {
+                return (p.rg == nullptr || p.rg == rg)
+                    && std::string_view{key}.substr(0, p.value.size()) == p.value;
+            });
+}
+
+void subscription::_push(config_shared_ptr const& conf)
+{
+    std::lock_guard _{_mtx};
+    if (not _pending_set.insert(conf.get()).second) { return; }
+
+    _pending.push_back(conf);
+
+    if (not _signaled)
+    {
+        _signaled = true;
+        _cvar.notify_all();
+
+#if __linux__
+        uint64_t one = 1;
+        _fd != -1 && ::write(_fd, &one, sizeof one);
+#endif
+    }
+}
+
+void subscription::_reset_fd() noexcept
+{
+#if __linux__
+    uint64_t value;
+    _fd != -1 && ::read(_fd, &value, sizeof value);
+#endif
+}
+}  // namespace perfkit::configs
@@ -3,9 +3,9 @@
 //
 #include "perfkit/detail/configs.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <condition_variable>
-#include <regex>
 #include <utility>
 
 #include <range/v3/range/conversion.hpp>
@@ -16,6 +16,9 @@
 #include "perfkit/common/format.hxx"
 #include "perfkit/common/hasher.hxx"
 #include "perfkit/common/macros.hxx"
+#include "perfkit/detail/config_journal.hpp"
+#include "perfkit/detail/config_shm.hpp"
+#include "perfkit/detail/config_subscription.hpp"
 #include "perfkit/perfkit.h"
 
 #define CPPH_LOGGER() perfkit::glog()
@@ -27,6 +30,83 @@ auto _all_repos()
     static spinlock _lock;
     return std::make_pair(&_inst, std::unique_lock{_lock});
 }
+
+static void notify_config_update_any();
+
+static bool _is_space(char c) noexcept
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static bool _is_flag_char(char c) noexcept
+{
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9')
+        || c == '_' || c == '-' || c == '.';
+}
+
+/**
+ * Trims whitespaces of each '|' separated token, drops empty ones, then removes order
+ * markers which start with '+' and end before next '|'.
+ */
+std::string _make_display_key(std::string_view full_key)
+{
+    std::string trimmed;
+    trimmed.reserve(full_key.size());
+
+    for (size_t pos = 0; pos <= full_key.size();)
+    {
+        auto end = std::min(full_key.find('|', pos), full_key.size());
+        auto beg = pos;
+        pos      = end + 1;
+
+        while (beg < end && _is_space(full_key[beg])) { ++beg; }
+        while (end > beg && _is_space(full_key[end - 1])) { --end; }
+        if (beg == end) { continue; }
+
+        trimmed.empty() || (trimmed += '|', 0);
+        trimmed.append(full_key.data() + beg, end - beg);
+    }
+
+    std::string out;
+    out.reserve(trimmed.size());
+
+    for (size_t pos = 0; pos < trimmed.size();)
+    {
+        if (trimmed[pos] == '+')
+        {
+            // marker consists of '+', at least one non-'|' character, and trailing '|'
+            if (auto delim = trimmed.find('|', pos + 1); delim != std::string::npos && delim > pos + 1)
+            {
+                pos = delim + 1;
+                continue;
+            }
+        }
+
+        out += trimmed[pos++];
+    }
+
+    return out;
+}
+
+/**
+ * Flag name must not start with '-' nor 'no-'. Names starting with 'N' require at least one
+ * more character. Every character except first one should be one of [A-Za-z0-9_.-]
+ */
+bool _is_valid_flag_name(std::string_view name) noexcept
+{
+    if (name.empty()) { return false; }
+
+    if (name[0] == 'N')
+    {
+        if (name.size() < 2) { return false; }
+    }
+    else if (name[0] == '-' || name.substr(0, 3) == "no-")
+    {
+        return false;
+    }
+
+    return std::all_of(name.begin() + 1, name.end(), _is_flag_char);
+}
 }  // namespace perfkit::detail
 
 // namespace perfkit::detail
@@ -72,8 +152,17 @@ perfkit::config_registry::~config_registry() noexcept
 {
     CPPH_DEBUG("destroying config registry {}", name());
 
-    auto [all, _] = detail::_all_repos();
-    all->erase(all->find(name()));
+    {
+        auto [all, _] = detail::_all_repos();
+        all->erase(all->find(name()));
+    }
+
+    // batches which this registry never applied would never be released otherwise.
+    bool do_notify = false;
+    for (auto& token : _pending_batches) { do_notify |= (--*token == 0); }
+
+    if (do_notify)
+        detail::notify_config_update_any();
 }
 
 auto perfkit::config_registry::bk_enumerate_registries(bool filter_complete) noexcept
@@ -140,38 +229,30 @@ json fetch_changes(std::string_view reg_name)
     return *it;
 }
 
-void queue_changes(shared_ptr<config_registry> rg, json patch)
+void stage_changes(batch* out, shared_ptr<config_registry> const& rg, json const& patch)
 {
     if (glog()->should_log(spdlog::level::debug))
     {
         CPPH_DEBUG("applying changes to category '{}', content: {}\n", rg->name(), patch.dump(2));
     }
 
-    // apply all update
+    out->reserve(rg, patch.size());
+
     for (auto& [disp_key, value] : patch.items())
     {
-        auto full_key = rg->bk_find_key(disp_key);
-        if (full_key.empty())
+        if (not out->stage(rg, disp_key, value))
         {
             CPPH_WARN("key {} does not exist on category {}", disp_key, rg->name());
-            continue;
-        }
-
-        auto it = rg->bk_all().find(full_key);
-        if (it == rg->bk_all().end())
-        {
-            CPPH_CRITICAL(
-                    "rg: {}, disp key: {}, full_key: {}, is not valid.",
-                    rg->name(), disp_key, full_key);
-            continue;
         }
-
-        if (not it->second->can_import())
-            continue;
-
-        rg->bk_queue_update_value(full_key, std::move(value));
     }
 }
+
+void queue_changes(shared_ptr<config_registry> const& rg, json const& patch)
+{
+    batch changes{change_source::file};
+    stage_changes(&changes, rg, patch);
+    changes.commit();
+}
 }  // namespace perfkit::configs::_io
 
 static auto import_export_reenter_lock()
@@ -180,7 +261,7 @@ static auto import_export_reenter_lock()
     return std::unique_lock{mt};
 }
 
-bool perfkit::configs::import_from(json const& data)
+bool perfkit::configs::import_from(json const& data, change_source source)
 {
     if (not data.is_object())
         return false;
@@ -195,15 +276,245 @@ bool perfkit::configs::import_from(json const& data)
         *js          = data;
     }
 
+    // stage every change first, then commit them at once to prevent partial application.
+    batch changes{source};
+
     auto registries = config_registry::bk_enumerate_registries();
     for (auto const& registry : registries)
     {
         auto it = data.find(registry->name());
         if (it == data.end()) { continue; }
 
-        _io::queue_changes(registry, *it);
+        _io::stage_changes(&changes, registry, *it);
+    }
+
+    changes.commit();
+    return true;
+}
+
+namespace perfkit::configs::_io {
+/**
+ * Streams configuration document, staging each config value to its registry as soon as
+ * it's parsed, while building the loaded-configuration cache in the same pass.
+ */
+class import_sax_handler
+{
+   public:
+    /**
+     * @param previous if specified, values equal to previously loaded ones are not staged.
+     */
+    import_sax_handler(json* loaded, batch* changes, json const* previous = nullptr)
+            : _loaded(loaded), _changes(changes), _previous(previous) {}
+
+    size_t num_skipped() const noexcept { return _num_skipped; }
+
+   public:
+    bool null() { return _value(nullptr); }
+    bool boolean(bool v) { return _value(v); }
+    bool number_integer(json::number_integer_t v) { return _value(v); }
+    bool number_unsigned(json::number_unsigned_t v) { return _value(v); }
+    bool number_float(json::number_float_t v, json::string_t const&) { return _value(v); }
+    bool string(json::string_t& v) { return _value(std::move(v)); }
+    bool binary(json::binary_t& v) { return _value(json::binary(std::move(v))); }
+
+    bool start_object(size_t) { return _start(json::object()); }
+    bool start_array(size_t) { return _start(json::array()); }
+    bool end_object() { return _end(); }
+    bool end_array() { return _end(); }
+
+    bool key(json::string_t& k)
+    {
+        switch (_depth)
+        {
+            case 1: _key_registry = std::move(k); break;
+            case 2: _key_config = std::move(k); break;
+            default: _key_nested = std::move(k); break;
+        }
+        return true;
+    }
+
+    bool parse_error(size_t position, std::string const&, nlohmann::detail::exception const& e)
+    {
+        CPPH_ERROR("config import failed: (error at {}) {}", position, e.what());
+        return false;
+    }
+
+   private:
+    bool _start(json&& init)
+    {
+        switch (_depth++)
+        {
+            case 0:  // document root
+                return init.is_object();
+
+            case 1:  // registry
+                if (init.is_object())
+                {
+                    _registry_cache  = &(*_loaded)[_key_registry];
+                    *_registry_cache = std::move(init);
+                    _registry        = config_registry::bk_find_reg(_key_registry);
+                    _registry_prev   = nullptr;
+
+                    if (_previous)
+                        if (auto it = _previous->find(_key_registry);
+                            it != _previous->end() && it->is_object())
+                            _registry_prev = &*it;
+
+                    return true;
+                }
+                [[fallthrough]];
+
+            default:  // compound config value
+                if (_stack.empty())
+                    _stack.push_back(&(_compound = std::move(init)));
+                else
+                    _stack.push_back(_insert(std::move(init)));
+
+                return true;
+        }
+    }
+
+    bool _end()
+    {
+        --_depth;
+
+        if (_stack.empty()) { return true; }  // end of registry, or root
+        _stack.pop_back();
+
+        if (_stack.empty()) { _complete(std::move(_compound)); }
+        return true;
+    }
+
+    bool _value(json&& v)
+    {
+        if (_stack.empty())
+            _complete(std::move(v));
+        else
+            _insert(std::move(v));
+
+        return true;
+    }
+
+    json* _insert(json&& v)
+    {
+        auto top = _stack.back();
+
+        if (top->is_object())
+            return &((*top)[_key_nested] = std::move(v));
+
+        top->push_back(std::move(v));
+        return &top->back();
+    }
+
+    void _complete(json&& v)
+    {
+        if (_depth == 1)
+        {  // non-object registry content. just cache it.
+            (*_loaded)[_key_registry] = std::move(v);
+            return;
+        }
+
+        if (_registry_prev)
+            if (auto it = _registry_prev->find(_key_config);
+                it != _registry_prev->end() && *it == v)
+            {  // not changed from previously loaded one.
+                ++_num_skipped;
+                (*_registry_cache)[_key_config] = std::move(v);
+                return;
+            }
+
+        if (_registry && not _changes->stage(_registry, _key_config, v))
+        {
+            CPPH_WARN("key {} does not exist on category {}", _key_config, _registry->name());
+        }
+
+        (*_registry_cache)[_key_config] = std::move(v);
+    }
+
+   private:
+    json* _loaded;
+    batch* _changes;
+
+    size_t _depth = 0;
+    std::string _key_registry;
+    std::string _key_config;
+    std::string _key_nested;
+
+    json* _registry_cache = nullptr;
+    shared_ptr<config_registry> _registry;
+
+    json const* _previous      = nullptr;
+    json const* _registry_prev = nullptr;
+    size_t _num_skipped        = 0;
+
+    json _compound;
+    std::vector<json*> _stack;
+};
+}  // namespace perfkit::configs::_io
+
+bool perfkit::configs::import_from_memory(void const* data, size_t size, bool changes_only)
+{
+    auto begin = static_cast<char const*>(data);
+    auto end   = begin + size;
+
+    // detect format from the first meaningful byte, which must begin a map.
+    auto it = begin;
+    if (size >= 3 && memcmp(it, "\xEF\xBB\xBF", 3) == 0) { it += 3; }  // utf-8 bom
+    while (it != end && isspace(uint8_t(*it))) { ++it; }
+
+    if (it == end) { return false; }
+
+    auto format = json::input_format_t::json;
+    auto lead   = uint8_t(*it);
+
+    if ((lead & 0xf0) == 0x80 || lead == 0xde || lead == 0xdf)
+        format = json::input_format_t::msgpack;
+    else if ((lead & 0xe0) == 0xa0 || lead == 0xd9)  // map, or self-describe tag
+        format = json::input_format_t::cbor;
+    else if (lead != '{')
+    {
+        CPPH_ERROR("config import failed: unknown document format");
+        return false;
+    }
+
+    auto _l{import_export_reenter_lock()};
+    (void)_l;
+
+    json loaded = json::object();
+    batch changes{change_source::file};
+
+    // cache is only replaced under reenter lock, which is held here. thus it's safe to read
+    //  it without cache lock, as every concurrent access is read.
+    json const* previous = changes_only ? _io::_loaded().first : nullptr;
+
+    _io::import_sax_handler handler{&loaded, &changes, previous};
+    bool parsed = false;
+
+    if (format == json::input_format_t::cbor)
+    {
+        // json::sax_parse() rejects any tag, including self-describe tag which is commonly
+        // written at the beginning of cbor files.
+        auto input = nlohmann::detail::input_adapter(it, end);
+        parsed     = nlohmann::detail::binary_reader<json, decltype(input), _io::import_sax_handler>{std::move(input)}
+                         .sax_parse(format, &handler, true, json::cbor_tag_handler_t::ignore);
+    }
+    else
+    {
+        parsed = json::sax_parse(it, end, &handler, format);
+    }
+
+    if (not parsed)
+        return false;
+
+    if (changes_only)
+        CPPH_DEBUG("{} changes staged, {} unchanged values skipped", changes.size(), handler.num_skipped());
+
+    {
+        auto [js, _] = _io::_loaded();
+        *js          = std::move(loaded);
     }
 
+    changes.commit();
     return true;
 }
 
@@ -220,7 +531,66 @@ void perfkit::config_registry::export_to(nlohmann::json* category)
 
 void perfkit::config_registry::import_from(nlohmann::json obj)
 {
-    configs::_io::queue_changes(shared_from_this(), std::move(obj));
+    configs::_io::queue_changes(shared_from_this(), obj);
+}
+
+bool perfkit::configs::batch::stage(
+        shared_ptr<config_registry> const& rg, std::string_view display_key, json value)
+{
+    auto conf = rg->bk_find_disp(display_key).get();
+    if (conf == nullptr) { return false; }
+
+    if (conf->can_import())
+    {
+        _changes_of(rg.get())->entries.push_back({conf, std::move(value)});
+        ++_num_staged;
+    }
+
+    return true;
+}
+
+void perfkit::configs::batch::stage(detail::config_base* conf, json value)
+{
+    _changes_of(conf->owner())->entries.push_back({conf, std::move(value)});
+    ++_num_staged;
+}
+
+void perfkit::configs::batch::reserve(shared_ptr<config_registry> const& rg, size_t num_entries)
+{
+    auto changes = _changes_of(rg.get());
+    changes->entries.reserve(changes->entries.size() + num_entries);
+}
+
+auto perfkit::configs::batch::_changes_of(config_registry* rg) -> _registry_changes*
+{
+    if (_latest && _latest->ref.get() == rg) { return _latest; }
+
+    auto& changes = _staged[rg];
+    changes.ref || (changes.ref = rg->shared_from_this(), 0);
+
+    return _latest = &changes;
+}
+
+void perfkit::configs::batch::commit()
+{
+    // registries whose every staged key was unknown or not importable have nothing to apply,
+    // thus must not hold the batch token, which would never be released.
+    auto num_registries = std::count_if(_staged.begin(), _staged.end(),
+                                        [](auto& pair) { return not pair.second.entries.empty(); });
+
+    if (num_registries > 0)
+    {
+        auto token = std::make_shared<std::atomic_size_t>(num_registries);
+        for (auto& [_, changes] : _staged)
+        {
+            if (changes.entries.empty()) { continue; }
+            changes.ref->bk_queue_update_batch(&changes.entries, token, _source);
+        }
+    }
+
+    _staged.clear();
+    _num_staged = 0;
+    _latest     = nullptr;
 }
 
 perfkit::json perfkit::configs::export_all()
@@ -264,6 +634,38 @@ perfkit::json perfkit::configs::export_all()
     return current;
 }
 
+namespace perfkit::configs {
+static constexpr std::pair<change_source, char const*> _source_names[] = {
+        {change_source::api, "api"},
+        {change_source::file, "file"},
+        {change_source::flag, "flag"},
+        {change_source::env, "env"},
+        {change_source::net, "net"},
+        {change_source::terminal, "terminal"},
+        {change_source::replay, "replay"},
+        {change_source::experiment, "experiment"},
+        {change_source::tuner, "tuner"},
+        {change_source::controller, "controller"},
+        {change_source::shared, "shared"},
+};
+
+char const* source_name(change_source source) noexcept
+{
+    for (auto& [value, name] : _source_names)
+        if (value == source) { return name; }
+
+    return "unknown";
+}
+
+bool parse_source_name(std::string_view name, change_source* out) noexcept
+{
+    for (auto& [value, str] : _source_names)
+        if (name == str) { return *out = value, true; }
+
+    return false;
+}
+}  // namespace perfkit::configs
+
 namespace perfkit::detail {
 static auto _cvars()
 {
@@ -303,31 +705,104 @@ bool perfkit::config_registry::update()
 {
     if (not _initial_update_done.load(std::memory_order_consume))
     {
-        CPPH_DEBUG("registry '{}' instantiated after loading configurations", name());
-
-        auto patch = configs::_io::fetch_changes(name());
-        if (not patch.empty())
+        bool is_first = false;
         {
-            configs::_io::queue_changes(shared_from_this(), std::move(patch));
+            // flag is set before freezing under the lock which _put() checks it with, thus
+            //  no config can be put into tables after they are frozen. exporting configs
+            //  is only allowed after this point.
+            auto _ = _access_lock();
+            if ((is_first = not _initial_update_done.load(std::memory_order_relaxed)))
+            {
+                _initial_update_done.store(true, std::memory_order_release);
+                _freeze();
+            }
         }
 
-        // exporting configs only allowed after first update.
-        _initial_update_done.store(true, std::memory_order_release);
-        detail::notify_config_update_any();
+        if (is_first)
+        {
+            CPPH_DEBUG("registry '{}' instantiated after loading configurations", name());
+
+            auto patch = configs::_io::fetch_changes(name());
+            if (not patch.empty())
+            {
+                configs::_io::queue_changes(shared_from_this(), patch);
+            }
+
+            detail::notify_config_update_any();
+        }
     }
 
+    // values written to shared memory by other processes are queued as typed updates.
+    configs::shared_table::_bk_pull(this);
+
     if (std::unique_lock _l{_update_lock})
     {
-        if (_pending_updates[0].empty()) { return false; }  // no update.
+        if (_pending_updates[0].empty())
+        {
+            // no update, though batches queued without any change must still be released.
+            std::vector<batch_token> batches;
+            batches.swap(_pending_batches);
+            _l.unlock();
+
+            bool do_notify = false;
+            for (auto& token : batches) { do_notify |= (--*token == 0); }
+
+            if (do_notify)
+                detail::notify_config_update_any();
+
+            return false;
+        }
 
         auto& update = _pending_updates[1];
 
-        bool has_valid_update = false;
-        update                = _pending_updates[0];
+        bool has_standalone = std::exchange(_pending_standalone, false);
+        update.swap(_pending_updates[0]);
         _pending_updates[0].clear();
 
+        std::vector<batch_token> batches;
+        batches.swap(_pending_batches);
+
+        // successfully applied configs are compacted to the front of update list.
+        size_t num_applied = 0;
+
         for (auto ptr : update)
         {
+            ptr->_pending = false;
+
+            if (ptr->_pending_restore)
+            {
+                auto restored = std::move(ptr->_pending_restore);
+                ptr->_pending_restore.reset();
+
+                ptr->_restore(restored.get(), ptr->_raw);
+                ptr->_on_deserialized(true, std::move(restored));
+                ptr->_reset_patch_log(), update[num_applied++] = ptr;
+                continue;
+            }
+
+            if (ptr->_pending_typed.index() != 0)
+            {
+                auto typed          = std::move(ptr->_pending_typed);
+                ptr->_pending_typed = {};
+
+                if (ptr->_try_deserialize(typed))
+                    ptr->_reset_patch_log(), update[num_applied++] = ptr;
+                else
+                    CPPH_ERROR("typed update failed: '{}'", ptr->display_key());
+
+                continue;
+            }
+
+            if (ptr->_patches && not ptr->_patches->pending.empty())
+            {
+                if (ptr->_try_patch())
+                    update[num_applied++] = ptr;
+                else
+                    CPPH_ERROR("patch failed: '{}'", ptr->display_key());
+
+                continue;
+            }
+
             auto r_desrl = ptr->_try_deserialize(ptr->_cached_serialized);
 
             if (!r_desrl)
@@ -337,13 +812,36 @@ bool perfkit::config_registry::update()
             }
             else
             {
-                has_valid_update |= true;
+                ptr->_reset_patch_log();
+                update[num_applied++] = ptr;
             }
         }
 
+        bool has_valid_update = num_applied > 0;
+        update.resize(num_applied);
+
+        if (has_valid_update && _snapshot_enabled.load(std::memory_order_relaxed))
+            _publish_snapshot(update);
+
+        for (auto block : _dirty_blocks)
+            for (auto ptr : update) { block->mark(ptr->_dense_index); }
+
+        if (has_valid_update)
+            configs::journal::_bk_record(update);
+
+        if (has_valid_update)
+            configs::shared_table::_bk_push(this, update);
+
         _l.unlock();
 
         if (has_valid_update)
+            configs::subscription::_bk_dispatch(this, update);
+
+        // batch changes notify only once, when the last registry of the batch applies it.
+        bool do_notify = has_valid_update && has_standalone;
+        for (auto& token : batches) { do_notify |= (--*token == 0); }
+
+        if (do_notify)
             detail::notify_config_update_any();
     }
 
@@ -353,6 +851,7 @@ bool perfkit::config_registry::update()
 void perfkit::config_registry::_put(std::shared_ptr<detail::config_base> o)
 {
     CPPH_TRACE("new config: {} ({})", o->full_key(), o->display_key());
+    auto _ = _access_lock();
 
     if (_initially_updated())
     {
@@ -377,16 +876,19 @@ void perfkit::config_registry::_put(std::shared_ptr<detail::config_base> o)
     _disp_keymap.try_emplace(o->display_key(), o->full_key());
     _entities.try_emplace(o->full_key(), o);
 
+    o->_dense_index = static_cast<uint32_t>(_dense.size());
+    _dense.push_back(o.get());
+
     // update schema hash
     _schema_hash = {hasher::fnv1a_64(o->full_key(), _schema_hash.value)};
 
     // TODO: throw error if flag belongs to disposable registry
-    if (auto attr = &o->attribute(); attr->contains("is_flag"))
+    if (o->is_flag())
     {
         std::vector<std::string> bindings;
-        if (auto it = attr->find("flag_binding"); it != attr->end())
+        if (not o->flag_bindings().empty())
         {
-            bindings = it->get<std::vector<std::string>>();
+            bindings = o->flag_bindings();
         }
         else
         {
@@ -399,8 +901,7 @@ void perfkit::config_registry::_put(std::shared_ptr<detail::config_base> o)
 
         for (auto& binding : bindings)
         {
-            static std::regex match{R"RG(^(((?!no-)[^N-][\w-\.]*)|N[\w-\.]+))RG"};
-            if (!std::regex_match(binding, match)
+            if (not detail::_is_valid_flag_name(binding)
                 || binding.find_first_of(' ') != ~size_t{}
                 || binding == "help" || binding == "h")
             {
@@ -408,7 +909,10 @@ void perfkit::config_registry::_put(std::shared_ptr<detail::config_base> o)
                         fmt::format("invalid flag name: {}", binding));
             }
 
+            std::unique_lock lock{configs::_flags_lock()};
             auto [_, is_new] = configs::_flags().try_emplace(std::move(binding), o);
+            lock.unlock();
+
             if (!is_new)
             {
                 throw configs::duplicated_flag_binding{
@@ -420,6 +924,12 @@ void perfkit::config_registry::_put(std::shared_ptr<detail::config_base> o)
 
 std::string_view perfkit::config_registry::bk_find_key(std::string_view display_key)
 {
+    if (_frozen.load(std::memory_order_acquire))
+    {
+        auto& conf = bk_find_disp(display_key);
+        return conf ? std::string_view{conf->full_key()} : std::string_view{};
+    }
+
     if (auto it = _disp_keymap.find(display_key); it != _disp_keymap.end())
     {
         return it->second;
@@ -430,64 +940,384 @@ std::string_view perfkit::config_registry::bk_find_key(std::string_view display_
     }
 }
 
-bool perfkit::config_registry::bk_queue_update_value(std::string_view full_key, json value)
+auto perfkit::config_registry::bk_find(std::string_view full_key) const noexcept
+        -> config_shared_ptr const&
 {
-    auto _ = _access_lock();
+    static const config_shared_ptr none;
+
+    if (_frozen.load(std::memory_order_acquire))
+    {
+        auto found = _frozen_entities.find(full_key);
+        return found ? *found : none;
+    }
 
     auto it = _entities.find(full_key);
-    if (it == _entities.end()) { return false; }
+    return it != _entities.end() ? it->second : none;
+}
+
+auto perfkit::config_registry::bk_find_disp(std::string_view display_key) const noexcept
+        -> config_shared_ptr const&
+{
+    static const config_shared_ptr none;
+
+    if (_frozen.load(std::memory_order_acquire))
+    {
+        auto found = _frozen_disp_keymap.find(display_key);
+        return found ? *found : none;
+    }
+
+    auto it = _disp_keymap.find(display_key);
+    return it != _disp_keymap.end() ? bk_find(it->second) : none;
+}
+
+auto perfkit::config_registry::snapshot() -> configs::snapshot_ptr
+{
+    if (not _snapshot_enabled.load(std::memory_order_acquire))
+    {
+        auto _ = _access_lock();
+        if (not _snapshot_enabled.load(std::memory_order_relaxed))
+        {
+            _build_snapshot();
+            _snapshot_enabled.store(true, std::memory_order_release);
+        }
+    }
+
+    return _snapshot.snapshot();
+}
+
+void perfkit::config_registry::_build_snapshot()
+{
+    // values are read directly from configs, thus update lock must be held.
+    auto next    = std::make_shared<configs::snapshot>();
+    next->_owner = this;
+    next->_epoch = _snapshot.snapshot()->_epoch + 1;
+    next->_size  = _dense.size();
+    next->_chunks.resize((_dense.size() + configs::snapshot::chunk_size - 1) / configs::snapshot::chunk_size);
+
+    for (auto& chunk : next->_chunks) { chunk = std::make_shared<configs::snapshot::chunk>(); }
+    for (auto conf : _dense)
+    {
+        if (not conf->can_snapshot()) { continue; }
+
+        auto index  = conf->_dense_index;
+        auto& chunk = *next->_chunks[index / next->chunk_size];
+        chunk[index % next->chunk_size] = conf->_current_version();
+    }
+
+    _snapshot.store(std::move(next));
+}
+
+void perfkit::config_registry::_publish_snapshot(std::vector<detail::config_base*> const& changes)
+{
+    auto prev = _snapshot.snapshot();
+    auto next = std::make_shared<configs::snapshot>(*prev);
+    ++next->_epoch;
+
+    // clone only chunks which contain changed configs. rest are shared with previous epoch.
+    for (auto conf : changes)
+    {
+        if (not conf->can_snapshot()) { continue; }
+
+        auto index = conf->_dense_index;
+        auto& slot = next->_chunks[index / next->chunk_size];
+
+        if (slot == prev->_chunks[index / next->chunk_size])
+            slot = std::make_shared<configs::snapshot::chunk>(*slot);
+
+        (*slot)[index % next->chunk_size] = conf->_current_version();
+    }
+
+    configs::snapshot_ptr published = std::move(next);
+    _snapshot.store(published);
+
+    // groups are republished only when any of their members changed.
+    auto it = std::remove_if(_groups.begin(), _groups.end(), [&](auto& wptr) {
+        auto grp = wptr.lock();
+        if (not grp) { return true; }
+
+        auto is_member = [&](auto conf) { return grp->_contains(conf->_dense_index); };
+        if (std::any_of(changes.begin(), changes.end(), is_member))
+            grp->_publish(published);
+
+        return false;
+    });
+
+    _groups.erase(it, _groups.end());
+}
+
+void perfkit::config_registry::_add_group(configs::group_ptr const& grp)
+{
+    auto _ = _access_lock();
+    _groups.push_back(grp);
+
+    // republish under lock, as registry could have been updated since group's creation.
+    grp->_publish(_snapshot.snapshot());
+}
+
+void perfkit::config_registry::_remove_dirty_block(_configs::dirty_block* block)
+{
+    _dirty_blocks.erase(std::remove(_dirty_blocks.begin(), _dirty_blocks.end(), block), _dirty_blocks.end());
+}
+
+void perfkit::config_registry::_freeze()
+{
+    // snapshot may have been built while configs were still being registered. as no config
+    //  can be registered from now on, rebuild it once to cover every config.
+    if (_snapshot_enabled.load(std::memory_order_relaxed))
+    {
+        _build_snapshot();
+        for (auto& wptr : _groups)
+            if (auto grp = wptr.lock()) { grp->_publish(_snapshot.snapshot()); }
+    }
+
+    std::vector<std::pair<std::string_view, config_shared_ptr>> by_full_key, by_disp_key;
+    by_full_key.reserve(_entities.size());
+    by_disp_key.reserve(_entities.size());
+
+    for (auto& [full_key, conf] : _entities)
+    {
+        by_full_key.emplace_back(full_key, conf);
+        by_disp_key.emplace_back(conf->display_key(), conf);
+    }
+
+    // map lookup is still valid even if perfect hash couldn't be found.
+    if (not _frozen_entities.build(std::move(by_full_key))
+        || not _frozen_disp_keymap.build(std::move(by_disp_key)))
+    {
+        CPPH_WARN("registry '{}': failed to build lookup table, falls back to map", name());
+        return;
+    }
+
+    _frozen.store(true, std::memory_order_release);
+}
+
+bool perfkit::config_registry::bk_queue_update_value(
+        std::string_view full_key, json value, change_source source)
+{
+    auto _ = _access_lock();
+
+    auto conf = bk_find(full_key).get();
+    if (conf == nullptr) { return false; }
 
     // to prevent value ignorance on contiguous load-save call without apply_changes(),
     // stores cache without validation.
-    it->second->_cached_serialized = std::move(value);
-    it->second->_fence_serialized  = ++it->second->_fence_modified;
+    conf->_cached_serialized = std::move(value);
+    conf->_fence_serialized  = ++conf->_fence_modified;
+    conf->_pending_typed     = {};
+    conf->_pending_restore   = nullptr;
+    conf->_pending_source    = source;
+    conf->_patches && (conf->_patches->pending.clear(), 0);  // superseded by whole value
+
+    _queue_pending(conf);
+    _pending_standalone = true;
+
+    return true;
+}
+
+void perfkit::config_registry::bk_queue_update_batch(
+        std::vector<batch_entry>* changes, batch_token const& token, change_source source)
+{
+    auto _ = _access_lock();
+
+    for (auto& [conf, value] : *changes)
+    {
+        conf->_cached_serialized = std::move(value);
+        conf->_fence_serialized  = ++conf->_fence_modified;
+        conf->_pending_typed     = {};
+        conf->_pending_restore   = nullptr;
+        conf->_pending_source    = source;
+        conf->_patches && (conf->_patches->pending.clear(), 0);
+
+        _queue_pending(conf);
+    }
+
+    changes->clear();
+
+    if (_initial_update_done.load(std::memory_order_relaxed))
+        return _pending_batches.push_back(token);
+
+    // registry which was never updated may never be, thus the batch doesn't wait for it.
+    //  queued changes are applied by its first update anyway.
+    _.unlock();
+    if (--*token == 0)
+        detail::notify_config_update_any();
+}
+
+void perfkit::config_registry::_queue_pending(detail::config_base* conf)
+{
+    // push unique element. O(1) by per-config flag.
+    if (std::exchange(conf->_pending, true)) { return; }
+    _pending_updates[0].push_back(conf);
+}
+
+bool perfkit::config_registry::bk_queue_update_typed(
+        std::string_view full_key, detail::config_base::typed_value value, change_source source)
+{
+    auto _ = _access_lock();
+
+    auto conf = bk_find(full_key).get();
+    if (conf == nullptr) { return false; }
+    if (not conf->can_update_typed()) { return false; }
+
+    // json cache is invalidated by modification fence, and regenerated from pending
+    //  typed value only when someone asks for serialization.
+    conf->_pending_typed   = std::move(value);
+    conf->_pending_restore = nullptr;
+    conf->_pending_source  = source;
+    ++conf->_fence_modified;
+    conf->_patches && (conf->_patches->pending.clear(), 0);
 
-    // push unique element
-    auto updates  = _pending_updates + 0;
-    auto conf_ptr = it->second.get();
-    if (auto it_up = std::find(updates->begin(), updates->end(), conf_ptr);
-        it_up == updates->end())
-        updates->push_back(conf_ptr);
+    _queue_pending(conf);
+    _pending_standalone = true;
 
     return true;
 }
 
+bool perfkit::config_registry::bk_queue_patch(
+        std::string_view full_key, json ops, change_source source)
+{
+    auto _ = _access_lock();
+
+    auto conf = bk_find(full_key).get();
+    if (conf == nullptr) { return false; }
+    if (not ops.is_array()) { return false; }
+
+    auto& state = conf->_patches ? conf->_patches : (conf->_patches = std::make_unique<detail::config_base::_patch_state>());
+
+    // pending rollback or typed update is turned into whole value, which can be patched.
+    if (conf->_pending_restore || conf->_pending_typed.index() != 0)
+    {
+        conf->_serialize_cache();
+        conf->_fence_serialized = conf->_fence_modified.load();
+        conf->_pending_restore  = nullptr;
+        conf->_pending_typed    = {};
+    }
+
+    if (conf->_pending && state->pending.empty())
+    {
+        // whole value is pending. patch it directly to preserve order of modifications.
+        auto copy = conf->_cached_serialized;
+        if (not _configs::apply_patch(&copy, ops)) { return false; }
+
+        conf->_cached_serialized = std::move(copy);
+        conf->_fence_serialized  = ++conf->_fence_modified;
+        conf->_pending_source    = source;
+        return true;
+    }
+
+    state->pending.push_back(std::move(ops));
+    conf->_pending_source = source;
+
+    _queue_pending(conf);
+    _pending_standalone = true;
+
+    return true;
+}
+
+bool perfkit::config_registry::bk_queue_rollback(
+        std::string_view full_key, clock::time_point at, change_source source)
+{
+    auto _ = _access_lock();
+
+    auto conf = bk_find(full_key).get();
+    if (conf == nullptr) { return false; }
+
+    return _queue_restore(conf, at, source);
+}
+
+size_t perfkit::config_registry::bk_queue_rollback_all(clock::time_point at, change_source source)
+{
+    auto _ = _access_lock();
+
+    size_t num_queued = 0;
+    for (auto conf : _dense)
+    {
+        // skip configs which weren't changed since then.
+        auto ver = conf->_version_at(at);
+        if (ver == nullptr || ver == &conf->_history.back()) { continue; }
+
+        num_queued += _queue_restore(conf, at, source);
+    }
+
+    return num_queued;
+}
+
+bool perfkit::config_registry::_queue_restore(
+        detail::config_base* conf, clock::time_point at, change_source source)
+{
+    if (not conf->can_rollback()) { return false; }
+
+    auto ver = conf->_version_at(at);
+    if (ver == nullptr) { return false; }
+
+    conf->_pending_restore = ver->value;
+    conf->_pending_typed   = {};
+    conf->_pending_source  = source;
+    conf->_patches && (conf->_patches->pending.clear(), 0);
+    ++conf->_fence_modified;
+
+    _queue_pending(conf);
+    _pending_standalone = true;
+
+    return true;
+}
+
+perfkit::json perfkit::config_registry::bk_diff(clock::time_point from, clock::time_point to)
+{
+    auto _ = _access_lock();
+
+    json out = json::object();
+    for (auto conf : _dense)
+    {
+        auto ver_from = conf->_version_at(from);
+        auto ver_to   = conf->_version_at(to);
+
+        if (ver_from == nullptr || ver_to == nullptr) { continue; }
+        if (ver_from->value == ver_to->value) { continue; }  // same version
+
+        json value_from, value_to;
+        conf->serialize(*ver_from, value_from);
+        conf->serialize(*ver_to, value_to);
+
+        if (value_from != value_to)
+            out[conf->display_key()] = json::array({std::move(value_from), std::move(value_to)});
+    }
+
+    return out;
+}
+
 perfkit::config_registry::config_registry(std::string name)
-        : _name(std::move(name)) {}
+        : _name(std::move(name)),
+          _snapshot(configs::snapshot{}) {}
 
 perfkit::detail::config_base::config_base(
         config_registry* owner,
         void* raw, std::string full_key,
         perfkit::detail::config_base::deserializer fn_deserial,
         perfkit::detail::config_base::serializer fn_serial,
-        nlohmann::json&& attribute)
+        config_attribute&& attribute,
+        perfkit::detail::config_base::publisher fn_publish,
+        perfkit::detail::config_base::typed_deserializer fn_typed,
+        perfkit::detail::config_base::snapshotter fn_snapshot,
+        perfkit::detail::config_base::patcher fn_patch,
+        perfkit::detail::config_base::restorer fn_restore,
+        perfkit::detail::config_base::normalizer fn_normalize)
         : _owner(owner),
           _full_key(std::move(full_key)),
           _raw(raw),
-          _attribute(std::move(attribute)),
+          _attr(std::move(attribute)),
           _deserialize(std::move(fn_deserial)),
-          _serialize(std::move(fn_serial))
+          _serialize(std::move(fn_serial)),
+          _publish(std::move(fn_publish)),
+          _deserialize_typed(std::move(fn_typed)),
+          _snapshot(fn_snapshot),
+          _patch(fn_patch),
+          _restore(fn_restore),
+          _normalize(fn_normalize)
 {
-    static std::regex rg_trim_whitespace{R"((?:^|\|?)\s*(\S?[^|]*\S)\s*(?:\||$))"};
-    static std::regex rg_remove_order_marker{R"(\+[^|]+\|)"};
+    _display_key = detail::_make_display_key(_full_key);
 
-    _display_key.reserve(_full_key.size());
-    for (std::sregex_iterator end{}, it{_full_key.begin(), _full_key.end(), rg_trim_whitespace};
-         it != end;
-         ++it)
-    {
-        if (!it->ready()) { throw "Invalid Token"; }
-        _display_key.append(it->str(1));
-        _display_key.append("|");
-    }
-    _display_key.pop_back();  // remove last | character
-
-    auto it = std::regex_replace(_display_key.begin(),
-                                 _display_key.begin(), _display_key.end(),
-                                 rg_remove_order_marker, "");
-    _display_key.resize(it - _display_key.begin());
-
-    if (_full_key.back() == '|')
+    if (_full_key.empty() || _full_key.back() == '|')
     {
         throw std::invalid_argument(
                 fmt::format("Invalid Key Name: {}", _full_key));
@@ -501,15 +1331,55 @@ perfkit::detail::config_base::config_base(
     }
 
     _split_categories(_display_key, _categories);
+
+    // initial value is the first version.
+    if (_snapshot && _attr.max_history > 0)
+        _history.push_back({clock::now(), configs::change_source::api, _snapshot(_raw)});
 }
 
 bool perfkit::detail::config_base::_try_deserialize(nlohmann::json const& value)
 {
-    if (_deserialize(value, _raw))
+    return _on_deserialized(_deserialize(value, _raw));
+}
+
+bool perfkit::detail::config_base::_try_deserialize(typed_value const& value)
+{
+    return _on_deserialized(_deserialize_typed(value, _raw));
+}
+
+bool perfkit::detail::config_base::_on_deserialized(bool succeeded, version_ptr applied)
+{
+    if (succeeded)
     {
+        // immutable copy of applied value, which is shared by read cell, snapshot and history.
+        //  nobody keeps it if both of history and snapshot are disabled.
+        bool keep_version = _attr.max_history > 0 || _owner->_snapshot_active();
+        if (not applied && _snapshot && keep_version) { applied = _snapshot(_raw); }
+
+        _publish && (_publish(_raw, applied), 0);
         _fence_modified.fetch_add(1, std::memory_order_relaxed);
+        _num_applied.fetch_add(1, std::memory_order_relaxed);
         _dirty = true;
 
+        if (not keep_version)
+        {
+            _history.clear();
+        }
+        else if (applied)
+        {
+            if (_history.size() > _attr.max_history)
+                _history.erase(_history.begin(), _history.end() - _attr.max_history);
+
+            _history.push_back({clock::now(), _pending_source, std::move(applied)});
+        }
+
+        if (not _observers.empty())
+        {
+            auto it = std::remove_if(_observers.begin(), _observers.end(),
+                                     [&](observer const& fn) { return not fn(_raw); });
+            _observers.erase(it, _observers.end());
+        }
+
         _latest_marshal_failed.store(false, std::memory_order_relaxed);
         return true;
     }
@@ -526,12 +1396,30 @@ nlohmann::json perfkit::detail::config_base::serialize()
     return serialize(copy), copy;
 }
 
+void perfkit::detail::config_base::_serialize_cache()
+{
+    if (_pending_restore)
+        return _serialize(_cached_serialized, _pending_restore.get());
+
+    if (_pending_typed.index() == 0)
+        return _serialize(_cached_serialized, _raw);
+
+    std::visit(
+            [&](auto&& value) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::monostate>)
+                    _cached_serialized = nullptr;
+                else
+                    _cached_serialized = value;
+            },
+            _pending_typed);
+}
+
 void perfkit::detail::config_base::serialize(nlohmann::json& copy)
 {
     if (auto nmodify = num_modified(); _fence_serialized != nmodify)
     {
         auto _lock = _owner->_access_lock();
-        _serialize(_cached_serialized, _raw);
+        _serialize_cache();
         _fence_serialized = nmodify;
         copy              = _cached_serialized;
     }
@@ -548,16 +1436,167 @@ void perfkit::detail::config_base::serialize(std::function<void(nlohmann::json c
 
     if (auto nmodify = num_modified(); _fence_serialized != nmodify)
     {
-        _serialize(_cached_serialized, _raw);
+        _serialize_cache();
         _fence_serialized = nmodify;
     }
 
     fn(_cached_serialized);
 }
 
-void perfkit::detail::config_base::request_modify(nlohmann::json js)
+void perfkit::detail::config_base::request_modify(nlohmann::json js, configs::change_source source)
+{
+    _owner->bk_queue_update_value(std::string(full_key()), std::move(js), source);
+}
+
+bool perfkit::detail::config_base::request_patch(nlohmann::json ops, configs::change_source source)
+{
+    return _owner->bk_queue_patch(full_key(), std::move(ops), source);
+}
+
+void perfkit::detail::config_base::_bk_add_observer(observer fn)
+{
+    auto _lock = _owner->_access_lock();
+    if (fn(_raw)) { _observers.push_back(std::move(fn)); }
+}
+
+bool perfkit::detail::config_base::request_rollback(clock::time_point at, configs::change_source source)
+{
+    return _owner->bk_queue_rollback(full_key(), at, source);
+}
+
+auto perfkit::detail::config_base::history() const -> std::vector<version>
+{
+    auto _lock = _owner->_access_lock();
+    return _history;
+}
+
+auto perfkit::detail::config_base::_current_version() const -> version_ptr
+{
+    return _history.empty() ? _snapshot(_raw) : _history.back().value;
+}
+
+auto perfkit::detail::config_base::_version_at(clock::time_point at) const noexcept -> version const*
 {
-    _owner->bk_queue_update_value(std::string(full_key()), std::move(js));
+    auto it = std::find_if(_history.rbegin(), _history.rend(),
+                           [&](version const& v) { return v.timestamp <= at; });
+
+    return it == _history.rend() ? nullptr : &*it;
+}
+
+bool perfkit::detail::config_base::_try_patch()
+{
+    auto pending = std::move(_patches->pending);
+    _patches->pending.clear();
+
+    // json cache is kept in sync with in-place patches, only if it was up to date.
+    bool cache_valid = _fence_serialized == _fence_modified;
+    auto applied     = nlohmann::json::array();
+
+    std::vector<_configs::patch_op> parsed;
+    for (auto& ops : pending)
+    {
+        if (not _configs::parse_patch(ops, &parsed)) { continue; }
+
+        bool ok = false;
+        if (_patch && _configs::is_shallow(parsed))
+        {
+            ok          = _patch(parsed, _raw);
+            cache_valid = cache_valid && (not ok || _configs::apply_patch(&_cached_serialized, ops));
+        }
+        else
+        {
+            if (not cache_valid) { _serialize(_cached_serialized, _raw); }
+
+            auto copy = _cached_serialized;
+            ok        = _configs::apply_patch(&copy, ops) && _deserialize(copy, _raw);
+            ok && (_cached_serialized = std::move(copy), 0);
+
+            // attribute rules may have modified deserialized value.
+            cache_valid = ok && _patch;
+        }
+
+        if (ok)
+            for (auto& op : ops) { applied.push_back(op); }
+    }
+
+    if (not _on_deserialized(not applied.empty()))
+        return false;
+
+    if (cache_valid)
+        _fence_serialized = _fence_modified.load();
+
+    // patches are propagated as-is only when no attribute rule could alter the result.
+    if (_patch)
+    {
+        enum
+        {
+            max_log = 16
+        };
+
+        auto& log = _patches->log;
+        if (log.size() == max_log)
+        {
+            _patches->log_base = log.front().first;
+            log.erase(log.begin());
+        }
+
+        log.emplace_back(_fence_modified.load(), std::move(applied));
+    }
+    else
+    {
+        _reset_patch_log();
+    }
+
+    return true;
+}
+
+void perfkit::detail::config_base::_reset_patch_log()
+{
+    if (not _patches) { return; }
+
+    _patches->log.clear();
+    _patches->log_base = _fence_modified.load();
+}
+
+bool perfkit::detail::config_base::_bk_patches_since(
+        size_t fence, nlohmann::json* out_ops, size_t* out_fence)
+{
+    auto _lock = _owner->_access_lock();
+
+    if (not _patches || _patches->log.empty()) { return false; }
+    if (fence < _patches->log_base) { return false; }
+
+    *out_ops = nlohmann::json::array();
+    for (auto& [applied_fence, ops] : _patches->log)
+    {
+        if (applied_fence <= fence) { continue; }
+        for (auto& op : ops) { out_ops->push_back(op); }
+    }
+
+    *out_fence = _patches->log.back().first;
+    return true;
+}
+
+nlohmann::json const& perfkit::detail::config_base::attribute() const
+{
+    std::call_once(_attribute_built, [this] {
+        auto& js = _attribute;
+        _attr.fn_dump_typed && (_attr.fn_dump_typed(js), 0);
+
+        js["description"]          = _attr.description;
+        js["has_custom_validator"] = _has(config_attribute::has_custom_validator);
+
+        if (is_hidden()) { js["hidden"] = true; }
+        if (is_flag())
+        {
+            js["is_flag"] = true;
+            if (not _attr.flag_binding.empty()) { js["flag_binding"] = _attr.flag_binding; }
+        }
+        if (_has(config_attribute::transient)) { js["transient"] = true; }
+        if (_has(config_attribute::block_read)) { js["block_read"] = true; }
+    });
+
+    return _attribute;
 }
 
 void perfkit::detail::config_base::_split_categories(std::string_view view, std::vector<std::string_view>& out)
@@ -582,12 +1621,84 @@ void perfkit::detail::config_base::_split_categories(std::string_view view, std:
     out.push_back(view);  // last segment.
 }
 
+struct perfkit::configs::watcher::_node
+{
+    // address of destroyed registry may be reused by new one, thus owner is valid only
+    //  while rg hasn't expired.
+    std::weak_ptr<config_registry> rg;
+    config_registry* owner;
+    _configs::dirty_block block;
+    _node* next;
+};
+
+perfkit::configs::watcher::~watcher() noexcept
+{
+    for (auto node = _head.load(); node;)
+    {
+        if (auto rg = node->rg.lock())
+        {
+            auto _ = rg->_access_lock();
+            rg->_remove_dirty_block(&node->block);
+        }
+
+        delete std::exchange(node, node->next);
+    }
+}
+
+auto perfkit::configs::watcher::_find(detail::config_base* ptr) const noexcept -> _slot
+{
+    auto index = ptr->dense_index();
+    for (auto node = _head.load(std::memory_order_acquire); node; node = node->next)
+    {
+        if (node->owner != ptr->owner() || not node->block.covers(index) || node->rg.expired()) { continue; }
+        if (auto slot = node->block.slot_of(index); slot != _configs::dirty_block::npos) { return {&node->block, slot}; }
+    }
+
+    return {nullptr, 0};
+}
+
+auto perfkit::configs::watcher::_watch(detail::config_base* ptr) const -> _slot
+{
+    std::lock_guard _{_lock};
+    if (auto found = _find(ptr); found.first) { return found; }
+
+    auto rg    = ptr->owner();
+    auto index = ptr->dense_index();
+    auto lock  = rg->_access_lock();
+
+    auto node = _head.load(std::memory_order_relaxed);
+    while (node && (node->owner != rg || not node->block.covers(index) || node->rg.expired()))
+        node = node->next;
+
+    if (node == nullptr)
+    {
+        // registry may grow until its first update, thus newer configs get another block.
+        auto capacity = std::max<size_t>(rg->bk_all().size(), index + 1);
+        node          = new _node{rg->weak_from_this(), rg, _configs::dirty_block{capacity}, _head.load()};
+
+        rg->_add_dirty_block(&node->block);
+        _head.store(node, std::memory_order_release);
+    }
+
+    // registry can't apply any change meanwhile, thus no modification is missed. queued
+    //  changes are excluded, as update() marks them when they are applied.
+    return {&node->block, node->block.assign(ptr, index, ptr->num_applied() != 0)};
+}
+
 bool perfkit::configs::watcher::_check_update_and_consume(
         perfkit::detail::config_base* ptr) const
 {
-    auto* fence = &_table[ptr];
-    if (*fence != ptr->num_modified())
-        return *fence = ptr->num_modified(), true;
-    else
-        return false;
+    auto [block, slot] = _find(ptr);
+    if (block == nullptr) { std::tie(block, slot) = _watch(ptr); }
+
+    return block->consume(slot);
+}
+
+size_t perfkit::configs::watcher::consume(std::vector<detail::config_base*>* out) const
+{
+    size_t count = 0;
+    for (auto node = _head.load(std::memory_order_acquire); node; node = node->next)
+        count += node->block.consume_all([&](auto conf) { out->push_back(conf); });
+
+    return count;
 }
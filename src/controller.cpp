@@ -0,0 +1,291 @@
+#include "perfkit/detail/controller.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/detail/base.hpp"
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit {
+static double _percentile(std::vector<double>& samples, double p)
+{
+    auto nth = samples.begin() + size_t(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+static char const* _policy_name(controller_options::policy_t policy) noexcept
+{
+    return policy == controller_options::pid ? "pid" : "aimd";
+}
+
+controller::controller(config_shared_ptr conf, options opts)
+        : _conf(std::move(conf)),
+          _opts(std::move(opts)),
+          _name(_conf->display_key())
+{
+}
+
+auto controller::start(config_shared_ptr conf,
+                       tracer_ptr target,
+                       std::vector<std::string> node,
+                       options opts) -> std::shared_ptr<controller>
+{
+    if (not conf || not target || node.empty())
+        return CPPH_ERROR("controller: config, tracer and target node must be specified"), nullptr;
+
+    if (opts.window == 0 || opts.setpoint == 0 || not(opts.percentile >= 0 && opts.percentile <= 1)
+        || not(opts.multiplicative > 0 && opts.multiplicative < 1) || opts.additive <= 0)
+        return CPPH_ERROR("controller: invalid options"), nullptr;
+
+    auto& attr   = conf->attribute();
+    auto current = conf->serialize();
+
+    if (not current.is_number() || not attr.contains("min") || not attr.contains("max"))
+        return CPPH_ERROR("controller: '{}' must be numeric, with min and max", conf->display_key()), nullptr;
+
+    std::shared_ptr<controller> self{new controller{conf, std::move(opts)}};
+    self->_min       = attr["min"].get<double>();
+    self->_max       = attr["max"].get<double>();
+    self->_integral  = not current.is_number_float();
+    self->_node      = std::move(node);
+    self->_node_view = {self->_node.begin(), self->_node.end()};
+
+    if (not(self->_min < self->_max))
+        return CPPH_ERROR("controller: '{}' has empty range", conf->display_key()), nullptr;
+
+    self->_status.setpoint = self->_opts.setpoint;
+    self->_current         = current;
+    self->_output          = std::clamp(current.get<double>(), self->_min, self->_max);
+    self->_status.output   = self->_output;
+    self->_tracker         = _configs::apply_tracker::attach(conf);
+
+    target->on_iteration +=
+            [wself = std::weak_ptr{self}](tracer const& trc) {
+                auto self = wself.lock();
+                return self && self->_on_iteration(trc);
+            };
+
+    self->_category = metrics::category::share(self->_opts.category);
+    self->_category->add(self->_name, self.get());
+    self->_worker = std::thread{&controller::_worker_fn, self.get()};
+
+    CPPH_INFO("controller on '{}' started: {} of '{}' at {:.4g} by {}",
+              self->_name, self->_opts.percentile, target->name(), self->_opts.setpoint,
+              _policy_name(self->_opts.policy));
+
+    return self;
+}
+
+controller::~controller()
+{
+    _category && (_category->remove(this), 0);
+
+    {
+        std::lock_guard _{_mtx};
+        _stop = true;
+    }
+
+    _cvar.notify_one();
+    _worker.joinable() && (_worker.join(), 0);
+    _tracker && (_tracker->detach(), 0);
+
+    CPPH_INFO("controller on '{}' stopped: {} steps, {} changes",
+              _name, _status.num_steps, _status.num_changes);
+}
+
+void controller::setpoint(double value)
+{
+    if (value == 0) { return; }
+
+    std::lock_guard _{_mtx};
+    _status.setpoint = value;
+}
+
+auto controller::report() const -> status
+{
+    std::lock_guard _{_mtx};
+    return _status;
+}
+
+bool controller::_on_iteration(tracer const& trc)
+{
+    std::lock_guard _{_mtx};
+    if (_stop) { return false; }
+
+    if (_tracker->modified())
+    {
+        // let the worker adopt new value, with an empty window.
+        if (not _window_ready)
+        {
+            _window.clear(), _window_full.clear();
+            _window_ready = true;
+            _cvar.notify_one();
+        }
+
+        return true;
+    }
+
+    if (_waiting)
+    {
+        if (_tracker->num_applied() < _num_requested) { return true; }
+
+        // the iteration during which output was applied is mixed.
+        _waiting  = false;
+        _num_skip = 1 + _opts.warmup;
+    }
+
+    if (_node_cache == nullptr && (_node_cache = trc.find(_node_view)) == nullptr) { return true; }
+    if (_node_cache->fence != trc.fence()) { return true; }  // not reached in the iteration
+
+    auto sample = _node_cache->as_number();
+    if (not sample) { return true; }
+    if (_num_skip > 0) { return --_num_skip, true; }
+
+    _status.is_timer = _node_cache->as_timer().has_value();
+    _window.push_back(*sample);
+
+    // if worker is still busy with previous window, current one just grows.
+    if (_window.size() >= _opts.window && not _window_ready)
+    {
+        _window_full.swap(_window);
+        _window.clear();
+        _window_ready = true;
+        _cvar.notify_one();
+    }
+
+    return true;
+}
+
+void controller::_worker_fn()
+{
+    std::vector<double> samples;
+
+    for (std::unique_lock lock{_mtx};;)
+    {
+        _cvar.wait(lock, [&] { return _stop || _window_ready; });
+        if (_stop) { break; }
+
+        samples.swap(_window_full);
+        _window_full.clear();
+        _window_ready = false;
+
+        _step(lock, samples);
+    }
+}
+
+void controller::_step(std::unique_lock<std::mutex>& lock, std::vector<double>& samples)
+{
+    if (_tracker->modified()) { return _adopt_current(); }
+    if (samples.empty()) { return; }
+
+    auto measured = _percentile(samples, _opts.percentile);
+    auto setpoint = _status.setpoint;
+    auto dir      = _opts.inverse ? -1. : 1.;
+
+    // positive while there's headroom. clamped, thus a single outlier window can't swing
+    // output more than the gain allows.
+    auto error = std::clamp((setpoint - measured) / std::abs(setpoint), -1., 1.);
+
+    if (_opts.policy == options::pid)
+    {
+        auto e1 = _num_errors > 0 ? _error[0] : error;
+        auto e2 = _num_errors > 1 ? _error[1] : e1;
+
+        auto delta = _opts.kp * (error - e1) + _opts.ki * error + _opts.kd * (error - 2 * e1 + e2);
+        auto scale = std::max(std::abs(_output), (_max - _min) / 100);
+        _output += dir * delta * scale;
+    }
+    else if (error >= 0)
+    {
+        _output += dir * _opts.additive;
+    }
+    else
+    {
+        auto safe = _opts.inverse ? _max : _min;
+        _output   = safe + (_output - safe) * _opts.multiplicative;
+    }
+
+    _output   = std::clamp(_output, _min, _max);
+    _error[1] = _error[0];
+    _error[0] = error;
+    ++_num_errors;
+
+    _status.measured = measured;
+    _status.output   = _output;
+    ++_status.num_steps;
+
+    auto next = _integral ? nlohmann::json(std::llround(_output)) : nlohmann::json(_output);
+    if (next == _current) { return; }
+
+    _last_change = fmt::format("{} -> {}", _current.dump(), next.dump());
+    _current     = next;
+    ++_status.num_changes;
+
+    _tracker->expect(next);
+    ++_num_requested;
+    _waiting = true;
+    _window.clear();
+
+    CPPH_DEBUG("controller on '{}': {} ({:.4g} against {:.4g})", _name, _last_change, measured, setpoint);
+
+    lock.unlock();
+    _conf->request_modify(next, configs::change_source::controller);
+    lock.lock();
+}
+
+void controller::_adopt_current()
+{
+    // the value is already applied, as the tracker reported it from the registry update.
+    _current = _conf->serialize();
+    _output  = std::clamp(_current.get<double>(), _min, _max);
+
+    _status.output = _output;
+    _num_errors    = 0;
+    _last_change   = fmt::format("adopted {}", _current.dump());
+
+    _tracker->detach();
+    _tracker       = _configs::apply_tracker::attach(_conf);
+    _num_requested = 0;
+    _waiting       = false;
+    _num_skip      = 1 + _opts.warmup;
+    _window.clear();
+
+    CPPH_INFO("controller on '{}' adopted {}, which was set by others", _name, _current.dump());
+}
+
+void controller::publish(tracer_proxy& node)
+{
+    std::lock_guard _{_mtx};
+    auto to_duration = [](double ns) {
+        return std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double, std::nano>(ns));
+    };
+
+    node["policy"] = _policy_name(_opts.policy);
+
+    if (_status.is_timer)
+    {
+        node["setpoint"] = to_duration(_status.setpoint);
+        node["measured"] = to_duration(_status.measured);
+    }
+    else
+    {
+        node["setpoint"] = _status.setpoint;
+        node["measured"] = _status.measured;
+    }
+
+    if (_current.is_number_float())
+        node["value"] = _current.get<double>();
+    else
+        node["value"] = _current.get<int64_t>();
+
+    node["error"]       = _num_errors > 0 ? _error[0] : 0.;
+    node["waiting"]     = _waiting;
+    node["steps"]       = _status.num_steps;
+    node["changes"]     = _status.num_changes;
+    node["last_change"] = _last_change;
+}
+}  // namespace perfkit
@@ -0,0 +1,273 @@
+#include "perfkit/detail/experiment.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/detail/base.hpp"
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit {
+/** inverse of standard normal cdf, by bisection. */
+static double _normal_quantile(double p)
+{
+    double lo = -10, hi = 10;
+    for (int i = 0; i < 100; ++i)
+    {
+        auto mid = (lo + hi) / 2;
+        (0.5 * std::erfc(-mid / std::sqrt(2.)) < p ? lo : hi) = mid;
+    }
+
+    return (lo + hi) / 2;
+}
+
+static void _describe(std::vector<double> const& samples, experiment::arm_result* out)
+{
+    auto n     = samples.size();
+    out->count = n;
+    if (n == 0) { return; }
+
+    out->mean = std::accumulate(samples.begin(), samples.end(), 0.) / n;
+
+    double sq = 0;
+    for (auto v : samples) { sq += (v - out->mean) * (v - out->mean); }
+    out->stddev = n > 1 ? std::sqrt(sq / (n - 1)) : 0.;
+
+    auto copy = samples;
+    auto mid  = copy.begin() + n / 2;
+    std::nth_element(copy.begin(), mid, copy.end());
+    out->median = *mid;
+}
+
+experiment::experiment(config_shared_ptr conf, options opts)
+        : _conf(std::move(conf)),
+          _opts(opts),
+          _z_alpha(_normal_quantile(1. - opts.alpha / 2))
+{
+}
+
+auto experiment::start(config_shared_ptr conf,
+                       nlohmann::json value_a,
+                       nlohmann::json value_b,
+                       tracer_ptr target,
+                       std::vector<std::string> node,
+                       options opts) -> std::shared_ptr<experiment>
+{
+    if (not conf || not target || node.empty())
+        return CPPH_ERROR("experiment: config, tracer and target node must be specified"), nullptr;
+
+    if (value_a == value_b)
+        return CPPH_ERROR("experiment: two values must differ"), nullptr;
+
+    if (opts.block_size == 0 || opts.min_samples == 0 || opts.max_samples < opts.min_samples
+        || not(opts.alpha > 0 && opts.alpha < 1))
+        return CPPH_ERROR("experiment: invalid options"), nullptr;
+
+    std::shared_ptr<experiment> self{new experiment{conf, opts}};
+    self->_original  = conf->serialize();
+    self->_node      = std::move(node);
+    self->_node_view = {self->_node.begin(), self->_node.end()};
+
+    self->_values[0] = std::move(value_a);
+    self->_values[1] = std::move(value_b);
+    self->_tracker   = _configs::apply_tracker::attach(conf);
+
+    target->on_iteration +=
+            [wself = std::weak_ptr{self}](tracer const& trc) {
+                auto self = wself.lock();
+                return self && self->_on_iteration(trc);
+            };
+
+    {
+        std::lock_guard _{self->_mtx};
+        self->_expected = 0;
+    }
+
+    self->_queue(0);
+
+    CPPH_INFO("experiment on '{}' started: {} vs {}, target '{}'",
+              conf->display_key(), self->_values[0].dump(), self->_values[1].dump(), target->name());
+
+    return self;
+}
+
+experiment::~experiment() noexcept
+{
+    stop();
+    _tracker->detach();
+}
+
+void experiment::stop()
+{
+    std::unique_lock lock{_mtx};
+    if (_state != state_t::running) { return; }
+
+    _finish(lock, state_t::stopped);
+}
+
+auto experiment::report() const -> result
+{
+    std::lock_guard _{_mtx};
+    return _evaluate();
+}
+
+auto experiment::state() const noexcept -> state_t
+{
+    std::lock_guard _{_mtx};
+    return _state;
+}
+
+void experiment::_queue(int arm)
+{
+    if (arm < 0)
+        return _conf->request_modify(_original, configs::change_source::experiment);
+
+    _tracker->expect(_values[arm]);
+    _conf->request_modify(_values[arm], configs::change_source::experiment);
+}
+
+void experiment::_finish(std::unique_lock<std::mutex>& lock, state_t state, bool restore)
+{
+    _state    = state;
+    _expected = -1;
+    auto res  = _evaluate();
+
+    // original value must not be reported as modification.
+    _tracker->detach();
+    lock.unlock();
+
+    if (restore) { _queue(-1); }
+
+    CPPH_INFO("experiment on '{}' finished as {}: {} vs {}, diff {:.4g} [{:.4g}, {:.4g}], p={:.4g}",
+              _conf->display_key(), to_string(state),
+              res.arms[0].value.dump(), res.arms[1].value.dump(),
+              res.diff, res.ci_low, res.ci_high, res.p_value);
+
+    on_finish.invoke(res);
+}
+
+bool experiment::_on_iteration(tracer const& trc)
+{
+    std::unique_lock lock{_mtx};
+    if (_state != state_t::running) { return false; }
+
+    if (_tracker->modified())
+    {
+        CPPH_WARN("experiment on '{}' aborted: config was modified by others", _conf->display_key());
+        return _finish(lock, state_t::aborted, false), false;
+    }
+
+    // switch applied by registry update(). the iteration which it occurred in is mixed.
+    if (auto num_applied = _tracker->num_applied(); num_applied != _num_applied)
+    {
+        _num_applied = num_applied;
+        _active      = _expected;
+        _num_skip    = 1 + _opts.warmup;
+        _block_count = 0;
+    }
+
+    if (_node_cache == nullptr && (_node_cache = trc.find(_node_view)) == nullptr) { return true; }
+    if (_node_cache->fence != trc.fence()) { return true; }  // not reached in the iteration
+
+    auto sample = _node_cache->as_number();
+    if (_active < 0 || not sample) { return true; }
+    _is_timer = _node_cache->as_timer().has_value();
+    if (_num_skip > 0) { return --_num_skip, true; }
+
+    _samples[_active].push_back(*sample);
+    if (++_block_count < _opts.block_size || _expected != _active) { return true; }
+
+    // test after every pair of blocks, with boundary which shrinks to z_alpha at max_samples.
+    auto num_min = std::min(_samples[0].size(), _samples[1].size());
+    if (_active == 1 && num_min >= _opts.min_samples)
+    {
+        auto z     = std::abs(_evaluate().z);
+        auto bound = _z_alpha * std::sqrt(double(_opts.max_samples) / std::min(num_min, _opts.max_samples));
+
+        if (z >= bound)
+            return _finish(lock, state_t::significant), false;
+        if (num_min >= _opts.max_samples)
+            return _finish(lock, state_t::inconclusive), false;
+    }
+
+    auto next = _expected = 1 - _active;
+    lock.unlock();
+
+    _queue(next);
+    return true;
+}
+
+auto experiment::_evaluate() const -> result
+{
+    result res;
+    res.state    = _state;
+    res.is_timer = _is_timer;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        res.arms[i].value = _values[i];
+        _describe(_samples[i], &res.arms[i]);
+    }
+
+    auto& a = res.arms[0];
+    auto& b = res.arms[1];
+    if (a.count < 2 || b.count < 2) { return res; }
+
+    // welch confidence interval of difference of means
+    auto se     = std::sqrt(a.stddev * a.stddev / a.count + b.stddev * b.stddev / b.count);
+    res.diff    = b.mean - a.mean;
+    res.ci_low  = res.diff - _z_alpha * se;
+    res.ci_high = res.diff + _z_alpha * se;
+
+    // mann-whitney u test, with tie correction.
+    std::vector<std::pair<double, bool>> merged;
+    merged.reserve(a.count + b.count);
+    for (auto v : _samples[0]) { merged.emplace_back(v, false); }
+    for (auto v : _samples[1]) { merged.emplace_back(v, true); }
+    std::sort(merged.begin(), merged.end());
+
+    double rank_sum_b = 0, tie_sum = 0;
+    for (size_t i = 0, j; i < merged.size(); i = j)
+    {
+        for (j = i + 1; j < merged.size() && merged[j].first == merged[i].first;) { ++j; }
+
+        auto num_ties = double(j - i);
+        auto rank     = (i + 1 + j) / 2.;  // average of ranks i+1 .. j
+        tie_sum += num_ties * num_ties * num_ties - num_ties;
+
+        for (size_t k = i; k < j; ++k)
+            if (merged[k].second) { rank_sum_b += rank; }
+    }
+
+    double na = a.count, nb = b.count, n = na + nb;
+    auto u     = rank_sum_b - nb * (nb + 1) / 2;
+    auto mean  = na * nb / 2;
+    auto sigma = std::sqrt(na * nb / 12 * ((n + 1) - tie_sum / (n * (n - 1))));
+
+    if (sigma > 0)
+    {
+        auto dev    = u - mean;
+        res.z       = (dev - std::copysign(std::min(0.5, std::abs(dev)), dev)) / sigma;
+        res.p_value = std::erfc(std::abs(res.z) / std::sqrt(2.));
+    }
+
+    return res;
+}
+
+char const* to_string(experiment::state_t state) noexcept
+{
+    switch (state)
+    {
+        case experiment::state_t::running: return "running";
+        case experiment::state_t::significant: return "significant";
+        case experiment::state_t::inconclusive: return "inconclusive";
+        case experiment::state_t::stopped: return "stopped";
+        case experiment::state_t::aborted: return "aborted";
+    }
+
+    return "unknown";
+}
+}  // namespace perfkit
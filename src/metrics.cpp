@@ -0,0 +1,179 @@
+#include "perfkit/detail/metrics.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/common/macros.hxx"
+#include "perfkit/detail/base.hpp"
+
+#define CPPH_LOGGER() perfkit::glog()
+
+using namespace std::literals;
+
+namespace perfkit::metrics {
+namespace {
+class publisher
+{
+   public:
+    static publisher& get()
+    {
+        static publisher inst;
+        return inst;
+    }
+
+    publisher()
+    {
+        // categories destroyed along with publisher unregister their tracers, thus tracer
+        //  repository must be constructed first, to be destroyed after publisher at exit.
+        perfkit::tracer::all();
+    }
+
+    ~publisher()
+    {
+        {
+            std::lock_guard _{_mtx};
+            _active = false;
+            _cvar.notify_all();
+        }
+
+        _worker.joinable() && (_worker.join(), 0);
+    }
+
+    auto share(std::string_view name) -> std::shared_ptr<category>
+    {
+        std::lock_guard _{_mtx};
+
+        auto it = _categories.find(name);
+        if (it != _categories.end()) { return it->second; }
+
+        CPPH_DEBUG("creating metric category {}", name);
+        auto ptr = std::make_shared<category>(std::string{name});
+        _categories.try_emplace(std::string{name}, ptr);
+
+        if (not _worker.joinable())
+            _worker = std::thread{[this] { _worker_fn(); }};
+
+        return ptr;
+    }
+
+    auto all() -> std::vector<std::shared_ptr<category>>
+    {
+        std::lock_guard _{_mtx};
+
+        std::vector<std::shared_ptr<category>> out;
+        out.reserve(_categories.size());
+        for (auto& [_, ptr] : _categories) { out.push_back(ptr); }
+
+        return out;
+    }
+
+    void interval(std::chrono::milliseconds value)
+    {
+        std::lock_guard _{_mtx};
+        _interval = value;
+        _cvar.notify_all();
+    }
+
+   private:
+    void _worker_fn()
+    {
+        for (std::unique_lock lc{_mtx}; _active;)
+        {
+            _cvar.wait_for(lc, _interval, [&] { return not _active; });
+            if (not _active) { break; }
+
+            auto categories = _categories;
+            lc.unlock();
+
+            for (auto& [_, ptr] : categories) { ptr->update(); }
+
+            lc.lock();
+        }
+    }
+
+   private:
+    std::mutex _mtx;
+    std::condition_variable _cvar;
+    std::map<std::string, std::shared_ptr<category>, std::less<>> _categories;
+    std::chrono::milliseconds _interval = 500ms;
+    bool _active                        = true;
+    std::thread _worker;
+};
+}  // namespace
+
+category::category(std::string name)
+        : _name(std::move(name)),
+          _tracer(perfkit::tracer::create(std::numeric_limits<int>::max(), _name))
+{
+}
+
+auto category::share(std::string_view name) -> std::shared_ptr<category>
+{
+    return publisher::get().share(name);
+}
+
+auto category::all() noexcept -> std::vector<std::shared_ptr<category>>
+{
+    return publisher::get().all();
+}
+
+void category::add(std::string name, if_source* source)
+{
+    std::lock_guard _{_mtx};
+    _sources.push_back({std::move(name), source});
+}
+
+void category::remove(if_source* source)
+{
+    std::lock_guard _{_mtx};
+
+    auto it = std::find_if(_sources.begin(), _sources.end(),
+                           [&](auto&& s) { return s.ref == source; });
+
+    if (it != _sources.end()) { _sources.erase(it); }
+}
+
+void category::update()
+{
+    std::lock_guard _{_mtx};
+
+    auto root = _tracer->fork(_name);
+    for (auto& source : _sources)
+    {
+        auto node = root.branch(source.name);
+        source.ref->publish(node);
+    }
+}
+
+double tsc_ns_per_tick() noexcept
+{
+#if _MSC_VER or __x86_64__ or __i386__
+    static double const ratio = [] {
+        auto tsc_begin = tsc_now();
+        auto begin     = clock_type::now();
+
+        while (clock_type::now() - begin < 10ms) { std::this_thread::yield(); }
+
+        auto elapsed = std::chrono::duration<double, std::nano>(clock_type::now() - begin);
+        auto ticks   = tsc_now() - tsc_begin;
+
+        CPPH_DEBUG("tsc calibrated: {:.4f} ns/tick", elapsed.count() / ticks);
+        return elapsed.count() / ticks;
+    }();
+
+    return ratio;
+#else
+    return 1.;
+#endif
+}
+
+void publish_interval(std::chrono::milliseconds interval)
+{
+    publisher::get().interval(interval);
+}
+}  // namespace perfkit::metrics
@@ -3,8 +3,11 @@
 //
 #include "perfkit/terminal.h"
 
+#include <charconv>
+#include <cstdlib>
 #include <filesystem>
 #include <future>
+#include <map>
 #include <regex>
 
 #include <range/v3/algorithm.hpp>
@@ -16,8 +19,13 @@
 #include "perfkit/common/format.hxx"
 #include "perfkit/detail/base.hpp"
 #include "perfkit/detail/commands.hpp"
+#include "perfkit/detail/config_file_watcher.hpp"
 #include "perfkit/detail/configs.hpp"
+#include "perfkit/detail/controller.hpp"
+#include "perfkit/detail/experiment.hpp"
 #include "perfkit/detail/tracer.hpp"
+#include "perfkit/detail/tracer_group.hpp"
+#include "perfkit/detail/tuner.hpp"
 
 using namespace std::literals;
 
@@ -44,6 +52,22 @@ class _config_saveload_manager
         return perfkit::configs::export_to(path);
     }
 
+    bool watch(args_view args = {})
+    {
+        if (not args.empty() && args.front() == "off")
+        {
+            _watcher.reset();
+            return true;
+        }
+
+        auto path = args.empty() ? _latest : args.front();
+        if (path.empty()) { return false; }
+
+        _latest  = path;
+        _watcher = std::make_unique<configs::file_watcher>(_latest);
+        return true;
+    }
+
     void retrieve_filenames(args_view args, string_set& cands)
     {
         namespace fs = std::filesystem;
@@ -68,13 +92,15 @@ class _config_saveload_manager
 
    public:
     std::string _latest = {};
+    std::unique_ptr<configs::file_watcher> _watcher;
 };
 
 void register_conffile_io_commands(
         perfkit::if_terminal* ref,
         std::string_view cmd_load,
         std::string_view cmd_store,
-        std::string_view initial_path)
+        std::string_view initial_path,
+        std::string_view cmd_watch)
 {
     auto manip     = std::make_shared<_config_saveload_manager>();
     manip->_latest = initial_path;
@@ -91,6 +117,18 @@ void register_conffile_io_commands(
             [manip](auto&& tok, auto&& set) { return manip->retrieve_filenames(tok, set); });
 
     if (!node_load || !node_save) { throw command_already_exist_exception{}; }
+
+    if (cmd_watch.empty()) { return; }
+
+    auto node_watch = rootnode->add_subcommand(
+            std::string{cmd_watch},
+            [manip](auto&& tok) { return manip->watch(tok); },
+            [manip](auto&& tok, auto&& set) {
+                set.insert("off");
+                return manip->retrieve_filenames(tok, set);
+            });
+
+    if (!node_watch) { throw command_already_exist_exception{}; }
 }
 
 void register_logging_manip_command(if_terminal* ref, std::string_view cmd)
@@ -207,6 +245,12 @@ class _trace_manip
         {
             repos.insert(tracer->name());
         }
+
+        // list of tracer groups
+        for (auto const& group : tracer_group::all())
+        {
+            repos.insert(group->name());
+        }
     }
 
     bool invoke(args_view args)
@@ -259,6 +303,20 @@ class _trace_manip
 
         if (it == traces.end())
         {
+            auto groups   = tracer_group::all();
+            auto it_group = std::find_if(groups.begin(),
+                                         groups.end(),
+                                         [&](auto& p) {
+                                             return p->name() == args[0];
+                                         });
+
+            if (it_group != groups.end())
+            {
+                auto group = *it_group;
+                _async     = std::async(std::launch::async, [=] { _async_request_group(group, pattern, setter); });
+                return true;
+            }
+
             SPDLOG_LOGGER_ERROR(glog(), "name '{}' is not valid tracer name", args[0]);
             return false;
         }
@@ -340,6 +398,58 @@ class _trace_manip
         _ref->write(output);
     }
 
+    void _async_request_group(std::shared_ptr<tracer_group> ref, std::string pattern, std::optional<bool> setter)
+    {
+        std::promise<tracer_group::snapshot> promise;
+        auto fut          = promise.get_future();
+        auto valid_marker = std::make_shared<nullptr_t>();
+
+        ref->on_fetch
+                += [promise = &promise,
+                    valid   = std::weak_ptr{valid_marker}]  //
+                (auto const& snapshot) {
+                    if (not valid.expired())
+                        promise->set_value(snapshot);
+
+                    return false;
+                };
+
+        ref->request_fetch_data();
+
+        if (fut.wait_for(3s) == std::future_status::timeout)
+        {
+            SPDLOG_LOGGER_ERROR(glog(), "tracer group '{}' update timeout", ref->name());
+            return;
+        }
+
+        tracer_group::snapshot result = fut.get();
+
+        using namespace ranges;
+        std::regex match{pattern};
+        std::string output, data_str, full_key;
+        output << "\n"_fmt.s();
+
+        // nodes are in depth-first order, thus hierarchy of each node is its ancestors'.
+        std::vector<std::string_view> hierarchy;
+        for (auto& node : result)
+        {
+            hierarchy.resize(node.depth);
+            hierarchy.push_back(node.key);
+
+            full_key.clear();
+            for (auto c : hierarchy | views::join("."sv)) { full_key += c; }
+
+            if (not std::regex_match(full_key, match)) { continue; }
+            if (setter) { ref->subscribe(node.hash, *setter), node.subscribing = *setter; }
+
+            node.dump_data(data_str);
+            output << "{0:{1}}{2} {3}= {4}\n"_fmt
+                            % "" % (node.depth * 2) % node.key % (node.subscribing ? "(+) " : "") % data_str;
+        }
+
+        _ref->write(output);
+    }
+
    private:
     if_terminal* _ref;
     std::future<void> _async;
@@ -360,6 +470,132 @@ void initialize_with_basic_commands(if_terminal* ref)
     register_logging_manip_command(ref);
     register_trace_manip_command(ref);
     register_config_manip_command(ref);
+    register_experiment_command(ref);
+    register_tune_command(ref);
+    register_control_command(ref);
+}
+
+/**
+ * Parses point of time, which is duration ago with unit suffix (ms, s, m, h), or
+ * milliseconds since epoch if suffix is omitted.
+ */
+static bool _parse_time_point(std::string_view str, config_registry::clock::time_point* out)
+{
+    using namespace std::chrono;
+
+    int64_t number = 0;
+    auto end       = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, number);
+    if (ec != std::errc{} || number < 0) { return false; }
+
+    auto unit = std::string_view{ptr, size_t(end - ptr)};
+    auto now  = config_registry::clock::now();
+
+    if (unit.empty())
+        *out = config_registry::clock::time_point{duration_cast<config_registry::clock::duration>(milliseconds{number})};
+    else if (unit == "ms")
+        *out = now - milliseconds{number};
+    else if (unit == "s")
+        *out = now - seconds{number};
+    else if (unit == "m")
+        *out = now - minutes{number};
+    else if (unit == "h")
+        *out = now - hours{number};
+    else
+        return false;
+
+    return true;
+}
+
+static std::string _format_elapsed(config_registry::clock::duration elapsed)
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+
+    char buf[32];
+    snprintf(buf, sizeof buf, "%lld.%03llds ago", (long long)(ms / 1000), (long long)(ms % 1000));
+    return buf;
+}
+
+/**
+ * Checks whether set of registries differs from the one which subcommands were built from,
+ * then rebinds it to the current set.
+ */
+static bool _rebind_registries(std::vector<std::weak_ptr<config_registry>>* bound)
+{
+    auto registries = config_registry::bk_enumerate_registries();
+
+    bool is_bound = bound->size() == registries.size();
+    for (size_t i = 0; is_bound && i < bound->size(); ++i) { is_bound = (*bound)[i].lock() == registries[i]; }
+    if (is_bound) { return false; }
+
+    bound->assign(registries.begin(), registries.end());
+    return true;
+}
+
+/**
+ * Operation hook of a node whose subcommands are registries, where hook_factory(registry)
+ * gives hook which fills subcommands of each registry node, e.g. every config.
+ *
+ * Registry may carry huge number of configs, which must not be re-registered on every
+ * keystroke, thus registry nodes are rebuilt only when set of registries changes, and config
+ * nodes only when number of configs of the registry changes.
+ */
+template <typename Factory_>
+static auto _hook_enum_registries(Factory_ hook_factory)
+{
+    using node_type = commands::registry::node;
+
+    return [=, bound = std::vector<std::weak_ptr<config_registry>>{}](node_type* node_reg, args_view) mutable {
+        glog()->debug("registry hook: {}", (void*)node_reg);
+
+        auto _ = node_reg->acquire();
+        if (not _rebind_registries(&bound)) { return; }
+
+        node_reg->clear();
+        for (const auto& weak : bound)
+        {
+            auto registry = weak.lock();
+            if (not registry) { continue; }
+
+            auto node = node_reg->add_subcommand(registry->name());
+            node->reset_opreation_hook(
+                    [hook = hook_factory(registry), wrg = std::weak_ptr{registry}, num_bound = ~size_t{}](
+                            node_type* node_cfg, args_view args) mutable {
+                        auto rg = wrg.lock();
+                        if (not rg || rg->bk_all().size() == num_bound) { return; }
+
+                        node_cfg->clear();
+                        hook(node_cfg, args);
+                        num_bound = rg->bk_all().size();
+                    });
+        }
+    };
+}
+
+/**
+ * History is opt-in per config, thus history commands only cover configs which keep it.
+ * Checks given config, or whole registry if display key is empty, and reports why not.
+ */
+static bool _check_history(config_registry& rg, std::string_view display_key = {})
+{
+    if (display_key.empty())
+    {
+        auto& all = rg.bk_all();
+        if (std::any_of(all.begin(), all.end(), [](auto& pair) { return pair.second->max_history() > 0; }))
+            return true;
+
+        glog()->error("no config of '{}' keeps history, which is enabled by history() attribute", rg.name());
+        return false;
+    }
+
+    auto conf = rg.bk_find_disp(display_key);
+    if (conf && conf->max_history() == 0)
+    {
+        glog()->error("'{}' keeps no history, which is enabled by history() attribute", display_key);
+        return false;
+    }
+
+    return true;
 }
 
 void register_config_manip_command(if_terminal* ref, std::string_view cmd)
@@ -367,28 +603,16 @@ void register_config_manip_command(if_terminal* ref, std::string_view cmd)
     auto _locked  = ref->commands()->root()->acquire();
     auto node_cmd = ref->commands()->root()->add_subcommand(std::string{cmd});
 
-    auto node_set = node_cmd->add_subcommand("set");
-    auto node_get = node_cmd->add_subcommand("get");
+    auto node_set      = node_cmd->add_subcommand("set");
+    auto node_get      = node_cmd->add_subcommand("get");
+    auto node_history  = node_cmd->add_subcommand("history");
+    auto node_rollback = node_cmd->add_subcommand("rollback");
+    auto node_diff     = node_cmd->add_subcommand("diff");
 
     using node_type = commands::registry::node;
-    auto hook_enum_regs =
-            [](auto&& hook_factory) {
-                return [=](node_type* node_reg, auto&&) {
-                    glog()->debug("registry hook: {}", (void*)node_reg);
-
-                    auto _ = node_reg->acquire();
-                    node_reg->clear();
-
-                    for (const auto& registry : config_registry::bk_enumerate_registries())
-                    {
-                        auto node = node_reg->add_subcommand(registry->name());
-                        node->reset_opreation_hook(hook_factory(registry));
-                    }
-                };
-            };
 
     node_set->reset_opreation_hook(
-            hook_enum_regs([](std::weak_ptr<config_registry> wrg) {
+            _hook_enum_registries([](std::weak_ptr<config_registry> wrg) {
                 return [wrg](node_type* node_cfg, auto&&) {
                     glog()->debug("config hook: {}", (void*)node_cfg);
 
@@ -397,6 +621,8 @@ void register_config_manip_command(if_terminal* ref, std::string_view cmd)
 
                     for (const auto& [_, config] : rg->bk_all())
                     {
+                        if (config->max_history() == 0) { continue; }
+
                         node_cfg->add_subcommand(
                                 config->display_key(),
                                 [wconf = std::weak_ptr{config}](args_view args) {
@@ -418,14 +644,14 @@ void register_config_manip_command(if_terminal* ref, std::string_view cmd)
                                         return;
                                     }
 
-                                    conf->request_modify(std::move(parsed));
+                                    conf->request_modify(std::move(parsed), configs::change_source::terminal);
                                 });
                     }
                 };
             }));
 
     node_get->reset_opreation_hook(
-            hook_enum_regs([ref](std::weak_ptr<config_registry> wrg) {
+            _hook_enum_registries([ref](std::weak_ptr<config_registry> wrg) {
                 return [wrg, ref](node_type* node_cfg, auto&&) {
                     if (auto rg = wrg.lock())
                     {
@@ -492,6 +718,654 @@ void register_config_manip_command(if_terminal* ref, std::string_view cmd)
                             });
                 };
             }));
+
+    node_history->reset_opreation_hook(
+            _hook_enum_registries([ref](std::weak_ptr<config_registry> wrg) {
+                return [wrg, ref](node_type* node_cfg, auto&&) {
+                    auto rg = wrg.lock();
+                    if (not rg) { return; }
+
+                    for (const auto& [_, config] : rg->bk_all())
+                    {
+                        if (config->max_history() == 0) { continue; }
+
+                        node_cfg->add_subcommand(
+                                config->display_key(),
+                                [ref, wconf = std::weak_ptr{config}] {
+                                    auto conf = wconf.lock();
+                                    if (not conf) { return; }
+
+                                    auto now     = config_registry::clock::now();
+                                    auto history = conf->history();
+
+                                    std::string buf;
+                                    json value;
+                                    buf << "< {} >\n"_fmt % conf->display_key();
+
+                                    for (size_t i = 0; i < history.size(); ++i)
+                                    {
+                                        conf->serialize(history[i], value);
+                                        buf << " [{}] {} ({}) = {}\n"_fmt
+                                                        % i
+                                                        % _format_elapsed(now - history[i].timestamp)
+                                                        % configs::source_name(history[i].source)
+                                                        % value.dump();
+                                    }
+
+                                    ref->write(buf);
+                                });
+                    }
+
+                    node_cfg->reset_invoke_handler(
+                            [wrg](args_view args) {
+                                auto rg = wrg.lock();
+                                if (not rg) { return false; }
+
+                                if (args.size() == 1 && not _check_history(*rg, args[0])) { return false; }
+                                if (not _check_history(*rg)) { return false; }
+
+                                glog()->error("usage: history <registry> <config>");
+                                return false;
+                            });
+                };
+            }));
+
+    node_rollback->reset_opreation_hook(
+            _hook_enum_registries([](std::weak_ptr<config_registry> wrg) {
+                return [wrg](node_type* node_cfg, auto&&) {
+                    auto rg = wrg.lock();
+                    if (not rg) { return; }
+
+                    for (const auto& [_, config] : rg->bk_all())
+                    {
+                        if (config->max_history() == 0) { continue; }
+
+                        node_cfg->add_subcommand(
+                                config->display_key(),
+                                [wconf = std::weak_ptr{config}](args_view args) {
+                                    config_registry::clock::time_point at;
+                                    if (args.size() != 1 || not _parse_time_point(args[0], &at))
+                                    {
+                                        glog()->error("usage: rollback <registry> <config> <time>");
+                                        return false;
+                                    }
+
+                                    auto conf = wconf.lock();
+                                    if (not conf) { return false; }
+
+                                    if (not conf->request_rollback(at, configs::change_source::terminal))
+                                    {
+                                        glog()->error("history of '{}' doesn't cover given time", conf->display_key());
+                                        return false;
+                                    }
+
+                                    return true;
+                                });
+                    }
+
+                    node_cfg->reset_invoke_handler(
+                            [wrg](args_view args) {
+                                auto rg = wrg.lock();
+                                if (not rg) { return false; }
+
+                                if (args.size() == 2 && not _check_history(*rg, args[0])) { return false; }
+                                if (not _check_history(*rg)) { return false; }
+
+                                config_registry::clock::time_point at;
+                                if (args.size() != 1 || not _parse_time_point(args[0], &at))
+                                {
+                                    glog()->error("usage: rollback <registry> <time>");
+                                    return false;
+                                }
+
+                                auto num_queued = rg->bk_queue_rollback_all(at, configs::change_source::terminal);
+                                glog()->info("{} configs of '{}' are rolled back", num_queued, rg->name());
+                                return true;
+                            });
+                };
+            }));
+
+    node_diff->reset_opreation_hook(
+            _hook_enum_registries([ref](std::weak_ptr<config_registry> wrg) {
+                return [wrg, ref](node_type* node_cfg, auto&&) {
+                    node_cfg->reset_invoke_handler(
+                            [wrg, ref](args_view args) {
+                                config_registry::clock::time_point from, to = config_registry::clock::now();
+                                if (args.empty() || args.size() > 2
+                                    || not _parse_time_point(args[0], &from)
+                                    || (args.size() == 2 && not _parse_time_point(args[1], &to)))
+                                {
+                                    glog()->error("usage: diff <registry> <from> [to]");
+                                    return false;
+                                }
+
+                                auto rg = wrg.lock();
+                                if (not rg || not _check_history(*rg)) { return false; }
+
+                                std::string buf;
+                                for (auto& [key, values] : rg->bk_diff(from, to).items())
+                                    buf << " {}: {} -> {}\n"_fmt % key % values[0].dump() % values[1].dump();
+
+                                buf += "\n";
+                                ref->write(buf);
+                                return true;
+                            });
+                };
+            }));
+}
+
+static bool _parse_count(std::string_view str, size_t* out)
+{
+    auto end       = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, *out);
+    return ec == std::errc{} && ptr == end;
+}
+
+/** node of trace is given as its hierarchy joined with '.', as printed by trace command. */
+static std::vector<std::string> _split_node(std::string_view str)
+{
+    std::vector<std::string> node;
+    while (not str.empty())
+    {
+        auto pos = str.find('.');
+        node.emplace_back(str.substr(0, pos));
+        str = pos == str.npos ? std::string_view{} : str.substr(pos + 1);
+    }
+
+    return node;
+}
+
+static tracer_ptr _find_tracer(std::string_view name)
+{
+    auto tracers = tracer::all();
+    auto it      = std::find_if(tracers.begin(), tracers.end(),
+                                [&](auto& p) { return p->name() == name; });
+
+    return it != tracers.end() ? *it : nullptr;
+}
+
+class _experiment_manager
+{
+   public:
+    explicit _experiment_manager(if_terminal* ref) : _ref(ref) {}
+
+    bool start(config_shared_ptr const& conf, args_view args)
+    {
+        if (args.size() < 4 || args.size() > 5)
+        {
+            glog()->error("usage: start <registry> <config> <value-a> <value-b> <tracer> <node> [block-size]");
+            return false;
+        }
+
+        json values[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            values[i] = json::parse(args[i].begin(), args[i].end(), nullptr, false);
+            if (values[i].is_discarded())
+                return glog()->error("failed to parse value '{}'", args[i]), false;
+        }
+
+        auto trc = _find_tracer(args[2]);
+        if (not trc)
+            return glog()->error("name '{}' is not valid tracer name", args[2]), false;
+
+        auto node = _split_node(args[3]);
+
+        experiment::options opts;
+        if (args.size() == 5 && not _parse_count(args[4], &opts.block_size))
+            return glog()->error("invalid block size '{}'", args[4]), false;
+
+        std::lock_guard _{_mtx};
+        if (_current && not _current->finished())
+            return glog()->error("another experiment is running. stop it first."), false;
+
+        auto exp = experiment::start(conf, std::move(values[0]), std::move(values[1]),
+                                     std::move(trc), std::move(node), opts);
+        if (not exp) { return false; }
+
+        exp->on_finish += [ref = _ref, key = conf->display_key()](experiment::result const& res) {
+            ref->write(_format(key, res));
+            return false;
+        };
+
+        _current = std::move(exp);
+        _key     = conf->display_key();
+        return true;
+    }
+
+    bool status()
+    {
+        std::lock_guard _{_mtx};
+        if (not _current)
+            return glog()->error("no experiment has been started"), false;
+
+        _ref->write(_format(_key, _current->report()));
+        return true;
+    }
+
+    bool stop()
+    {
+        std::lock_guard _{_mtx};
+        if (not _current || _current->finished())
+            return glog()->error("no experiment is running"), false;
+
+        _current->stop();
+        return true;
+    }
+
+   private:
+    static std::string _format(std::string_view key, experiment::result const& res)
+    {
+        // timers are sampled in nanoseconds
+        auto unit  = res.is_timer ? "ms" : "";
+        auto scale = res.is_timer ? 1e-6 : 1.;
+
+        std::string buf;
+        buf << "\n< experiment {} : {} >\n"_fmt % key % to_string(res.state);
+
+        char const* names[] = {"a", "b"};
+        for (int i = 0; i < 2; ++i)
+        {
+            auto& arm = res.arms[i];
+            buf << " [{}] {} : n={} mean={:.4f}{} median={:.4f}{} stddev={:.4f}{}\n"_fmt
+                            % names[i] % arm.value.dump() % arm.count
+                            % (arm.mean * scale) % unit
+                            % (arm.median * scale) % unit
+                            % (arm.stddev * scale) % unit;
+        }
+
+        auto rel = res.arms[0].mean != 0 ? res.diff / res.arms[0].mean * 100. : 0.;
+        buf << " b - a = {:.4f}{} ({:+.2f}%), CI [{:.4f}, {:.4f}], z={:.3f}, p={:.4g}\n"_fmt
+                        % (res.diff * scale) % unit % rel
+                        % (res.ci_low * scale) % (res.ci_high * scale)
+                        % res.z % res.p_value;
+
+        return buf;
+    }
+
+   private:
+    if_terminal* _ref;
+
+    std::mutex _mtx;
+    std::shared_ptr<experiment> _current;
+    std::string _key;
+};
+
+void register_experiment_command(if_terminal* ref, std::string_view cmd)
+{
+    auto _locked  = ref->commands()->root()->acquire();
+    auto node_cmd = ref->commands()->root()->add_subcommand(std::string{cmd});
+    auto manager  = std::make_shared<_experiment_manager>(ref);
+
+    node_cmd->add_subcommand("status", [manager](args_view) { return manager->status(); });
+    node_cmd->add_subcommand("stop", [manager](args_view) { return manager->stop(); });
+
+    using node_type = commands::registry::node;
+    node_cmd->add_subcommand("start")->reset_opreation_hook(
+            _hook_enum_registries([manager](std::weak_ptr<config_registry> wrg) {
+                return [manager, wrg](node_type* node_cfg, auto&&) {
+                    auto rg = wrg.lock();
+                    if (not rg) { return; }
+
+                    for (const auto& [_, config] : rg->bk_all())
+                    {
+                        node_cfg->add_subcommand(
+                                config->display_key(),
+                                [manager, wconf = std::weak_ptr{config}](args_view args) {
+                                    auto conf = wconf.lock();
+                                    return conf && manager->start(conf, args);
+                                });
+                    }
+                };
+            }));
+}
+
+class _tune_manager
+{
+   public:
+    explicit _tune_manager(if_terminal* ref) : _ref(ref) {}
+
+    bool start(std::shared_ptr<config_registry> const& rg, args_view args)
+    {
+        auto usage = [] {
+            glog()->error("usage: start <registry> <config>... minimize|maximize <tracer> <node> [iterations] [budget]");
+            return false;
+        };
+
+        auto it_goal = std::find_if(args.begin(), args.end(),
+                                    [](auto& s) { return s == "minimize" || s == "maximize"; });
+
+        auto num_confs = size_t(it_goal - args.begin());
+        if (num_confs == 0 || it_goal == args.end()) { return usage(); }
+
+        auto rest = args.subspan(num_confs + 1);
+        if (rest.size() < 2 || rest.size() > 4) { return usage(); }
+
+        std::vector<config_shared_ptr> confs;
+        for (auto key : args.subspan(0, num_confs))
+        {
+            auto& conf = rg->bk_find_disp(key);
+            if (not conf) { return glog()->error("config '{}' not found", key), false; }
+
+            confs.push_back(conf);
+        }
+
+        auto trc = _find_tracer(rest[0]);
+        if (not trc) { return glog()->error("name '{}' is not valid tracer name", rest[0]), false; }
+
+        tuner::options opts;
+        opts.maximize = *it_goal == "maximize";
+
+        if (rest.size() > 2 && not _parse_count(rest[2], &opts.iterations)) { return usage(); }
+        if (rest.size() > 3 && not _parse_count(rest[3], &opts.budget)) { return usage(); }
+
+        std::lock_guard _{_mtx};
+        if (_current && not _current->finished())
+            return glog()->error("another tuning is running. stop it first."), false;
+
+        auto tune = tuner::start(std::move(confs), std::move(trc), _split_node(rest[1]), opts);
+        if (not tune) { return false; }
+
+        tune->on_progress += [ref = _ref](tuner::progress const& prog) {
+            ref->write(_format(prog));
+            return true;
+        };
+
+        tune->on_finish += [ref = _ref](tuner::result const& res) {
+            ref->write(_format(res));
+            return false;
+        };
+
+        _current = std::move(tune);
+        return true;
+    }
+
+    bool status()
+    {
+        std::lock_guard _{_mtx};
+        if (not _current)
+            return glog()->error("no tuning has been started"), false;
+
+        _ref->write(_format(_current->report()));
+        return true;
+    }
+
+    bool stop()
+    {
+        std::lock_guard _{_mtx};
+        if (not _current || _current->finished())
+            return glog()->error("no tuning is running"), false;
+
+        _current->stop();
+        return true;
+    }
+
+   private:
+    static std::string _format_score(double score, bool is_timer)
+    {
+        // timers are sampled in nanoseconds
+        std::string buf;
+        if (is_timer)
+            buf << "{:.4f} ms"_fmt % (score * 1e-6);
+        else
+            buf << "{:.4g}"_fmt % score;
+
+        return buf;
+    }
+
+    static std::string _format(tuner::progress const& prog)
+    {
+        std::string buf;
+        if (prog.key.empty())
+            buf << " [baseline] {}"_fmt % _format_score(prog.score, prog.is_timer);
+        else
+            buf << " [round {}, level {}] {} = {} : {} (baseline {})"_fmt
+                            % prog.round % prog.level % prog.key % prog.value.dump()
+                            % _format_score(prog.score, prog.is_timer)
+                            % _format_score(prog.baseline, prog.is_timer);
+
+        buf << ", {}/{}\n"_fmt % prog.used % prog.budget;
+        return buf;
+    }
+
+    static std::string _format(tuner::result const& res)
+    {
+        std::string buf;
+        buf << "\n< tune : {} >\n"_fmt % to_string(res.state);
+        buf << " best     : {}\n"_fmt % res.best.dump();
+        buf << " score    : {} (baseline {})\n"_fmt
+                        % _format_score(res.best_score, res.is_timer)
+                        % _format_score(res.baseline, res.is_timer);
+        buf << " measured : {} candidates in {} rounds, {}/{} samples\n"_fmt
+                        % res.num_measured % (res.round + 1) % res.used % res.budget;
+        return buf;
+    }
+
+   private:
+    if_terminal* _ref;
+
+    std::mutex _mtx;
+    std::shared_ptr<tuner> _current;
+};
+
+void register_tune_command(if_terminal* ref, std::string_view cmd)
+{
+    auto _locked  = ref->commands()->root()->acquire();
+    auto node_cmd = ref->commands()->root()->add_subcommand(std::string{cmd});
+    auto manager  = std::make_shared<_tune_manager>(ref);
+
+    node_cmd->add_subcommand("status", [manager](args_view) { return manager->status(); });
+    node_cmd->add_subcommand("stop", [manager](args_view) { return manager->stop(); });
+
+    using node_type = commands::registry::node;
+    node_cmd->add_subcommand("start")->reset_opreation_hook(
+            [manager, bound = std::vector<std::weak_ptr<config_registry>>{}](node_type* node_reg, auto&&) mutable {
+                auto _ = node_reg->acquire();
+                if (not _rebind_registries(&bound)) { return; }
+
+                node_reg->clear();
+                for (const auto& registry : config_registry::bk_enumerate_registries())
+                {
+                    auto node = node_reg->add_subcommand(
+                            registry->name(),
+                            [manager, wrg = std::weak_ptr{registry}](args_view args) {
+                                auto rg = wrg.lock();
+                                return rg && manager->start(rg, args);
+                            });
+
+                    node->reset_suggest_index(
+                            [wrg = std::weak_ptr{registry}](args_view, string_set& cands) {
+                                cands.insert("minimize"), cands.insert("maximize");
+                                if (auto rg = wrg.lock())
+                                    for (auto& [_, conf] : rg->bk_all()) { cands.insert(std::string{conf->display_key()}); }
+                            });
+                }
+            });
+}
+
+/** setpoint of timer is given with unit suffix, and converted to nanoseconds. */
+static bool _parse_setpoint(std::string_view str, double* out)
+{
+    static constexpr std::pair<std::string_view, double> units[] = {
+            {"ns", 1}, {"us", 1e3}, {"ms", 1e6}, {"s", 1e9}};
+
+    double scale = 1;
+    for (auto [suffix, value] : units)
+    {
+        if (str.size() > suffix.size() && str.substr(str.size() - suffix.size()) == suffix)
+        {
+            str.remove_suffix(suffix.size()), scale = value;
+            break;
+        }
+    }
+
+    std::string buf{str};
+    char* end = nullptr;
+    *out      = std::strtod(buf.c_str(), &end) * scale;
+    return not buf.empty() && end == buf.c_str() + buf.size() && *out != 0;
+}
+
+class _control_manager
+{
+   public:
+    explicit _control_manager(if_terminal* ref) : _ref(ref) {}
+
+    bool start(std::shared_ptr<config_registry> const& rg, args_view args)
+    {
+        auto usage = [] {
+            glog()->error("usage: start <registry> <config> <tracer> <node> <setpoint> [pid|aimd] [inverse]");
+            return false;
+        };
+
+        if (args.size() < 4 || args.size() > 6) { return usage(); }
+
+        auto& conf = rg->bk_find_disp(args[0]);
+        if (not conf) { return glog()->error("config '{}' not found", args[0]), false; }
+
+        auto trc = _find_tracer(args[1]);
+        if (not trc) { return glog()->error("name '{}' is not valid tracer name", args[1]), false; }
+
+        controller::options opts;
+        if (not _parse_setpoint(args[3], &opts.setpoint)) { return usage(); }
+
+        for (auto arg : args.subspan(4))
+        {
+            if (arg == "pid")
+                opts.policy = controller::options::pid;
+            else if (arg == "aimd")
+                opts.policy = controller::options::aimd;
+            else if (arg == "inverse")
+                opts.inverse = true;
+            else
+                return usage();
+        }
+
+        std::lock_guard _{_mtx};
+        if (_controllers.count(conf->display_key()))
+            return glog()->error("'{}' is already controlled. stop it first.", conf->display_key()), false;
+
+        auto ctrl = controller::start(conf, std::move(trc), _split_node(args[2]), opts);
+        if (not ctrl) { return false; }
+
+        _controllers.emplace(ctrl->name(), std::move(ctrl));
+        return true;
+    }
+
+    bool setpoint(args_view args)
+    {
+        double value = 0;
+        if (args.size() != 2 || not _parse_setpoint(args[1], &value))
+            return glog()->error("usage: setpoint <config> <setpoint>"), false;
+
+        std::lock_guard _{_mtx};
+        auto it = _controllers.find(args[0]);
+        if (it == _controllers.end()) { return glog()->error("'{}' is not controlled", args[0]), false; }
+
+        it->second->setpoint(value);
+        return true;
+    }
+
+    bool stop(args_view args)
+    {
+        if (args.size() != 1) { return glog()->error("usage: stop <config>"), false; }
+
+        std::shared_ptr<controller> ctrl;
+        {
+            std::lock_guard _{_mtx};
+            auto it = _controllers.find(args[0]);
+            if (it == _controllers.end()) { return glog()->error("'{}' is not controlled", args[0]), false; }
+
+            ctrl = std::move(it->second);
+            _controllers.erase(it);
+        }
+
+        // joins worker of the controller out of lock
+        ctrl.reset();
+        return true;
+    }
+
+    bool list()
+    {
+        std::string buf;
+        std::lock_guard _{_mtx};
+
+        for (auto& [key, ctrl] : _controllers)
+        {
+            auto st = ctrl->report();
+            buf << " {} : {} (setpoint {}), value {:.4g}, {} changes in {} steps\n"_fmt
+                            % key
+                            % _format_metric(st.measured, st.is_timer)
+                            % _format_metric(st.setpoint, st.is_timer)
+                            % st.output % st.num_changes % st.num_steps;
+        }
+
+        _ref->write(buf.empty() ? std::string{" no controller is running\n"} : buf);
+        return true;
+    }
+
+    void suggest(string_set& cands)
+    {
+        std::lock_guard _{_mtx};
+        for (auto& [key, _] : _controllers) { cands.insert(key); }
+    }
+
+   private:
+    static std::string _format_metric(double value, bool is_timer)
+    {
+        std::string buf;
+        if (is_timer)
+            buf << "{:.4f} ms"_fmt % (value * 1e-6);
+        else
+            buf << "{:.4g}"_fmt % value;
+
+        return buf;
+    }
+
+   private:
+    if_terminal* _ref;
+
+    std::mutex _mtx;
+    std::map<std::string, std::shared_ptr<controller>, std::less<>> _controllers;
+};
+
+void register_control_command(if_terminal* ref, std::string_view cmd)
+{
+    auto _locked  = ref->commands()->root()->acquire();
+    auto node_cmd = ref->commands()->root()->add_subcommand(std::string{cmd});
+    auto manager  = std::make_shared<_control_manager>(ref);
+
+    node_cmd->add_subcommand("list", [manager](args_view) { return manager->list(); });
+
+    auto suggest = [manager](args_view, string_set& cands) { manager->suggest(cands); };
+    node_cmd->add_subcommand("stop", [manager](args_view args) { return manager->stop(args); })
+            ->reset_suggest_handler(suggest);
+    node_cmd->add_subcommand("setpoint", [manager](args_view args) { return manager->setpoint(args); })
+            ->reset_suggest_handler(suggest);
+
+    using node_type = commands::registry::node;
+    node_cmd->add_subcommand("start")->reset_opreation_hook(
+            [manager, bound = std::vector<std::weak_ptr<config_registry>>{}](node_type* node_reg, auto&&) mutable {
+                auto _ = node_reg->acquire();
+                if (not _rebind_registries(&bound)) { return; }
+
+                node_reg->clear();
+                for (const auto& registry : config_registry::bk_enumerate_registries())
+                {
+                    auto node = node_reg->add_subcommand(
+                            registry->name(),
+                            [manager, wrg = std::weak_ptr{registry}](args_view args) {
+                                auto rg = wrg.lock();
+                                return rg && manager->start(rg, args);
+                            });
+
+                    node->reset_suggest_index(
+                            [wrg = std::weak_ptr{registry}](args_view, string_set& cands) {
+                                cands.insert("pid"), cands.insert("aimd"), cands.insert("inverse");
+                                if (auto rg = wrg.lock())
+                                    for (auto& [_, conf] : rg->bk_all()) { cands.insert(std::string{conf->display_key()}); }
+                            });
+                }
+            });
 }
 
 }  // namespace perfkit::terminal
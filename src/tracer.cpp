@@ -5,6 +5,10 @@
 
 #include <future>
 #include <mutex>
+#include <new>
+#include <set>
+#include <sstream>
+#include <unordered_map>
 #include <variant>
 
 #include <nlohmann/detail/conversions/from_json.hpp>
@@ -16,6 +20,7 @@
 #include "perfkit/common/macros.hxx"
 #include "perfkit/common/template_utils.hxx"
 #include "perfkit/detail/base.hpp"
+#include "perfkit/detail/histogram.hpp"
 
 #define CPPH_LOGGER() perfkit::glog()
 
@@ -24,8 +29,64 @@ using namespace perfkit;
 
 struct tracer::_impl
 {
+    struct async_stat
+    {
+        histogram latency;
+        _trace::async_record latest;
+    };
+
+    // finished async spans from arbitrary threads
+    spinlock async_lock;
+    std::vector<_trace::async_record> async_queue;
+    std::vector<_trace::async_record> async_swap;
+
+    // Fixed size state of deadline-aware nodes
+    struct deadline_stat
+    {
+        histogram deviation;
+        int64_t num_misses     = 0;
+        int64_t streak         = 0;
+        int64_t longest_streak = 0;
+
+        void record(bool missed, clock_type::duration deviation_abs) noexcept
+        {
+            deviation.record(deviation_abs);
+
+            if (missed)
+            {
+                ++num_misses;
+                longest_streak = std::max(longest_streak, ++streak);
+            }
+            else
+            {
+                streak = 0;
+            }
+        }
+
+        // deviation_names: names of P50, P99, Max node of deviation respectively.
+        template <typename Put_>
+        void publish(Put_&& put, std::string_view const (&deviation_names)[3]) const
+        {
+            using ns = std::chrono::nanoseconds;
+            put("__Misses", num_misses);
+            put("__Miss_Streak", streak);
+            put("__Longest_Miss_Streak", longest_streak);
+            put(deviation_names[0], clock_type::duration{ns(deviation.percentile(.5))});
+            put(deviation_names[1], clock_type::duration{ns(deviation.percentile(.99))});
+            put(deviation_names[2], clock_type::duration{ns(deviation.max())});
+        }
+    };
+
+    // accessed only from fork()ed thread
+    std::unordered_map<_trace::_entity_ty const*, async_stat> async_stats;
+    std::unordered_map<_trace::_entity_ty const*, deadline_stat> deadline_stats;
+
+    clock_type::duration expected_period  = {};
+    clock_type::duration period_tolerance = {};
+    deadline_stat period_stat;
 };
 
+
 tracer::_entity_ty* tracer::_fork_branch(
         _entity_ty const* parent, std::string_view name, bool initial_subscribe_state)
 {
@@ -93,6 +154,9 @@ tracer_proxy tracer::fork(std::string_view n, size_t interval)
     // Store current thread id
     _working_thread_id = std::this_thread::get_id();
 
+    if (not on_iteration.empty() && _fence_active > 0)
+        on_iteration.invoke(*this);
+
     // init new iteration
     ++_fence_active;
     _order_active = 0;
@@ -106,9 +170,175 @@ tracer_proxy tracer::fork(std::string_view n, size_t interval)
     tracer_proxy total_timer       = branch("__Time_Since_Last_Iteration");
     total_timer._epoch_if_required = last_fork;
 
+    if (self->expected_period.count() && last_fork != clock_type::time_point{})
+        _on_iteration_period(total_timer._ref, _last_fork - last_fork);
+
+    _flush_async_records();
     return prx;
 }
 
+auto tracer::find(array_view<std::string_view> hierarchy) const noexcept -> trace const*
+{
+    if (hierarchy.empty()) { return nullptr; }
+
+    // root hash doesn't depend on its name, thus compare it explicitly.
+    auto hash = hasher::FNV_OFFSET_BASE;
+    auto it   = _table.find(hash);
+    if (it == _table.end() || it->second.body.key != hierarchy[0]) { return nullptr; }
+
+    for (size_t i = 1; i < hierarchy.size(); ++i)
+    {
+        for (auto c : hierarchy[i]) { hash = hasher::fnv1a_byte(c, hash); }
+        if ((it = _table.find(hash)) == _table.end()) { return nullptr; }
+    }
+
+    return &it->second.body;
+}
+
+tracer_async_span tracer::_new_async_span(_entity_ty const* parent, std::string_view name)
+{
+    tracer_async_span span;
+    span._ref = _fork_branch(parent, name, false);
+    _try_pop(span._ref);
+
+    span._owner        = weak_from_this();
+    span._thread_begin = std::this_thread::get_id();
+    span._epoch        = clock_type::now();
+    return span;
+}
+
+void tracer::_queue_async_record(_trace::async_record const& record)
+{
+    std::lock_guard _{self->async_lock};
+    self->async_queue.push_back(record);
+}
+
+void tracer::_flush_async_records()
+{
+    {
+        std::lock_guard _{self->async_lock};
+        if (self->async_queue.empty()) { return; }
+
+        self->async_swap.swap(self->async_queue);
+    }
+
+    std::set<_entity_ty*> updated;
+    for (auto& record : self->async_swap)
+    {
+        auto& stat  = self->async_stats[record.node];
+        stat.latest = record;
+        stat.latency.record(record.elapsed);
+        updated.insert(record.node);
+    }
+
+    self->async_swap.clear();
+
+    auto put = [this](_entity_ty* parent, std::string_view name, auto&& value) {
+        auto node = _fork_branch(parent, name, false);
+        _try_pop(node);
+        node->body.data = std::forward<decltype(value)>(value);
+    };
+
+    auto to_string = [](std::thread::id id) {
+        std::ostringstream strm;
+        strm << id;
+        return strm.str();
+    };
+
+    for (auto node : updated)
+    {
+        auto& stat = self->async_stats[node];
+        auto& hist = stat.latency;
+
+        node->body.fence = _fence_active;
+        node->body.data  = stat.latest.elapsed;
+
+        using ns = std::chrono::nanoseconds;
+        put(node, "__Count", int64_t(hist.count()));
+        put(node, "__P50", clock_type::duration{ns(hist.percentile(.5))});
+        put(node, "__P99", clock_type::duration{ns(hist.percentile(.99))});
+        put(node, "__Max", clock_type::duration{ns(hist.max())});
+        put(node, "__Thread_Begin", to_string(stat.latest.thread_begin));
+        put(node, "__Thread_End", to_string(stat.latest.thread_end));
+    }
+}
+
+void tracer::expected_period(clock_type::duration period, clock_type::duration tolerance)
+{
+    self->expected_period  = period;
+    self->period_tolerance = tolerance;
+    self->period_stat      = {};
+}
+
+void tracer::_on_iteration_period(_entity_ty* node, clock_type::duration elapsed)
+{
+    auto& stat     = self->period_stat;
+    auto deviation = elapsed - self->expected_period;
+
+    stat.record(deviation > self->period_tolerance, deviation < deviation.zero() ? -deviation : deviation);
+    stat.publish(
+            [&](auto&& name, auto&& value) {
+                auto child = _fork_branch(node, name, false);
+                _try_pop(child);
+                child->body.data = value;
+            },
+            {"__Jitter_P50", "__Jitter_P99", "__Jitter_Max"});
+}
+
+void tracer::_on_deadline_timer(_entity_ty* node, clock_type::duration elapsed, clock_type::duration deadline)
+{
+    auto& stat  = self->deadline_stats[node];
+    bool missed = elapsed > deadline;
+
+    stat.record(missed, missed ? elapsed - deadline : clock_type::duration{});
+    stat.publish(
+            [&](auto&& name, auto&& value) {
+                auto child = _fork_branch(node, name, false);
+                _try_pop(child);
+                child->body.data = value;
+            },
+            {"__Overrun_P50", "__Overrun_P99", "__Overrun_Max"});
+}
+
+tracer_async_span& tracer_async_span::operator=(tracer_async_span&& o) noexcept
+{
+    finish();
+    _owner        = std::move(o._owner);
+    _ref          = o._ref;
+    _epoch        = o._epoch;
+    _thread_begin = o._thread_begin;
+
+    o._owner.reset();
+    o._ref = nullptr;
+    return *this;
+}
+
+void tracer_async_span::finish() noexcept
+{
+    if (not _ref) { return; }
+
+    if (auto owner = _owner.lock())
+    {
+        _trace::async_record record;
+        record.node         = _ref;
+        record.elapsed      = clock_type::now() - _epoch;
+        record.thread_begin = _thread_begin;
+        record.thread_end   = std::this_thread::get_id();
+
+        // called from destructor, thus record is dropped if queue can't grow.
+        try
+        {
+            owner->_queue_async_record(record);
+        }
+        catch (std::bad_alloc&)
+        {
+        }
+    }
+
+    _owner.reset();
+    _ref = nullptr;
+}
+
 bool tracer::_deliver_previous_result()
 {  // perform queued sort-merge operation
     if (not _pending_fetch.exchange(false))
@@ -238,6 +468,13 @@ tracer_proxy perfkit::tracer::timer(std::string_view name)
     return px;
 }
 
+tracer_proxy perfkit::tracer::timer(std::string_view name, clock_type::duration deadline)
+{
+    auto px      = timer(name);
+    px._deadline = deadline;
+    return px;
+}
+
 tracer_proxy perfkit::tracer::branch(std::string_view name)
 {
     tracer_proxy px;
@@ -256,6 +493,17 @@ tracer::proxy tracer::proxy::branch(std::string_view n) noexcept
     return px;
 }
 
+tracer_async_span perfkit::tracer::async_span(std::string_view name)
+{
+    return _new_async_span(_stack.back(), name);
+}
+
+tracer_async_span tracer::proxy::async_span(std::string_view n) noexcept
+{
+    if (not is_valid()) { return {}; }
+    return _owner->_new_async_span(_ref, n);
+}
+
 tracer::proxy tracer::proxy::timer(std::string_view n) noexcept
 {
     if (not is_valid()) { return {}; }
@@ -267,6 +515,13 @@ tracer::proxy tracer::proxy::timer(std::string_view n) noexcept
     return px;
 }
 
+tracer::proxy tracer::proxy::timer(std::string_view n, clock_type::duration deadline) noexcept
+{
+    auto px      = timer(n);
+    px._deadline = deadline;
+    return px;
+}
+
 tracer_proxy::~tracer_proxy() noexcept
 {
     if (!_owner) { return; }
@@ -274,12 +529,17 @@ tracer_proxy::~tracer_proxy() noexcept
 
     if (_epoch_if_required != clock_type::time_point{})
     {
-        _data() = clock_type::now() - _epoch_if_required;
+        auto elapsed = clock_type::now() - _epoch_if_required;
+        _data()      = elapsed;
+
+        if (_deadline.count())
+            _owner->_on_deadline_timer(_ref, elapsed, _deadline);
     }
 
     // clear to prevent logic error
-    _owner = nullptr;
-    _ref   = nullptr;
+    _owner    = nullptr;
+    _ref      = nullptr;
+    _deadline = {};
 }
 
 tracer::variant_type& tracer::proxy::_data() noexcept
@@ -0,0 +1,351 @@
+#include "perfkit/detail/tracer_group.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+#include "perfkit/common/macros.hxx"
+#include "perfkit/detail/base.hpp"
+
+#define CPPH_LOGGER() perfkit::glog()
+
+using namespace perfkit;
+
+namespace {
+auto lock_group_repo()
+{
+    static std::mutex _lck;
+    return std::unique_lock{_lck};
+}
+
+std::vector<std::weak_ptr<tracer_group>>& all_groups()
+{
+    static std::vector<std::weak_ptr<tracer_group>> inst;
+    return inst;
+}
+}  // namespace
+
+tracer_group::tracer_group(std::string name)
+        : _name(std::move(name))
+{
+}
+
+tracer_group::~tracer_group() noexcept
+{
+    {
+        std::lock_guard _{_mtx};
+        _active = false;
+        _cvar.notify_all();
+    }
+
+    _worker.joinable() && (_worker.join(), 0);
+
+    auto _{lock_group_repo()};
+    auto& all = all_groups();
+    all.erase(std::remove_if(all.begin(), all.end(), [](auto&& w) { return w.expired(); }),
+              all.end());
+}
+
+auto tracer_group::create(std::string name) -> std::shared_ptr<tracer_group>
+{
+    CPPH_DEBUG("creating tracer group {}", name);
+
+    std::shared_ptr<tracer_group> group{new tracer_group{std::move(name)}};
+    group->_worker = std::thread{[ptr = group.get()] { ptr->_worker_fn(); }};
+
+    auto _{lock_group_repo()};
+    all_groups().push_back(group);
+    return group;
+}
+
+auto tracer_group::all() noexcept -> std::vector<std::shared_ptr<tracer_group>>
+{
+    auto _{lock_group_repo()};
+
+    std::vector<std::shared_ptr<tracer_group>> out;
+    out.reserve(all_groups().size());
+
+    for (auto& wptr : all_groups())
+        if (auto ptr = wptr.lock())
+            out.push_back(std::move(ptr));
+
+    return out;
+}
+
+void tracer_group::add(std::shared_ptr<tracer> member)
+{
+    auto raw = member.get();
+
+    {
+        std::lock_guard _{_mtx};
+        auto& elem = _members.emplace_back(std::make_unique<_member>());
+        elem->ref  = std::move(member);
+    }
+
+    raw->on_fetch +=
+            [wself = weak_from_this(), raw]  //
+            (tracer::fetched_traces const& traces) {
+                if (auto self = wself.lock())
+                    return self->_on_member_fetch(raw, traces);
+                else
+                    return false;
+            };
+}
+
+void tracer_group::remove(tracer const* member)
+{
+    std::lock_guard _{_mtx};
+
+    auto it = std::find_if(_members.begin(), _members.end(),
+                           [&](auto&& elem) { return elem->ref.get() == member; });
+
+    if (it != _members.end()) { _members.erase(it); }
+}
+
+size_t tracer_group::size() const
+{
+    std::lock_guard _{_mtx};
+    return _members.size();
+}
+
+void tracer_group::request_fetch_data()
+{
+    std::vector<std::shared_ptr<tracer>> members;
+
+    {
+        std::lock_guard _{_mtx};
+        ++_fence_request;
+
+        members.reserve(_members.size());
+        for (auto& elem : _members) { members.push_back(elem->ref); }
+
+        _cvar.notify_all();
+    }
+
+    for (auto& member : members) { member->request_fetch_data(); }
+}
+
+void tracer_group::subscribe(uint64_t hash, bool enabled)
+{
+    std::lock_guard _{_mtx};
+
+    for (auto& elem : _members)
+        if (auto it = elem->subscriptions.find(hash); it != elem->subscriptions.end())
+            it->second->store(enabled, std::memory_order_relaxed);
+}
+
+bool tracer_group::_on_member_fetch(tracer const* member, tracer::fetched_traces const& traces)
+{
+    std::lock_guard _{_mtx};
+
+    auto it = std::find_if(_members.begin(), _members.end(),
+                           [&](auto&& elem) { return elem->ref.get() == member; });
+
+    if (it == _members.end())
+        return false;  // member removed. unregister this handler.
+
+    auto& elem = **it;
+    elem.traces.clear();
+    elem.traces.reserve(traces.size());
+
+    for (auto& trace : traces)
+    {
+        auto& dst        = elem.traces.emplace_back();
+        dst.hash         = trace.hash;
+        dst.parent_hash  = trace.owner_node ? trace.owner_node->hash : 0;
+        dst.depth        = trace.hierarchy.size() - 1;
+        dst.unique_order = trace.unique_order;
+        dst.key          = trace.key;
+        dst.data         = trace.data;
+        dst.subscribing  = trace.subscribing();
+
+        elem.subscriptions.try_emplace(trace.hash, trace._bk_p_subscribed());
+    }
+
+    elem.fence_received = _fence_request;
+    _cvar.notify_all();
+    return true;
+}
+
+void tracer_group::_worker_fn()
+{
+    std::vector<_merge_source> sources;
+
+    for (std::unique_lock lc{_mtx}; _active;)
+    {
+        _cvar.wait(lc, [&] { return not _active || _fence_request != _fence_merged; });
+        if (not _active) { break; }
+
+        // wait until every member delivers its result, or timeout expires.
+        auto fence = _fence_request;
+        _cvar.wait_for(
+                lc, _member_timeout,
+                [&] {
+                    return not _active
+                        || std::all_of(_members.begin(), _members.end(),
+                                       [&](auto&& elem) { return elem->fence_received >= fence; });
+                });
+
+        if (not _active) { break; }
+        _fence_merged = fence;
+
+        // swap out received traces, to prevent blocking member threads during merge
+        sources.resize(_members.size());
+        size_t num_sources = 0;
+
+        for (auto& elem : _members)
+        {
+            if (elem->fence_received == 0) { continue; }  // never received anything
+
+            auto& src = sources[num_sources++];
+            src.ref   = elem->ref;
+            src.traces.swap(elem->traces);
+            elem->traces.clear();
+        }
+
+        sources.resize(num_sources);
+
+        lc.unlock();
+        {
+            _merge(sources, &_reused_snapshot);
+            on_fetch.invoke(_reused_snapshot);
+
+            for (auto& src : sources) { src.ref.reset(); }
+        }
+        lc.lock();
+    }
+}
+
+void tracer_group::_merge(std::vector<_merge_source> const& sources, snapshot* out)
+{
+    std::unordered_map<uint64_t, size_t> indices;
+    snapshot merged;
+
+    for (auto& src : sources)
+    {
+        for (auto& trace : src.traces)
+        {
+            auto [it, is_new] = indices.try_emplace(trace.hash, merged.size());
+            if (is_new)
+            {
+                auto& node        = merged.emplace_back();
+                node.key          = trace.key;
+                node.hash         = trace.hash;
+                node.parent_hash  = trace.parent_hash;
+                node.depth        = trace.depth;
+                node.unique_order = trace.unique_order;
+            }
+
+            auto& node = merged[it->second];
+            node.subscribing |= trace.subscribing;
+
+            double value = 0;
+            auto type    = value_type::none;
+
+            std::visit(
+                    [&](auto&& v) {
+                        using type_t = std::decay_t<decltype(v)>;
+
+                        if constexpr (std::is_same_v<type_t, clock_type::duration>)
+                            type = value_type::duration, value = std::chrono::duration<double>(v).count();
+                        else if constexpr (std::is_same_v<type_t, int64_t>)
+                            type = value_type::integer, value = double(v);
+                        else if constexpr (std::is_same_v<type_t, double>)
+                            type = value_type::floating_point, value = v;
+                        else if constexpr (std::is_same_v<type_t, bool>)
+                            type = value_type::boolean, value = v;
+                        else if constexpr (std::is_same_v<type_t, std::string>)
+                            type = value_type::string;
+                    },
+                    trace.data);
+
+            if (type == value_type::none) { continue; }
+            if (node.type == value_type::none) { node.type = type; }
+            if (node.type != type) { continue; }  // schema mismatch on this node; skip.
+
+            if (type == value_type::string)
+            {
+                if (node.num_instances++ == 0) { node.sample = std::get<std::string>(trace.data); }
+                continue;
+            }
+
+            if (node.num_instances++ == 0)
+            {
+                node.min             = value;
+                node.max             = value;
+                node.argmax_instance = src.ref->name();
+            }
+            else
+            {
+                node.min = std::min(node.min, value);
+                if (value > node.max)
+                {
+                    node.max             = value;
+                    node.argmax_instance = src.ref->name();
+                }
+            }
+
+            node.sum += value;
+        }
+    }
+
+    for (auto& node : merged)
+        if (node.num_instances) { node.mean = node.sum / node.num_instances; }
+
+    // sort in depth-first order, siblings ordered by their first occurrence.
+    std::unordered_multimap<uint64_t, size_t> children;
+    for (size_t i = 0; i < merged.size(); ++i)
+        if (merged[i].depth > 0) { children.emplace(merged[i].parent_hash, i); }
+
+    out->clear();
+    out->reserve(merged.size());
+
+    std::vector<size_t> stack, siblings;
+    for (size_t i = 0; i < merged.size(); ++i)
+        if (merged[i].depth == 0) { stack.push_back(i); }
+
+    while (not stack.empty())
+    {
+        auto index = stack.back();
+        stack.pop_back();
+
+        auto [begin, end] = children.equal_range(merged[index].hash);
+        siblings.clear();
+        std::transform(begin, end, std::back_inserter(siblings), [](auto&& p) { return p.second; });
+        std::sort(siblings.begin(), siblings.end(),
+                  [&](auto a, auto b) { return merged[a].unique_order > merged[b].unique_order; });
+
+        stack.insert(stack.end(), siblings.begin(), siblings.end());
+        out->push_back(std::move(merged[index]));
+    }
+}
+
+void tracer_group::aggregated_node::dump_data(std::string& s) const
+{
+    switch (type)
+    {
+        case value_type::none:
+            s = "[null]";
+            break;
+
+        case value_type::duration:
+            s = fmt::format("sum {:.4f} ms, mean {:.4f} ms, min {:.4f} ms, max {:.4f} ms ({})",
+                            sum * 1e3, mean * 1e3, min * 1e3, max * 1e3, argmax_instance);
+            break;
+
+        case value_type::integer:
+        case value_type::floating_point:
+        case value_type::boolean:
+            s = fmt::format("sum {}, mean {}, min {}, max {} ({})",
+                            sum, mean, min, max, argmax_instance);
+            break;
+
+        case value_type::string:
+            s = fmt::format("\"{}\"", sample);
+            break;
+    }
+
+    s += fmt::format(" x{}", num_instances);
+}
@@ -0,0 +1,350 @@
+#include "perfkit/detail/tuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+#include "perfkit/detail/base.hpp"
+
+#define CPPH_LOGGER() perfkit::glog()
+
+namespace perfkit {
+static bool _search_space(detail::config_base& conf, nlohmann::json const& current,
+                          size_t grid, std::vector<nlohmann::json>* out)
+{
+    auto& attr = conf.attribute();
+
+    if (auto it = attr.find("one_of"); it != attr.end() && it->is_array())
+    {
+        out->assign(it->begin(), it->end());
+    }
+    else if (current.is_boolean())
+    {
+        *out = {false, true};
+    }
+    else if (current.is_number() && attr.contains("min") && attr.contains("max"))
+    {
+        auto lo = attr["min"].get<double>();
+        auto hi = attr["max"].get<double>();
+        if (not(lo < hi)) { return false; }
+
+        bool integral  = not current.is_number_float();
+        bool geometric = lo > 0 && hi / lo >= 100;
+
+        for (size_t i = 0; i < grid; ++i)
+        {
+            auto t     = grid > 1 ? double(i) / (grid - 1) : 0.;
+            auto value = geometric ? lo * std::pow(hi / lo, t) : lo + (hi - lo) * t;
+
+            nlohmann::json js = integral ? nlohmann::json(std::llround(value)) : nlohmann::json(value);
+            if (std::find(out->begin(), out->end(), js) == out->end()) { out->push_back(std::move(js)); }
+        }
+    }
+
+    return out->size() >= 2;
+}
+
+auto tuner::start(std::vector<config_shared_ptr> confs,
+                  tracer_ptr target,
+                  std::vector<std::string> node,
+                  options opts) -> std::shared_ptr<tuner>
+{
+    if (confs.empty() || not target || node.empty())
+        return CPPH_ERROR("tuner: configs, tracer and target node must be specified"), nullptr;
+
+    if (opts.iterations == 0 || opts.rounds == 0 || opts.grid < 2
+        || not(opts.percentile >= 0 && opts.percentile <= 1) || opts.abort_ratio < 0)
+        return CPPH_ERROR("tuner: invalid options"), nullptr;
+
+    std::shared_ptr<tuner> self{new tuner{opts}};
+    self->_node      = std::move(node);
+    self->_node_view = {self->_node.begin(), self->_node.end()};
+
+    for (auto& conf : confs)
+    {
+        if (not conf) { return CPPH_ERROR("tuner: null config"), nullptr; }
+
+        auto& entry    = self->_targets.emplace_back();
+        entry.ref      = conf;
+        entry.original = conf->serialize();
+        entry.best = entry.current = entry.original;
+
+        if (not _search_space(*conf, entry.original, opts.grid, &entry.space))
+        {
+            CPPH_ERROR("tuner: '{}' has no search space. one_of, or min and max is required",
+                       conf->display_key());
+            return nullptr;
+        }
+    }
+
+    // trackers are attached after every argument is validated, as they can't be detached
+    // from configs until next update.
+    for (auto& entry : self->_targets)
+    {
+        entry.tracker = _configs::apply_tracker::attach(entry.ref);
+        entry.tracker->expect(entry.original);
+    }
+
+    target->on_iteration +=
+            [wself = std::weak_ptr{self}](tracer const& trc) {
+                auto self = wself.lock();
+                return self && self->_on_iteration(trc);
+            };
+
+    // baseline is measured with current values.
+    self->_rung.emplace_back();
+
+    CPPH_INFO("tuner started: {} configs, target '{}', budget {}", confs.size(), target->name(), opts.budget);
+    return self;
+}
+
+tuner::~tuner() noexcept
+{
+    stop();
+    for (auto& target : _targets) { target.tracker && (target.tracker->detach(), 0); }
+}
+
+void tuner::stop()
+{
+    std::unique_lock lock{_mtx};
+    if (_state != state_t::running) { return; }
+
+    _finish(lock, state_t::stopped);
+}
+
+auto tuner::report() const -> result
+{
+    std::lock_guard _{_mtx};
+    return _report();
+}
+
+auto tuner::state() const noexcept -> state_t
+{
+    std::lock_guard _{_mtx};
+    return _state;
+}
+
+bool tuner::_on_iteration(tracer const& trc)
+{
+    std::unique_lock lock{_mtx};
+    if (_state != state_t::running) { return false; }
+
+    for (auto& target : _targets)
+    {
+        if (not target.tracker->modified()) { continue; }
+
+        CPPH_WARN("tuner aborted: '{}' was modified by others", target.ref->display_key());
+        return _finish(lock, state_t::aborted), false;
+    }
+
+    if (_waiting)
+    {
+        for (auto& target : _targets)
+            if (target.tracker->num_applied() < target.num_requested) { return true; }
+
+        // the iteration during which values were applied is mixed.
+        _waiting  = false;
+        _num_skip = 1 + _opts.warmup;
+    }
+
+    if (_node_cache == nullptr && (_node_cache = trc.find(_node_view)) == nullptr) { return true; }
+    if (_node_cache->fence != trc.fence()) { return true; }  // not reached in the iteration
+
+    auto sample = _node_cache->as_number();
+    if (not sample) { return true; }
+    if (_num_skip > 0) { return --_num_skip, true; }
+
+    _is_timer = _node_cache->as_timer().has_value();
+
+    auto& cand = _rung[_rung_index];
+    cand.samples.push_back(*sample);
+    ++_used;
+
+    // don't wait until the measurement ends, as the application suffers from it.
+    if (++_num_visited >= std::min<size_t>(_opts.iterations, 8) && _opts.abort_ratio > 0 && not _baseline_phase)
+    {
+        auto limit = _opts.maximize ? _baseline / (1 + _opts.abort_ratio) : _baseline * (1 + _opts.abort_ratio);
+        if (auto score = _score(cand.samples); _is_worse(score, limit))
+        {
+            CPPH_WARN("tuner aborted: {} = {} degraded metric to {:.4g} from baseline {:.4g}",
+                      _targets[_config_index].ref->display_key(), cand.value.dump(), score, _baseline);
+            return _finish(lock, state_t::aborted), false;
+        }
+    }
+
+    if (_num_visited < _opts.iterations) { return true; }
+
+    cand.score = _score(cand.samples);
+    ++_num_measured;
+
+    progress prog;
+    prog.round    = _round;
+    prog.level    = _level;
+    prog.value    = cand.value;
+    prog.is_timer = _is_timer;
+    prog.score    = cand.score;
+    prog.used     = _used;
+    prog.budget   = _opts.budget;
+    _baseline_phase || (prog.key = _targets[_config_index].ref->display_key(), 0);
+
+    configs::batch changes{configs::change_source::tuner};
+    bool done = _advance(&changes);
+
+    prog.baseline = _baseline;
+    if (done) { return _finish(lock, state_t::finished, &prog), false; }
+
+    lock.unlock();
+    changes.empty() || (changes.commit(), 0);
+    on_progress.invoke(prog);
+
+    return true;
+}
+
+bool tuner::_advance(configs::batch* changes)
+{
+    _num_visited = 0;
+
+    if (_baseline_phase)
+    {
+        _baseline_phase = false;
+        _baseline = _best_score = _rung[0].score;
+        return _begin_config(changes);
+    }
+
+    if (++_rung_index < _rung.size())
+        return _apply(changes, &_rung[_rung_index].value), false;
+
+    // better half of candidates survives.
+    std::stable_sort(_rung.begin(), _rung.end(),
+                     [this](auto& a, auto& b) { return _is_worse(b.score, a.score); });
+
+    if (_rung.size() > 2)
+    {
+        _rung.resize((_rung.size() + 1) / 2);
+        _rung_index = 0, ++_level;
+        return _apply(changes, &_rung[0].value), false;
+    }
+
+    auto& target = _targets[_config_index];
+    if (target.best != _rung[0].value)
+    {
+        target.best = _rung[0].value;
+        _changed    = true;
+    }
+
+    _best_score = _rung[0].score;
+    CPPH_DEBUG("tuner: {} = {} ({:.4g})", target.ref->display_key(), target.best.dump(), _best_score);
+
+    if (_used >= _opts.budget) { return true; }
+
+    if (++_config_index == _targets.size())
+    {
+        _config_index = 0;
+        if (++_round == _opts.rounds || not std::exchange(_changed, false)) { return true; }
+    }
+
+    return _begin_config(changes);
+}
+
+bool tuner::_begin_config(configs::batch* changes)
+{
+    auto& target = _targets[_config_index];
+
+    _rung.clear();
+    _rung.emplace_back().value = target.best;
+
+    for (auto& value : target.space)
+        if (value != target.best) { _rung.emplace_back().value = value; }
+
+    _rung_index = 0, _level = 0;
+    _apply(changes, &_rung[0].value);
+    return false;
+}
+
+void tuner::_apply(configs::batch* changes, nlohmann::json const* value)
+{
+    for (size_t i = 0; i < _targets.size(); ++i)
+    {
+        auto& target = _targets[i];
+        auto& next   = i == _config_index ? *value : target.best;
+        if (next == target.current) { continue; }
+
+        target.current = next;
+        target.tracker->expect(next);
+        ++target.num_requested;
+        changes->stage(target.ref.get(), next);
+    }
+
+    _waiting  = not changes->empty();
+    _num_skip = 0;
+}
+
+void tuner::_finish(std::unique_lock<std::mutex>& lock, state_t state, progress const* last)
+{
+    _state   = state;
+    auto res = _report();
+
+    // values requested from now on must not be reported as modification.
+    configs::batch changes{configs::change_source::tuner};
+    for (auto& target : _targets)
+    {
+        target.tracker->detach();
+
+        if (target.tracker->modified()) { continue; }  // leave others' value
+        auto& value = state == state_t::finished ? target.best : target.original;
+        value != target.current && (changes.stage(target.ref.get(), value), 0);
+    }
+
+    lock.unlock();
+    changes.empty() || (changes.commit(), 0);
+
+    CPPH_INFO("tuner finished as {}: {}, {:.4g} from baseline {:.4g}",
+              to_string(state), res.best.dump(), res.best_score, res.baseline);
+
+    last && (on_progress.invoke(*last), 0);
+    on_finish.invoke(res);
+}
+
+double tuner::_score(std::vector<double> const& samples) const
+{
+    auto copy = samples;
+    auto nth  = copy.begin() + size_t(_opts.percentile * (copy.size() - 1));
+    std::nth_element(copy.begin(), nth, copy.end());
+    return *nth;
+}
+
+bool tuner::_is_worse(double score, double than) const noexcept
+{
+    return _opts.maximize ? score < than : score > than;
+}
+
+auto tuner::_report() const -> result
+{
+    result res;
+    res.state        = _state;
+    res.is_timer     = _is_timer;
+    res.baseline     = _baseline;
+    res.best_score   = _best_score;
+    res.round        = _round;
+    res.num_measured = _num_measured;
+    res.used         = _used;
+    res.budget       = _opts.budget;
+
+    for (auto& target : _targets) { res.best[target.ref->display_key()] = target.best; }
+    return res;
+}
+
+char const* to_string(tuner::state_t state) noexcept
+{
+    switch (state)
+    {
+        case tuner::state_t::running: return "running";
+        case tuner::state_t::finished: return "finished";
+        case tuner::state_t::stopped: return "stopped";
+        case tuner::state_t::aborted: return "aborted";
+    }
+
+    return "unknown";
+}
+}  // namespace perfkit